@@ -0,0 +1,224 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            benchmark.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QScopedPointer>
+
+#include "benchmark.h"
+#include "lithophane.h"
+#include "rendersettings.h"
+#include "exporter.h"
+
+QJsonObject BenchmarkResult::toJson() const
+{
+  double seconds = nanoseconds / 1000000000.0;
+  QJsonObject json;
+  json.insert("input", input);
+  json.insert("stage", stage);
+  json.insert("width", width);
+  json.insert("height", height);
+  json.insert("runs", runs);
+  json.insert("milliseconds", nanoseconds / 1000000.0);
+  json.insert("pixels", pixels);
+  json.insert("facets", facets);
+  json.insert("bytes", bytes);
+  if(MemoryStats::isCountingHeap()) {
+    json.insert("allocations", allocations);
+    json.insert("allocatedBytes", allocatedBytes);
+    json.insert("peakBytes", peakBytes);
+  }
+  if(seconds > 0.0) {
+    json.insert("pixelsPerSecond", pixels / seconds);
+    json.insert("facetsPerSecond", facets / seconds);
+    json.insert("megabytesPerSecond", (bytes / 1048576.0) / seconds);
+  }
+
+  return json;
+}
+
+Benchmark::Benchmark(const int &runs, const QString &workDir)
+  : runs(qMax(1, runs)), workDir(workDir)
+{
+}
+
+template<typename Stage>
+qint64 Benchmark::best(Stage stage)
+{
+  qint64 fastest = -1;
+  QElapsedTimer timer;
+  for(int a = 0; a < runs; ++a) {
+    MemoryStats::resetPeaks();
+    MemoryUsage start = MemoryStats::heap();
+    timer.start();
+    stage();
+    qint64 elapsed = timer.nsecsElapsed();
+    MemoryUsage end = MemoryStats::heap();
+    memory.allocations = end.allocations - start.allocations;
+    memory.allocatedBytes = end.allocatedBytes - start.allocatedBytes;
+    memory.peakBytes = end.peakBytes - start.liveBytes;
+    if(fastest < 0 || elapsed < fastest) {
+      fastest = elapsed;
+    }
+  }
+
+  return fastest;
+}
+
+QList<BenchmarkResult> Benchmark::run(const QString &name, const QString &inputFile)
+{
+  QList<BenchmarkResult> results;
+  auto addResult = [&](const QString &stage, const qint64 &nanoseconds, const qint64 &pixels,
+                       const qint64 &facets, const qint64 &bytes) {
+    BenchmarkResult result;
+    result.input = name;
+    result.stage = stage;
+    result.runs = runs;
+    result.nanoseconds = nanoseconds;
+    result.pixels = pixels;
+    result.facets = facets;
+    result.bytes = bytes;
+    result.allocations = memory.allocations;
+    result.allocatedBytes = memory.allocatedBytes;
+    result.peakBytes = memory.peakBytes;
+    results.append(result);
+  };
+
+  QImage image;
+  qint64 elapsed = best([&]() {
+      image = QImage(inputFile);
+    });
+  if(image.isNull()) {
+    printf("Input file '%s' could not be loaded, skipping it.\n", inputFile.toStdString().c_str());
+    return results;
+  }
+  qint64 pixels = (qint64)image.width() * image.height();
+  addResult("load", elapsed, pixels, 0, QFileInfo(inputFile).size());
+
+  // Grayscale conversion, inversion and the grid topology
+  Lithophane lithophane;
+  elapsed = best([&]() {
+      lithophane.setImage(image);
+    });
+  addResult("prepare", elapsed, pixels, lithophane.gridIndices.length() / 3, 0);
+
+  // PNG images decoded straight to heights, comparable to load and prepare
+  // together. Other inputs are left to QImage and skipped.
+  Lithophane pngLithophane;
+  if(pngLithophane.loadPng(inputFile)) {
+    elapsed = best([&]() {
+        pngLithophane.loadPng(inputFile);
+      });
+    addResult("png", elapsed, pixels, pngLithophane.gridIndices.length() / 3, QFileInfo(inputFile).size());
+  }
+
+  // Vertex placement alone, the frame is always added but tiny in comparison
+  RenderSettings renderSettings;
+  renderSettings.enableStabilizers = false;
+  renderSettings.enableHangers = false;
+  Mesh mesh;
+  elapsed = best([&]() {
+      mesh = lithophane.render(renderSettings);
+    });
+  addResult("mesh", elapsed, pixels, mesh.facetCount(),
+            ((qint64)mesh.vertices.length() * sizeof(QVector3D)) + ((qint64)mesh.indices.length() * sizeof(quint32)));
+
+  // The frame pieces on their own, using the scale of a regular render
+  renderSettings = RenderSettings();
+  renderSettings.stabilizerThreshold = 0.0;
+  mesh = lithophane.render(renderSettings);
+  float width = renderSettings.width;
+  float height = (lithophane.border * 2) + (lithophane.imageHeight * lithophane.widthFactor);
+  int frameFacets = 0;
+  elapsed = best([&]() {
+      QList<QVector3D> pieces = lithophane.addFrame(width, height);
+      pieces.append(lithophane.addStabilizer(0, height * renderSettings.stabilizerHeightFactor));
+      pieces.append(lithophane.addStabilizer(width - 3, height * renderSettings.stabilizerHeightFactor));
+      pieces.append(lithophane.addHangers(width, height));
+      frameFacets = pieces.length() / 3;
+    });
+  addResult("frame", elapsed, 0, frameFacets, 0);
+
+  // Every format but G-code, which mostly times the slicing. The bytes per
+  // facet and per second calibrate the render estimates.
+  for(const auto &format: QStringList({"binary", "ascii", "3mf", "ply", "obj", "lmesh"})) {
+    QScopedPointer<Exporter> exporter(Exporter::create(format));
+    QString outputFile = QDir(workDir).filePath("benchmark." + exporter->suffix());
+    elapsed = best([&]() {
+        exporter->exportMesh(mesh, outputFile);
+      });
+    addResult("export-" + format, elapsed, 0, mesh.facetCount(), QFileInfo(outputFile).size());
+    QFile::remove(outputFile);
+  }
+
+  for(auto &result: results) {
+    result.width = image.width();
+    result.height = image.height();
+  }
+
+  return results;
+}
+
+QImage Benchmark::syntheticImage(const int &width, const int &height)
+{
+  QImage image(width, height, QImage::Format_Grayscale8);
+  quint32 state = 1;
+  for(int y = 0; y < height; ++y) {
+    uchar *row = image.scanLine(y);
+    for(int x = 0; x < width; ++x) {
+      state = (state * 1664525) + 1013904223;
+      int gray = ((x * 192) / width) + ((y * 48) / height) + (state >> 28);
+      row[x] = qMin(255, gray);
+    }
+  }
+
+  return image;
+}
+
+void Benchmark::printHeader()
+{
+  printf("%-24s %-14s %10s %12s %14s %10s %12s %10s\n", "Input", "Stage", "Time (ms)", "Mpixels/s", "Mfacets/s", "MB/s",
+         "Allocations", "Peak (MB)");
+}
+
+void Benchmark::print(const BenchmarkResult &result)
+{
+  double seconds = result.nanoseconds / 1000000000.0;
+  auto rate = [&seconds](const double &amount) {
+    return (amount > 0.0 && seconds > 0.0?QString::number(amount / seconds, 'f', 1):QString("-"));
+  };
+  bool counted = MemoryStats::isCountingHeap();
+  printf("%-24s %-14s %10.3f %12s %14s %10s %12s %10s\n", result.input.toStdString().c_str(),
+         result.stage.toStdString().c_str(), result.nanoseconds / 1000000.0,
+         rate(result.pixels / 1000000.0).toStdString().c_str(),
+         rate(result.facets / 1000000.0).toStdString().c_str(),
+         rate(result.bytes / 1048576.0).toStdString().c_str(),
+         (counted?QString::number(result.allocations):QString("-")).toStdString().c_str(),
+         (counted?QString::number(result.peakBytes / 1048576.0, 'f', 1):QString("-")).toStdString().c_str());
+}
@@ -0,0 +1,84 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            benchmark.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <QString>
+#include <QList>
+#include <QImage>
+#include <QJsonObject>
+
+#include "memorystats.h"
+
+struct BenchmarkResult
+{
+  QString input;
+  QString stage;
+  int width = 0;
+  int height = 0;
+  // Fastest of all runs
+  qint64 nanoseconds = 0;
+  int runs = 0;
+  // What the stage processed, zero if it doesn't apply to the stage
+  qint64 pixels = 0;
+  qint64 facets = 0;
+  qint64 bytes = 0;
+  // Heap allocations of the last run and the most memory it used on top of
+  // what was in use before it, only counted with glibc
+  qint64 allocations = 0;
+  qint64 allocatedBytes = 0;
+  qint64 peakBytes = 0;
+
+  QJsonObject toJson() const;
+};
+
+// Times each stage of the render pipeline on one input image: decoding,
+// preparing the heightmap and grid topology, placing the vertices, building
+// the frame pieces and exporting. Every stage is run a number of times and
+// the fastest run is reported, since it is the one least disturbed by other
+// load on the machine.
+class Benchmark
+{
+public:
+  Benchmark(const int &runs, const QString &workDir);
+  QList<BenchmarkResult> run(const QString &name, const QString &inputFile);
+  // Deterministic gradient with noise, so it compresses like a photo
+  static QImage syntheticImage(const int &width, const int &height);
+  static void printHeader();
+  static void print(const BenchmarkResult &result);
+
+private:
+  template<typename Stage>
+  qint64 best(Stage stage);
+
+  int runs = 5;
+  QString workDir;
+  // Memory used by the last run of the last stage
+  MemoryUsage memory;
+};
+
+#endif // __BENCHMARK_H__
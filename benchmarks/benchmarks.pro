@@ -0,0 +1,51 @@
+TEMPLATE = app
+TARGET = benchmarks
+DEPENDPATH += . ../src
+INCLUDEPATH += . ../src
+CONFIG += console
+CONFIG -= app_bundle
+QT += gui
+QMAKE_CXXFLAGS += -fopenmp
+LIBS += -fopenmp -lz -lpng
+
+include(../VERSION)
+DEFINES+=VERSION=\\\"$$VERSION\\\"
+DEFINES += COUNT_HEAP
+
+# Input
+HEADERS += benchmark.h \
+           ../src/rendersettings.h \
+           ../src/mesh.h \
+           ../src/lithophane.h \
+           ../src/exporter.h \
+           ../src/stlexporter.h \
+           ../src/zipwriter.h \
+           ../src/threemfexporter.h \
+           ../src/plyexporter.h \
+           ../src/objexporter.h \
+           ../src/meshfile.h \
+           ../src/meshfileexporter.h \
+           ../src/printerprofile.h \
+           ../src/gcodeexporter.h \
+           ../src/trace.h \
+           ../src/memorystats.h \
+           ../src/pngreader.h
+
+SOURCES += main.cpp \
+           benchmark.cpp \
+           ../src/rendersettings.cpp \
+           ../src/mesh.cpp \
+           ../src/lithophane.cpp \
+           ../src/exporter.cpp \
+           ../src/stlexporter.cpp \
+           ../src/zipwriter.cpp \
+           ../src/threemfexporter.cpp \
+           ../src/plyexporter.cpp \
+           ../src/objexporter.cpp \
+           ../src/meshfile.cpp \
+           ../src/meshfileexporter.cpp \
+           ../src/printerprofile.cpp \
+           ../src/gcodeexporter.cpp \
+           ../src/trace.cpp \
+           ../src/memorystats.cpp \
+           ../src/pngreader.cpp
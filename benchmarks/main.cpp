@@ -0,0 +1,131 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            main.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QSettings>
+#include <QThread>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include "benchmark.h"
+
+// Only read by RenderSettings::fromConfig(), which the benchmarks don't use
+QSettings *settings = nullptr;
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  app.setApplicationVersion(VERSION);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Times each stage of the LithoMaker render pipeline on synthetic "
+                                   "images and the bundled examples.");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  QCommandLineOption sizesOption("sizes", "Comma separated widths of the synthetic images, rendered at 4:3.",
+                                 "widths", "500,1000,2000,4000");
+  parser.addOption(sizesOption);
+  QCommandLineOption runsOption("runs", "Runs per stage, the fastest is reported.", "count", "5");
+  parser.addOption(runsOption);
+  QCommandLineOption examplesOption("examples", "Directory holding the example images.", "dir", "examples");
+  parser.addOption(examplesOption);
+  QCommandLineOption jsonOption("json", "Writes the results to this file as JSON.", "file");
+  parser.addOption(jsonOption);
+  parser.addPositionalArgument("images", "Additional PNG images to benchmark.", "[images...]");
+  parser.process(app);
+
+  QTemporaryDir workDir;
+  if(!workDir.isValid()) {
+    printf("Temporary directory could not be created.\n");
+    return 1;
+  }
+
+  // Synthetic images are saved first, so decoding is timed like any other input
+  QList<QPair<QString, QString> > inputs;
+  for(const auto &size: parser.value(sizesOption).split(",")) {
+    if(size.trimmed().isEmpty()) {
+      continue;
+    }
+    int width = size.trimmed().toInt();
+    if(width < 2) {
+      printf("Invalid synthetic image width '%s'.\n", size.toStdString().c_str());
+      return 1;
+    }
+    int height = qMax(2, (width * 3) / 4);
+    QString file = QDir(workDir.path()).filePath(QString("synthetic_%1x%2.png").arg(width).arg(height));
+    if(!Benchmark::syntheticImage(width, height).save(file)) {
+      printf("Synthetic image '%s' could not be saved.\n", file.toStdString().c_str());
+      return 1;
+    }
+    inputs.append({QString("synthetic %1x%2").arg(width).arg(height), file});
+  }
+  for(const auto &example: QStringList({"hummingbird.png", "elephant.png", "cheetah.png"})) {
+    QString file = QDir(parser.value(examplesOption)).filePath(example);
+    if(QFileInfo::exists(file)) {
+      inputs.append({example, file});
+    } else {
+      printf("Example '%s' not found, skipping it.\n", file.toStdString().c_str());
+    }
+  }
+  for(const auto &file: parser.positionalArguments()) {
+    inputs.append({QFileInfo(file).fileName(), file});
+  }
+
+  Benchmark benchmark(parser.value(runsOption).toInt(), workDir.path());
+  QJsonArray results;
+  Benchmark::printHeader();
+  for(const auto &input: inputs) {
+    for(const auto &result: benchmark.run(input.first, input.second)) {
+      Benchmark::print(result);
+      results.append(result.toJson());
+    }
+  }
+
+  if(parser.isSet(jsonOption)) {
+    QJsonObject json;
+    json.insert("version", QString(VERSION));
+    json.insert("date", QDateTime::currentDateTime().toString(Qt::ISODate));
+    json.insert("threads", QThread::idealThreadCount());
+    json.insert("runs", qMax(1, parser.value(runsOption).toInt()));
+    json.insert("results", results);
+    QFile jsonFile(parser.value(jsonOption));
+    if(!jsonFile.open(QIODevice::WriteOnly)) {
+      printf("Results file '%s' could not be opened for writing.\n", parser.value(jsonOption).toStdString().c_str());
+      return 1;
+    }
+    jsonFile.write(QJsonDocument(json).toJson());
+    printf("Results written to '%s'\n", parser.value(jsonOption).toStdString().c_str());
+  }
+
+  return 0;
+}
@@ -5,13 +5,21 @@ INCLUDEPATH += .
 CONFIG +=
 RESOURCES += lithomaker.qrc
 RC_FILE = lithomaker.rc
-QT += widgets
+QT += widgets network
 TRANSLATIONS = lithomaker_da_DK.ts
 QMAKE_CXXFLAGS += -fopenmp
-LIBS += -fopenmp
+LIBS += -fopenmp -lz -lpng
 
 include(./VERSION)
 DEFINES+=VERSION=\\\"$$VERSION\\\"
+# 'qmake CONFIG+=countheap' counts every heap allocation in the statistics
+countheap {
+  DEFINES += COUNT_HEAP
+}
+
+# 'make benchmarks' builds the benchmark suite in benchmarks/
+benchmarks.commands = cd $$PWD/benchmarks && $(QMAKE) benchmarks.pro && $(MAKE)
+QMAKE_EXTRA_TARGETS += benchmarks
 
 # Input
 HEADERS += src/mainwindow.h \
@@ -21,7 +29,37 @@ HEADERS += src/mainwindow.h \
            src/checkbox.h \
            src/configpages.h \
            src/configdialog.h \
-           src/aboutbox.h
+           src/aboutbox.h \
+           src/rendersettings.h \
+           src/mesh.h \
+           src/lithophane.h \
+           src/stlexporter.h \
+           src/sweep.h \
+           src/commandline.h \
+           src/watchdaemon.h \
+           src/renderserver.h \
+           src/rendercache.h \
+           src/renderjob.h \
+           src/renderqueue.h \
+           src/zipwriter.h \
+           src/threemfexporter.h \
+           src/exporter.h \
+           src/plyexporter.h \
+           src/objexporter.h \
+           src/meshfile.h \
+           src/meshfileexporter.h \
+           src/meshvalidation.h \
+           src/printerprofile.h \
+           src/gcodeexporter.h \
+           src/trace.h \
+           src/renderstats.h \
+           src/meshcomparison.h \
+           src/goldensuite.h \
+           src/memorystats.h \
+           src/renderestimate.h \
+           src/rendercheckpoint.h \
+           src/splitrender.h \
+           src/pngreader.h
 
 SOURCES += src/main.cpp \
            src/mainwindow.cpp \
@@ -31,4 +69,34 @@ SOURCES += src/main.cpp \
            src/checkbox.cpp \
            src/configpages.cpp \
            src/configdialog.cpp \
-           src/aboutbox.cpp
+           src/aboutbox.cpp \
+           src/rendersettings.cpp \
+           src/mesh.cpp \
+           src/lithophane.cpp \
+           src/stlexporter.cpp \
+           src/sweep.cpp \
+           src/commandline.cpp \
+           src/watchdaemon.cpp \
+           src/renderserver.cpp \
+           src/rendercache.cpp \
+           src/renderjob.cpp \
+           src/renderqueue.cpp \
+           src/zipwriter.cpp \
+           src/threemfexporter.cpp \
+           src/exporter.cpp \
+           src/plyexporter.cpp \
+           src/objexporter.cpp \
+           src/meshfile.cpp \
+           src/meshfileexporter.cpp \
+           src/meshvalidation.cpp \
+           src/printerprofile.cpp \
+           src/gcodeexporter.cpp \
+           src/trace.cpp \
+           src/renderstats.cpp \
+           src/meshcomparison.cpp \
+           src/goldensuite.cpp \
+           src/memorystats.cpp \
+           src/renderestimate.cpp \
+           src/rendercheckpoint.cpp \
+           src/splitrender.cpp \
+           src/pngreader.cpp
@@ -0,0 +1,488 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            commandline.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QSettings>
+#include <QFileInfo>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QDir>
+
+#include "commandline.h"
+#include "rendersettings.h"
+#include "sweep.h"
+#include "splitrender.h"
+#include "watchdaemon.h"
+#include "renderserver.h"
+#include "rendercache.h"
+#include "exporter.h"
+#include "renderjob.h"
+#include "meshfile.h"
+#include "meshvalidation.h"
+#include "printerprofile.h"
+#include "trace.h"
+#include "renderstats.h"
+#include "goldensuite.h"
+#include "renderestimate.h"
+
+extern QSettings *settings;
+
+static const char *modeOptions[] = { "--sweep", "--watch", "--serve", "--convert", "--golden-record", "--golden-check", "--estimate", "--bands", "--checkpoint" };
+
+// The daemon modes run until they are killed, so their trace file is
+// rewritten with the most recent events at this interval
+constexpr int traceInterval = 10000;
+
+namespace {
+// Writes the trace file when leaving CommandLine::run(), whichever mode ran
+class TraceWriter
+{
+public:
+  TraceWriter(const QString &filename) : filename(filename)
+  {
+    Trace::setEnabled(!filename.isEmpty());
+  }
+  ~TraceWriter()
+  {
+    write();
+  }
+  void write() const
+  {
+    if(!filename.isEmpty() && !Trace::write(filename)) {
+      printf("Trace file '%s' could not be written.\n", filename.toStdString().c_str());
+    }
+  }
+
+private:
+  QString filename;
+};
+}
+
+bool CommandLine::isHeadless(int argc, char *argv[])
+{
+  for(int a = 1; a < argc; ++a) {
+    for(const auto &modeOption: modeOptions) {
+      int length = strlen(modeOption);
+      if(strncmp(argv[a], modeOption, length) == 0 &&
+         (argv[a][length] == '\0' || argv[a][length] == '=')) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+QList<float> CommandLine::parseValues(const QString &values, bool &ok)
+{
+  QList<float> result;
+  ok = true;
+  if(values.isEmpty()) {
+    return result;
+  }
+  for(const auto &value: values.split(",")) {
+    result.append(value.trimmed().toFloat(&ok));
+    if(!ok) {
+      break;
+    }
+  }
+  return result;
+}
+
+qint64 CommandLine::parseSize(const QString &size, bool &ok)
+{
+  // Accepts plain bytes or a K, M or G suffix, eg. '512M'
+  QString value = size.trimmed().toUpper();
+  qint64 multiplier = 1;
+  if(value.endsWith("K")) {
+    multiplier = 1024;
+  } else if(value.endsWith("M")) {
+    multiplier = 1024 * 1024;
+  } else if(value.endsWith("G")) {
+    multiplier = 1024 * 1024 * 1024;
+  }
+  if(multiplier != 1) {
+    value.chop(1);
+  }
+  return (qint64)(value.toDouble(&ok) * multiplier);
+}
+
+int CommandLine::run(const QStringList &arguments)
+{
+  QCommandLineParser parser;
+  parser.setApplicationDescription("LithoMaker headless rendering. Any render setting not given on the command line is read from the config.");
+  parser.addHelpOption();
+  parser.addVersionOption();
+
+  QCommandLineOption sweepOption("sweep", "Render every combination of the given parameter values. Each variant is written to the output filename suffixed with its parameter values.");
+  QCommandLineOption convertOption("convert", "Write a LithoMaker mesh (.lmesh) input file to the output in the configured export formats, without rendering.");
+  QCommandLineOption inputOption(QStringList({"i", "input"}), "Input PNG image filename.", "file");
+  QCommandLineOption outputOption(QStringList({"o", "output"}), "Output STL filename.", "file");
+  QCommandLineOption totalThicknessOption("total-thickness", "Comma separated list of total thicknesses (mm).", "values");
+  QCommandLineOption minThicknessOption("min-thickness", "Comma separated list of minimum thicknesses (mm).", "values");
+  QCommandLineOption frameBorderOption("frame-border", "Comma separated list of frame borders (mm).", "values");
+  QCommandLineOption maxSizeOption("max-size", "Scale the input image down to fit within this many pixels.", "pixels", "0");
+  QCommandLineOption watchOption("watch", "Run as a daemon rendering new or changed PNG images from this directory into the output directory. Can be given several times.", "dir");
+  QCommandLineOption outputDirOption("output-dir", "Output directory for the watch daemon.", "dir");
+  QCommandLineOption profileOption("profile", "Read render and export settings from this ini file instead of the config.", "file");
+  QCommandLineOption jobsOption("jobs", "Maximum number of concurrent render jobs, sharing the cores between them. Defaults to 2.", "count", "0");
+  QCommandLineOption serveOption("serve", "Run as a render server accepting jobs on this local socket name or path.", "socket");
+  QCommandLineOption cacheSizeOption("cache-size", "Memory the render server may use for caching prepared images (MB).", "megabytes", "512");
+  QCommandLineOption renderCacheOption("render-cache", "Serve repeated renders of the same image and settings from a cache of exported files in this directory.", "dir");
+  QCommandLineOption renderCacheSizeOption("render-cache-size", "Maximum size of the render cache, eg. '10G'. The least recently used files are evicted first.", "size", "2G");
+  QCommandLineOption alsoExportOption("also-export", "Comma separated list of additional export formats, eg. '3mf,ply'. The mesh is rendered once and written next to each output in every format.", "formats");
+  QCommandLineOption printerProfileOption("printer-profile", "PrusaSlicer config file with the printer, filament and print settings used for G-code export.", "file");
+  QCommandLineOption traceOption("trace", "Record where the time of each render goes and write it to this file in the Chrome trace-event format, for loading in Perfetto.", "file");
+  QCommandLineOption statsOption("stats", "Append the statistics of every render job to this file as JSON lines.", "file");
+  QCommandLineOption metricsOption("metrics", "Keep the totals of all render jobs in this file in the Prometheus text format, eg. for the node exporter textfile collector.", "file");
+  QCommandLineOption memoryLimitOption("memory-limit", "Estimated memory all concurrent render jobs may use together, eg. '4G'. Defaults to half of the physical memory.", "size", "0");
+  QCommandLineOption maxMemoryOption("max-memory", "Peak memory a single render job may use, eg. '512M'. Larger images are rendered in bands of rows streamed to the outputs, or scaled down if an output format can't be written in bands.", "size", "0");
+  QCommandLineOption checkpointOption("checkpoint", "Render the input, or each variant with --sweep, in bands checkpointed to a directory next to the output. A render that is interrupted resumes from its last band when run again.");
+  QCommandLineOption bandsOption("bands", "Split the render into this many bands of rows rendered by separate processes and merged into the output. Without --band or --merge, one local process is started per band.", "count");
+  QCommandLineOption bandOption("band", "Only render this band, from 1 to --bands, into the '.bands' directory next to the output, eg. on another host sharing it.", "index");
+  QCommandLineOption mergeOption("merge", "Merge the bands rendered with --band into the output.");
+  QCommandLineOption estimateOption("estimate", "Print the facet count, output file sizes, peak memory and time a render of the input would take with the current settings, without rendering it.");
+  QCommandLineOption calibrationOption("calibration", "Benchmark results ('benchmarks --json') to calibrate the estimated time with. Defaults to the calibration preference.", "file");
+  QCommandLineOption goldenRecordOption("golden-record", "Render the input images, by default the bundled examples, with a fixed matrix of render settings and record the meshes and exported files as golden references in this directory.", "dir");
+  QCommandLineOption goldenCheckOption("golden-check", "Render the golden references recorded in this directory again, serially, in parallel and as render jobs, and compare the results against them.", "dir");
+  QCommandLineOption toleranceOption("tolerance", "Distance in mm vertices may differ from the golden meshes before a check fails.", "mm", "0.001");
+  parser.addOption(sweepOption);
+  parser.addOption(convertOption);
+  parser.addOption(inputOption);
+  parser.addOption(outputOption);
+  parser.addOption(totalThicknessOption);
+  parser.addOption(minThicknessOption);
+  parser.addOption(frameBorderOption);
+  parser.addOption(maxSizeOption);
+  parser.addOption(watchOption);
+  parser.addOption(outputDirOption);
+  parser.addOption(profileOption);
+  parser.addOption(jobsOption);
+  parser.addOption(memoryLimitOption);
+  parser.addOption(maxMemoryOption);
+  parser.addOption(checkpointOption);
+  parser.addOption(bandsOption);
+  parser.addOption(bandOption);
+  parser.addOption(mergeOption);
+  parser.addOption(serveOption);
+  parser.addOption(cacheSizeOption);
+  parser.addOption(renderCacheOption);
+  parser.addOption(renderCacheSizeOption);
+  parser.addOption(alsoExportOption);
+  parser.addOption(printerProfileOption);
+  parser.addOption(traceOption);
+  parser.addOption(statsOption);
+  parser.addOption(metricsOption);
+  parser.addOption(estimateOption);
+  parser.addOption(calibrationOption);
+  parser.addOption(goldenRecordOption);
+  parser.addOption(goldenCheckOption);
+  parser.addOption(toleranceOption);
+  parser.process(arguments);
+
+  QSettings *config = settings;
+  if(parser.isSet(profileOption)) {
+    if(!QFileInfo::exists(parser.value(profileOption))) {
+      printf("Settings profile '%s' doesn't exist.\n", parser.value(profileOption).toStdString().c_str());
+      return 1;
+    }
+    config = new QSettings(parser.value(profileOption), QSettings::IniFormat);
+  }
+  RenderSettings renderSettings = RenderSettings::fromConfig(*config);
+  if(renderSettings.isTiled()) {
+    // The batch modes reuse one lithophane per image, tiles are split by the ui
+    printf("Tiling is only supported in the ui, rendering without tiles.\n");
+    renderSettings.tileColumns = 1;
+    renderSettings.tileRows = 1;
+  }
+  QString stlFormat = config->value("export/stlFormat", "binary").toString();
+  QStringList additionalFormats = Exporter::parseFormats(parser.isSet(alsoExportOption)?
+                                                         parser.value(alsoExportOption):
+                                                         config->value("export/additionalFormats", "").toString());
+  for(const auto &format: QStringList(additionalFormats) << stlFormat) {
+    if(!Exporter::formats().contains(format)) {
+      printf("Unknown export format '%s', must be one of: %s\n", format.toStdString().c_str(),
+             Exporter::formats().join(", ").toStdString().c_str());
+      if(config != settings) {
+        delete config;
+      }
+      return 1;
+    }
+  }
+  QSharedPointer<RenderCache> renderCache = RenderCache::fromConfig(*config);
+  RenderCalibration calibration = RenderCalibration::fromConfig(*config);
+  QString printerProfileFile = (parser.isSet(printerProfileOption)?parser.value(printerProfileOption):
+                                config->value("export/printerProfile", "").toString());
+  TraceWriter traceWriter(parser.isSet(traceOption)?parser.value(traceOption):
+                          config->value("main/traceFile", "").toString());
+  StatsLog statsLog;
+  statsLog.setJsonFile(parser.isSet(statsOption)?parser.value(statsOption):
+                       config->value("main/statsFile", "").toString());
+  statsLog.setMetricsFile(parser.value(metricsOption));
+  QTimer traceTimer;
+  traceTimer.setInterval(traceInterval);
+  QObject::connect(&traceTimer, &QTimer::timeout, [&traceWriter]() {
+      traceWriter.write();
+    });
+  if(config != settings) {
+    delete config;
+  }
+  if(parser.isSet(renderCacheOption)) {
+    bool sizeOk = false;
+    qint64 renderCacheSize = parseSize(parser.value(renderCacheSizeOption), sizeOk);
+    if(!sizeOk) {
+      printf("Render cache size must be a size, eg. '10G'.\n");
+      return 1;
+    }
+    renderCache = RenderCache::shared(parser.value(renderCacheOption), renderCacheSize);
+  }
+  bool maxMemoryOk = false;
+  qint64 maxMemory = parseSize(parser.value(maxMemoryOption), maxMemoryOk);
+  if(!maxMemoryOk) {
+    printf("Maximum memory must be a size, eg. '512M'.\n");
+    return 1;
+  }
+  bool profileOk = true;
+  PrinterProfile printerProfile = PrinterProfile::fromFile(printerProfileFile, &profileOk);
+  if(!profileOk) {
+    printf("Printer profile '%s' could not be read.\n", printerProfileFile.toStdString().c_str());
+    return 1;
+  }
+
+  if(parser.isSet(watchOption)) {
+    if(!parser.isSet(outputDirOption)) {
+      printf("The watch daemon requires an output directory.\n");
+      return 1;
+    }
+    bool memoryOk = false;
+    qint64 memoryLimit = parseSize(parser.value(memoryLimitOption), memoryOk);
+    if(!memoryOk) {
+      printf("Memory limit must be a size, eg. '4G'.\n");
+      return 1;
+    }
+    WatchDaemon daemon(parser.values(watchOption), parser.value(outputDirOption), renderSettings, stlFormat);
+    daemon.setMaxJobs(parser.value(jobsOption).toInt());
+    daemon.setAdditionalFormats(additionalFormats);
+    daemon.setMemoryLimit(memoryLimit);
+    daemon.setMaxSize(parser.value(maxSizeOption).toInt());
+    daemon.setMaxMemory(maxMemory);
+    daemon.setRenderCache(renderCache.data());
+    daemon.setPrinterProfile(printerProfile);
+    daemon.setStatsLog(&statsLog);
+    if(!daemon.start()) {
+      return 1;
+    }
+    if(Trace::isEnabled()) {
+      traceTimer.start();
+    }
+    return QCoreApplication::exec();
+  }
+
+  if(parser.isSet(serveOption)) {
+    RenderServer server(parser.value(serveOption), renderSettings, stlFormat);
+    server.setMaxJobs(parser.value(jobsOption).toInt());
+    server.setCacheSize(parser.value(cacheSizeOption).toInt());
+    server.setMaxSize(parser.value(maxSizeOption).toInt());
+    server.setMaxMemory(maxMemory);
+    server.setRenderCache(renderCache.data());
+    server.setPrinterProfile(printerProfile);
+    server.setStatsLog(&statsLog);
+    if(!server.start()) {
+      return 1;
+    }
+    if(Trace::isEnabled()) {
+      traceTimer.start();
+    }
+    return QCoreApplication::exec();
+  }
+
+  if(parser.isSet(goldenRecordOption) || parser.isSet(goldenCheckOption)) {
+    bool toleranceOk = false;
+    float tolerance = parser.value(toleranceOption).toFloat(&toleranceOk);
+    if(!toleranceOk || tolerance < 0.0) {
+      printf("Tolerance must be a distance in mm, eg. '0.001'.\n");
+      return 1;
+    }
+    GoldenSuite goldenSuite(parser.isSet(goldenRecordOption)?parser.value(goldenRecordOption):
+                            parser.value(goldenCheckOption));
+    goldenSuite.setTolerance(tolerance);
+    QStringList inputFiles = parser.values(inputOption);
+    if(parser.isSet(goldenRecordOption)) {
+      if(inputFiles.isEmpty()) {
+        QDir examples("examples");
+        for(const auto &example: examples.entryList(QStringList({"*.png"}), QDir::Files, QDir::Name)) {
+          inputFiles.append(examples.filePath(example));
+        }
+      }
+      goldenSuite.setInputFiles(inputFiles);
+      if(parser.isSet(maxSizeOption)) {
+        goldenSuite.setMaxSize(parser.value(maxSizeOption).toInt());
+      }
+      return goldenSuite.record();
+    }
+    goldenSuite.setInputFiles(inputFiles);
+    return goldenSuite.check();
+  }
+
+  if(!parser.isSet(inputOption) || !parser.isSet(outputOption)) {
+    printf("Both an input and an output filename are required.\n");
+    return 1;
+  }
+
+  if(parser.isSet(estimateOption)) {
+    if(parser.isSet(calibrationOption)) {
+      bool calibrationOk = false;
+      calibration = RenderCalibration::fromBenchmarks(parser.value(calibrationOption), &calibrationOk);
+      if(!calibrationOk) {
+        printf("Benchmark results '%s' could not be read.\n", parser.value(calibrationOption).toStdString().c_str());
+        return 1;
+      }
+    }
+    RenderJob job;
+    job.inputFile = parser.value(inputOption);
+    job.addOutputs(parser.value(outputOption), stlFormat, additionalFormats);
+    job.renderSettings = renderSettings;
+    job.maxSize = parser.value(maxSizeOption).toInt();
+    job.maxMemory = maxMemory;
+    job.printerProfile = printerProfile;
+    RenderEstimate estimate = RenderEstimate::forJob(job, calibration);
+    printf("%s\n", estimate.report().toStdString().c_str());
+    return (estimate.valid?0:1);
+  }
+
+  if(parser.isSet(convertOption)) {
+    MeshFile meshFile(parser.value(inputOption));
+    if(!meshFile.open()) {
+      printf("Mesh file '%s' could not be opened: %s\n", parser.value(inputOption).toStdString().c_str(),
+             meshFile.errorString().toStdString().c_str());
+      return 1;
+    }
+    Mesh mesh = meshFile.mesh();
+    if(mesh.isEmpty()) {
+      printf("Mesh file '%s' has no facets or invalid indices.\n", parser.value(inputOption).toStdString().c_str());
+      return 1;
+    }
+    MeshValidation validation = MeshValidation::check(mesh);
+    if(!validation.isValid()) {
+      printf("Mesh validation failed: %s\n", validation.report().toStdString().c_str());
+      return 1;
+    }
+    RenderJob job;
+    job.addOutputs(parser.value(outputOption), stlFormat, additionalFormats);
+    QString errorString;
+    RenderJob::writeOutputs(mesh, job.outputs, errorString, printerProfile);
+    if(!errorString.isEmpty()) {
+      printf("%s\n", errorString.toStdString().c_str());
+      return 1;
+    }
+    printf("Wrote %d facets to '%s'\n", mesh.facetCount(), job.outputFiles().join("', '").toStdString().c_str());
+    return 0;
+  }
+
+  if(parser.isSet(bandsOption)) {
+    int bands = parser.value(bandsOption).toInt();
+    if(bands < 2) {
+      printf("Bands must be a count of at least 2.\n");
+      return 1;
+    }
+    SplitRender splitRender(parser.value(inputOption), parser.value(outputOption), renderSettings, bands);
+    splitRender.setStlFormat(stlFormat);
+    splitRender.setAdditionalFormats(additionalFormats);
+    splitRender.setMaxSize(parser.value(maxSizeOption).toInt());
+    splitRender.setMaxMemory(maxMemory);
+    splitRender.setPrinterProfile(printerProfile);
+    splitRender.setStatsLog(&statsLog);
+    if(parser.isSet(bandOption)) {
+      int band = parser.value(bandOption).toInt();
+      if(band < 1 || band > bands) {
+        printf("Band must be from 1 to %d.\n", bands);
+        return 1;
+      }
+      return splitRender.renderBand(band - 1);
+    }
+    if(parser.isSet(mergeOption)) {
+      return splitRender.merge();
+    }
+    return splitRender.run(arguments);
+  }
+
+  if(parser.isSet(sweepOption)) {
+    bool totalOk = false;
+    bool minOk = false;
+    bool borderOk = false;
+    QList<float> totalThicknesses = parseValues(parser.value(totalThicknessOption), totalOk);
+    QList<float> minThicknesses = parseValues(parser.value(minThicknessOption), minOk);
+    QList<float> frameBorders = parseValues(parser.value(frameBorderOption), borderOk);
+    if(!totalOk || !minOk || !borderOk) {
+      printf("Parameter values must be comma separated numbers, eg. '3.0,4.0,5.0'.\n");
+      return 1;
+    }
+    Sweep sweep(parser.value(inputOption), parser.value(outputOption), renderSettings);
+    sweep.setStlFormat(stlFormat);
+    sweep.setAdditionalFormats(additionalFormats);
+    sweep.setTotalThicknesses(totalThicknesses);
+    sweep.setMinThicknesses(minThicknesses);
+    sweep.setFrameBorders(frameBorders);
+    sweep.setMaxSize(parser.value(maxSizeOption).toInt());
+    sweep.setMaxMemory(maxMemory);
+    sweep.setCheckpoint(parser.isSet(checkpointOption));
+    sweep.setRenderCache(renderCache.data());
+    sweep.setPrinterProfile(printerProfile);
+    sweep.setStatsLog(&statsLog);
+    return sweep.run();
+  }
+
+  if(parser.isSet(checkpointOption)) {
+    Lithophane lithophane;
+    RenderJob job;
+    job.inputFile = parser.value(inputOption);
+    job.addOutputs(parser.value(outputOption), stlFormat, additionalFormats);
+    job.renderSettings = renderSettings;
+    job.maxSize = parser.value(maxSizeOption).toInt();
+    job.maxMemory = maxMemory;
+    job.checkpoint = true;
+    job.renderCache = renderCache.data();
+    job.printerProfile = printerProfile;
+    job.statsLog = &statsLog;
+    if(job.run(lithophane) != RenderJob::Finished) {
+      printf("Render failed: %s\n", job.errorString.toStdString().c_str());
+      return 1;
+    }
+    if(job.cached) {
+      printf("Wrote '%s' from the render cache\n", job.outputFiles().join("', '").toStdString().c_str());
+      return 0;
+    }
+    if(job.stats.resumedRows > 0) {
+      printf("Resumed from row %d. ", job.stats.resumedRows);
+    }
+    printf("Wrote %d facets to '%s'\n", job.facets, job.outputFiles().join("', '").toStdString().c_str());
+    return 0;
+  }
+
+  return 0;
+}
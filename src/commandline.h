@@ -0,0 +1,45 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            commandline.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __COMMANDLINE_H__
+#define __COMMANDLINE_H__
+
+#include <QStringList>
+#include <QList>
+
+// Headless modes that run without the main window
+class CommandLine
+{
+public:
+  static bool isHeadless(int argc, char *argv[]);
+  static int run(const QStringList &arguments);
+
+private:
+  static QList<float> parseValues(const QString &values, bool &ok);
+  static qint64 parseSize(const QString &size, bool &ok);
+};
+
+#endif // __COMMANDLINE_H__
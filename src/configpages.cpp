@@ -31,6 +31,8 @@
 #include "combobox.h"
 #include "checkbox.h"
 #include "slider.h"
+#include "rendercache.h"
+#include "exporter.h"
 
 extern QSettings *settings;
 
@@ -38,8 +40,26 @@ MainPage::MainPage(QWidget *parent) : QWidget(parent)
 {
   QPushButton *resetButton = new QPushButton(tr("Reset all to defaults"));
 
+  QLabel *traceFileLabel = new QLabel(tr("Write a performance trace to this file on exit (Chrome trace format, takes effect on restart):"));
+  LineEdit *traceFileLineEdit = new LineEdit("main", "traceFile", "");
+  connect(resetButton, &QPushButton::clicked, traceFileLineEdit, &LineEdit::resetToDefault);
+
+  QLabel *statsFileLabel = new QLabel(tr("Append the statistics of every render to this file (JSON lines):"));
+  LineEdit *statsFileLineEdit = new LineEdit("main", "statsFile", "");
+  connect(resetButton, &QPushButton::clicked, statsFileLineEdit, &LineEdit::resetToDefault);
+
+  QLabel *calibrationFileLabel = new QLabel(tr("Calibrate render time estimates with these benchmark results ('benchmarks --json'):"));
+  LineEdit *calibrationFileLineEdit = new LineEdit("main", "calibrationFile", "");
+  connect(resetButton, &QPushButton::clicked, calibrationFileLineEdit, &LineEdit::resetToDefault);
+
   QVBoxLayout *layout = new QVBoxLayout();
   layout->addWidget(resetButton);
+  layout->addWidget(calibrationFileLabel);
+  layout->addWidget(calibrationFileLineEdit);
+  layout->addWidget(statsFileLabel);
+  layout->addWidget(statsFileLineEdit);
+  layout->addWidget(traceFileLabel);
+  layout->addWidget(traceFileLineEdit);
   layout->addStretch();
   setLayout(layout);
 }
@@ -73,8 +93,33 @@ RenderPage::RenderPage(QWidget *parent) : QWidget(parent)
   Slider *hangersSlider = new Slider("render", "hangers", 1, 4, 2, 1);
   connect(resetButton, &QPushButton::clicked, hangersSlider, &Slider::resetToDefault);
 
+  CheckBox *solidCheckBox = new CheckBox("render", "solid", tr("Render a single watertight solid (no stabilizers)"), false);
+  connect(resetButton, &QPushButton::clicked, solidCheckBox, &CheckBox::resetToDefault);
+
+  QLabel *layerHeightLabel = new QLabel(tr("Snap thickness to whole layers of this height (mm, 0 disables):"));
+  LineEdit *layerHeightLineEdit = new LineEdit("render", "layerHeight", "0");
+  connect(resetButton, &QPushButton::clicked, layerHeightLineEdit, &LineEdit::resetToDefault);
+
+  CheckBox *ditherLayersCheckBox = new CheckBox("render", "ditherLayers", tr("Dither between layers to keep the gray levels"), false);
+  connect(resetButton, &QPushButton::clicked, ditherLayersCheckBox, &CheckBox::resetToDefault);
+
+  QLabel *tileColumnsLabel = new QLabel(tr("Split into tiles, columns (each tile gets the full width):"));
+  Slider *tileColumnsSlider = new Slider("render", "tileColumns", 1, 10, 1, 1);
+  connect(resetButton, &QPushButton::clicked, tileColumnsSlider, &Slider::resetToDefault);
+
+  QLabel *tileRowsLabel = new QLabel(tr("Split into tiles, rows:"));
+  Slider *tileRowsSlider = new Slider("render", "tileRows", 1, 10, 1, 1);
+  connect(resetButton, &QPushButton::clicked, tileRowsSlider, &Slider::resetToDefault);
+
+  CheckBox *alignmentLipsCheckBox = new CheckBox("render", "alignmentLips", tr("Add alignment lips on the back of the tiles"), false);
+  connect(resetButton, &QPushButton::clicked, alignmentLipsCheckBox, &CheckBox::resetToDefault);
+
   QVBoxLayout *layout = new QVBoxLayout();
   layout->addWidget(resetButton);
+  layout->addWidget(solidCheckBox);
+  layout->addWidget(layerHeightLabel);
+  layout->addWidget(layerHeightLineEdit);
+  layout->addWidget(ditherLayersCheckBox);
   layout->addWidget(enableStabilizersCheckBox);
   layout->addWidget(permanentStabilizersCheckBox);
   layout->addWidget(stabilizerThresholdLabel);
@@ -86,6 +131,11 @@ RenderPage::RenderPage(QWidget *parent) : QWidget(parent)
   layout->addWidget(enableHangersCheckBox);
   layout->addWidget(hangersLabel);
   layout->addWidget(hangersSlider);
+  layout->addWidget(tileColumnsLabel);
+  layout->addWidget(tileColumnsSlider);
+  layout->addWidget(tileRowsLabel);
+  layout->addWidget(tileRowsSlider);
+  layout->addWidget(alignmentLipsCheckBox);
   layout->addStretch();
   setLayout(layout);
 }
@@ -94,15 +144,40 @@ ExportPage::ExportPage(QWidget *parent) : QWidget(parent)
 {
   QPushButton *resetButton = new QPushButton(tr("Reset all to defaults"));
 
-  QLabel *stlFormatLabel = new QLabel(tr("STL format:"));
+  QLabel *stlFormatLabel = new QLabel(tr("Export format:"));
   ComboBox *stlFormatComboBox = new ComboBox("export", "stlFormat", "binary");
-  stlFormatComboBox->addConfigItem("Ascii", "ascii");
-  stlFormatComboBox->addConfigItem("Binary", "binary");
+  for(const auto &format: Exporter::formats()) {
+    Exporter *exporter = Exporter::create(format);
+    stlFormatComboBox->addConfigItem(exporter->name(), format);
+    delete exporter;
+  }
   stlFormatComboBox->setFromConfig();
   connect(resetButton, &QPushButton::clicked, stlFormatComboBox, &ComboBox::resetToDefault);
 
+  QLabel *additionalFormatsLabel = new QLabel(tr("Also export these formats (comma separated, eg. '3mf, ply'):"));
+  LineEdit *additionalFormatsLineEdit = new LineEdit("export", "additionalFormats", "", true);
+  connect(resetButton, &QPushButton::clicked, additionalFormatsLineEdit, &LineEdit::resetToDefault);
+
+  QLabel *printerProfileLabel = new QLabel(tr("Printer profile for G-code export (PrusaSlicer config file):"));
+  LineEdit *printerProfileLineEdit = new LineEdit("export", "printerProfile", "");
+  connect(resetButton, &QPushButton::clicked, printerProfileLineEdit, &LineEdit::resetToDefault);
+
   CheckBox *alwaysOverwriteCheckBox = new CheckBox("export", "alwaysOverwrite", tr("Always overwrite existing file"), false);
   connect(resetButton, &QPushButton::clicked, alwaysOverwriteCheckBox, &CheckBox::resetToDefault);
+
+  CheckBox *validateMeshCheckBox = new CheckBox("export", "validateMesh", tr("Check the mesh for holes and flipped or degenerate facets before exporting"), true);
+  connect(resetButton, &QPushButton::clicked, validateMeshCheckBox, &CheckBox::resetToDefault);
+
+  CheckBox *renderCacheCheckBox = new CheckBox("export", "renderCache", tr("Reuse previous renders of the same image and settings"), false);
+  connect(resetButton, &QPushButton::clicked, renderCacheCheckBox, &CheckBox::resetToDefault);
+
+  QLabel *renderCacheDirLabel = new QLabel(tr("Render cache folder:"));
+  LineEdit *renderCacheDirLineEdit = new LineEdit("export", "renderCacheDir", RenderCache::defaultDirectory(), true);
+  connect(resetButton, &QPushButton::clicked, renderCacheDirLineEdit, &LineEdit::resetToDefault);
+
+  QLabel *renderCacheSizeLabel = new QLabel(tr("Render cache size (MB):"));
+  LineEdit *renderCacheSizeLineEdit = new LineEdit("export", "renderCacheSize", "2048");
+  connect(resetButton, &QPushButton::clicked, renderCacheSizeLineEdit, &LineEdit::resetToDefault);
   /*
   QLabel *delimiterLabel = new QLabel(tr("Delimiter:"));
   ComboBox *delimiterComboBox = new ComboBox("Export", "delimiter", "tab");
@@ -125,7 +200,17 @@ ExportPage::ExportPage(QWidget *parent) : QWidget(parent)
   layout->addWidget(resetButton);
   layout->addWidget(stlFormatLabel);
   layout->addWidget(stlFormatComboBox);
+  layout->addWidget(additionalFormatsLabel);
+  layout->addWidget(additionalFormatsLineEdit);
+  layout->addWidget(printerProfileLabel);
+  layout->addWidget(printerProfileLineEdit);
   layout->addWidget(alwaysOverwriteCheckBox);
+  layout->addWidget(validateMeshCheckBox);
+  layout->addWidget(renderCacheCheckBox);
+  layout->addWidget(renderCacheDirLabel);
+  layout->addWidget(renderCacheDirLineEdit);
+  layout->addWidget(renderCacheSizeLabel);
+  layout->addWidget(renderCacheSizeLineEdit);
   /*
   layout->addWidget(delimiterLabel);
   layout->addWidget(delimiterComboBox);
@@ -0,0 +1,118 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            exporter.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "exporter.h"
+#include "stlexporter.h"
+#include "threemfexporter.h"
+#include "plyexporter.h"
+#include "objexporter.h"
+#include "meshfileexporter.h"
+#include "gcodeexporter.h"
+
+Exporter::~Exporter()
+{
+}
+
+bool Exporter::indexed() const
+{
+  return false;
+}
+
+qint64 Exporter::estimateSize(const qint64 &, const qint64 &) const
+{
+  return -1;
+}
+
+bool Exporter::canStream() const
+{
+  return false;
+}
+
+bool Exporter::beginStream(const QString &)
+{
+  return false;
+}
+
+bool Exporter::streamMesh(const Mesh &)
+{
+  return false;
+}
+
+bool Exporter::endStream()
+{
+  return false;
+}
+
+Exporter *Exporter::create(const QString &format, const PrinterProfile &printerProfile)
+{
+  if(format == "binary") {
+    return new StlExporter(true);
+  } else if(format == "ascii") {
+    return new StlExporter(false);
+  } else if(format == "3mf") {
+    return new ThreeMfExporter();
+  } else if(format == "ply") {
+    return new PlyExporter();
+  } else if(format == "obj") {
+    return new ObjExporter();
+  } else if(format == "lmesh") {
+    return new MeshFileExporter();
+  } else if(format == "gcode") {
+    return new GcodeExporter(printerProfile);
+  }
+
+  return nullptr;
+}
+
+QStringList Exporter::formats()
+{
+  // The format ids are stored in the 'export/stlFormat' config key
+  return QStringList({"ascii", "binary", "3mf", "ply", "obj", "lmesh", "gcode"});
+}
+
+QString Exporter::suffix(const QString &format)
+{
+  Exporter *exporter = create(format);
+  if(exporter == nullptr) {
+    return "stl";
+  }
+  QString suffix = exporter->suffix();
+  delete exporter;
+
+  return suffix;
+}
+
+QStringList Exporter::parseFormats(const QString &formats)
+{
+  QStringList parsed;
+  for(const auto &format: formats.split(",")) {
+    if(!format.trimmed().isEmpty()) {
+      parsed.append(format.trimmed().toLower());
+    }
+  }
+
+  return parsed;
+}
@@ -0,0 +1,71 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            exporter.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __EXPORTER_H__
+#define __EXPORTER_H__
+
+#include <QString>
+#include <QStringList>
+
+#include "mesh.h"
+#include "printerprofile.h"
+
+// Base class for all export formats. To add a format, subclass it and add
+// it to Exporter::create() and Exporter::formats().
+class Exporter
+{
+public:
+  virtual ~Exporter();
+  // Human readable name of the format, used in the preferences
+  virtual QString name() const = 0;
+  // File name extension without the dot
+  virtual QString suffix() const = 0;
+  // Whether the format welds the mesh into shared vertices
+  virtual bool indexed() const;
+  // Must be safe to call for several exporters at once on the same mesh
+  virtual bool exportMesh(const Mesh &mesh, const QString &filename) = 0;
+  // Approximate file size for a mesh with this many facets and welded
+  // vertices, or -1 if it can't be told without exporting
+  virtual qint64 estimateSize(const qint64 &facets, const qint64 &vertices) const;
+  // Whether the format can be written a part of the mesh at a time, as with
+  // Lithophane::renderBands(). The parts are written in the order given,
+  // without welding them together.
+  virtual bool canStream() const;
+  virtual bool beginStream(const QString &filename);
+  virtual bool streamMesh(const Mesh &part);
+  virtual bool endStream();
+
+  // Returns nullptr if the format is unknown. The caller owns the exporter.
+  // The printer profile is only used by the G-code format.
+  static Exporter *create(const QString &format,
+                          const PrinterProfile &printerProfile = PrinterProfile());
+  static QStringList formats();
+  static QString suffix(const QString &format);
+  // Parses a comma separated list of format ids, eg. "3mf, ply"
+  static QStringList parseFormats(const QString &formats);
+};
+
+#endif // __EXPORTER_H__
@@ -0,0 +1,803 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            gcodeexporter.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+#include <algorithm>
+#include <omp.h>
+#include <QFile>
+#include <QVector>
+
+#include "gcodeexporter.h"
+#include "trace.h"
+
+// Slice columns per extrusion width. Sets the horizontal resolution.
+constexpr int columnsPerWidth = 4;
+// Largest deviation allowed when simplifying paths (mm)
+constexpr float pathTolerance = 0.01;
+// Intervals closer than this are merged (mm)
+constexpr float mergeDistance = 0.0001;
+
+namespace {
+struct Point
+{
+  float x;
+  float z;
+};
+
+struct Crossing
+{
+  int column;
+  float z;
+  int winding;
+  bool operator<(const Crossing &other) const
+  {
+    if(column != other.column) {
+      return column < other.column;
+    }
+    if(z != other.z) {
+      return z < other.z;
+    }
+    return winding < other.winding;
+  }
+};
+
+// A connected part of a layer. Each column holds a single interval through
+// the thickness from 'lo' to 'hi'. Empty columns have lo > hi.
+struct Island
+{
+  int first = 0;
+  QVector<float> lo;
+  QVector<float> hi;
+
+  int length() const
+  {
+    return lo.length();
+  }
+  bool isEmpty(const int &column) const
+  {
+    return lo.at(column) > hi.at(column);
+  }
+};
+
+// The layers run along the y axis of the mesh, so a slice is a region in
+// x and z. It is stored as columns along x, each crossing the thickness.
+class Slicer
+{
+public:
+  void prepare(const Mesh &mesh, const PrinterProfile &profile);
+  QVector<Island> slice(const int &layer) const;
+  float columnX(const int &column) const
+  {
+    return minX + ((column + 0.5) * resolution);
+  }
+  float layerTop(const int &layer) const
+  {
+    return firstLayerHeight + (layer * layerHeight);
+  }
+  float layerThickness(const int &layer) const
+  {
+    return (layer == 0?firstLayerHeight:layerHeight);
+  }
+
+  float minX = 0.0;
+  float maxX = 0.0;
+  float minY = 0.0;
+  float maxY = 0.0;
+  float minZ = 0.0;
+  float maxZ = 0.0;
+  float resolution = 0.1;
+  int layers = 0;
+
+private:
+  void addSegment(QVector<Crossing> &crossings, const Point &a, const Point &b,
+                  const int &winding) const;
+  int firstColumn(const float &x) const;
+
+  const Mesh *mesh = nullptr;
+  float firstLayerHeight = 0.2;
+  float layerHeight = 0.2;
+  // Facets entirely on the heightmap grid are interpolated from the grid
+  // instead of intersected. These are the grid cells they cover.
+  bool hasGrid = false;
+  int gridFirstX = INT_MAX;
+  int gridLastX = -1;
+  int gridFirstY = INT_MAX;
+  int gridLastY = -1;
+  int gridWinding = 1;
+  // All other facets, by the layers they cross
+  QVector<QVector<int> > layerFacets;
+};
+
+// Accumulates the moves of a layer. The extruder is retracted when a layer
+// starts and ends, which allows layers to be generated independently.
+class Toolpath
+{
+public:
+  Toolpath(const PrinterProfile &profile, const float &offsetX, const float &offsetY,
+           const float &top, const float &thickness);
+  void travelTo(const Point &point);
+  void extrudeTo(const Point &point, const float &speed);
+  void extrudeLoop(const QVector<Point> &loop, const float &speed);
+  QByteArray finish();
+
+  QByteArray gcode;
+
+private:
+  void retract();
+  QByteArray coordinates(const Point &point) const;
+
+  const PrinterProfile &profile;
+  float offsetX;
+  float offsetY;
+  float top;
+  float extrusionPerMm;
+  Point position = {0.0, 0.0};
+  bool positionKnown = false;
+  bool retracted = true;
+  float feedRate = 0.0;
+};
+}
+
+static QByteArray number(const float &value, const int &precision = 3)
+{
+  return QByteArray::number(value, 'f', precision);
+}
+
+static float distance(const Point &a, const Point &b)
+{
+  return sqrt(((b.x - a.x) * (b.x - a.x)) + ((b.z - a.z) * (b.z - a.z)));
+}
+
+void Slicer::prepare(const Mesh &mesh, const PrinterProfile &profile)
+{
+  this->mesh = &mesh;
+  firstLayerHeight = profile.firstLayerHeight;
+  layerHeight = profile.layerHeight;
+  resolution = profile.extrusionWidth / columnsPerWidth;
+
+  const QVector3D *vertices = mesh.vertices.constData();
+  const quint32 *indices = mesh.indices.constData();
+  int facets = mesh.facetCount();
+  int gridWidth = mesh.gridWidth;
+  quint32 gridCount = gridWidth * mesh.gridHeight;
+  hasGrid = (mesh.gridWidth >= 2 && mesh.gridHeight >= 2 && (quint32)mesh.vertices.length() >= gridCount);
+
+  float lowX = INFINITY, highX = -INFINITY;
+  float lowY = INFINITY, highY = -INFINITY;
+  float lowZ = INFINITY, highZ = -INFINITY;
+  int firstX = INT_MAX, lastX = -1;
+  int firstY = INT_MAX, lastY = -1;
+  QVector<int> others;
+#pragma omp parallel
+  {
+    QVector<int> own;
+#pragma omp for schedule(static) reduction(min:lowX,lowY,lowZ,firstX,firstY) reduction(max:highX,highY,highZ,lastX,lastY)
+    for(int facet = 0; facet < facets; ++facet) {
+      const quint32 *facetIndices = indices + (facet * 3);
+      bool onGrid = hasGrid;
+      for(int a = 0; a < 3; ++a) {
+        const QVector3D &vertex = vertices[facetIndices[a]];
+        lowX = qMin(lowX, vertex.x());
+        highX = qMax(highX, vertex.x());
+        lowY = qMin(lowY, vertex.y());
+        highY = qMax(highY, vertex.y());
+        lowZ = qMin(lowZ, vertex.z());
+        highZ = qMax(highZ, vertex.z());
+        onGrid = onGrid && facetIndices[a] < gridCount;
+      }
+      if(onGrid) {
+        for(int a = 0; a < 3; ++a) {
+          int x = facetIndices[a] % gridWidth;
+          int y = facetIndices[a] / gridWidth;
+          firstX = qMin(firstX, x);
+          lastX = qMax(lastX, x);
+          firstY = qMin(firstY, y);
+          lastY = qMax(lastY, y);
+        }
+      } else {
+        own.append(facet);
+      }
+    }
+#pragma omp critical
+    others.append(own);
+  }
+  // Keeps the output independent of the thread scheduling
+  std::sort(others.begin(), others.end());
+  minX = lowX;
+  maxX = highX;
+  minY = lowY;
+  maxY = highY;
+  minZ = lowZ;
+  maxZ = highZ;
+  hasGrid = hasGrid && lastX > firstX && lastY > firstY;
+  gridFirstX = firstX;
+  gridLastX = lastX;
+  gridFirstY = firstY;
+  gridLastY = lastY;
+
+  // The grid facets all face the same way, so the first one tells if the
+  // image surface is entered or left when crossing it towards the front
+  for(int facet = 0; hasGrid && facet < facets; ++facet) {
+    const quint32 *facetIndices = indices + (facet * 3);
+    if(facetIndices[0] < gridCount && facetIndices[1] < gridCount && facetIndices[2] < gridCount) {
+      QVector3D a = vertices[facetIndices[0]];
+      QVector3D b = vertices[facetIndices[1]];
+      QVector3D c = vertices[facetIndices[2]];
+      float normalZ = ((b.x() - a.x()) * (c.y() - a.y())) - ((b.y() - a.y()) * (c.x() - a.x()));
+      if(normalZ != 0.0) {
+        gridWinding = (normalZ > 0.0?-1:1);
+        break;
+      }
+    }
+  }
+
+  float height = maxY - minY;
+  layers = 1;
+  if(height > firstLayerHeight) {
+    layers += (int)ceil(((height - firstLayerHeight) / layerHeight) - 0.0001);
+  }
+  layerFacets.fill(QVector<int>(), layers);
+  for(const auto &facet: others) {
+    const quint32 *facetIndices = indices + (facet * 3);
+    float low = qMin(qMin(vertices[facetIndices[0]].y(), vertices[facetIndices[1]].y()), vertices[facetIndices[2]].y());
+    float high = qMax(qMax(vertices[facetIndices[0]].y(), vertices[facetIndices[1]].y()), vertices[facetIndices[2]].y());
+    // Each layer is sliced through its middle
+    int layer = qMax(0, (int)floor((low - minY - firstLayerHeight) / layerHeight));
+    for(; layer < layers; ++layer) {
+      float y = minY + layerTop(layer) - (layerThickness(layer) * 0.5);
+      if(y > high) {
+        break;
+      }
+      if(y >= low) {
+        layerFacets[layer].append(facet);
+      }
+    }
+  }
+}
+
+int Slicer::firstColumn(const float &x) const
+{
+  // The first column with its centre at or beyond x
+  return (int)ceil(((x - minX) / resolution) - 0.5);
+}
+
+void Slicer::addSegment(QVector<Crossing> &crossings, const Point &a, const Point &b,
+                        const int &winding) const
+{
+  // Columns from the left end up to, but excluding, the right end, so
+  // columns at a shared end point are only crossed once
+  const Point &left = (a.x < b.x?a:b);
+  const Point &right = (a.x < b.x?b:a);
+  int last = firstColumn(right.x);
+  for(int column = firstColumn(left.x); column < last; ++column) {
+    float t = (columnX(column) - left.x) / (right.x - left.x);
+    crossings.append({column, left.z + ((right.z - left.z) * t), winding});
+  }
+}
+
+QVector<Island> Slicer::slice(const int &layer) const
+{
+  float y = minY + layerTop(layer) - (layerThickness(layer) * 0.5);
+  const QVector3D *vertices = mesh->vertices.constData();
+  QVector<Crossing> crossings;
+
+  // The image surface, bilinearly interpolated from the grid
+  if(hasGrid) {
+    int gridWidth = mesh->gridWidth;
+    float originX = vertices[0].x();
+    float originY = vertices[0].y();
+    float pitchX = vertices[1].x() - originX;
+    float pitchY = vertices[gridWidth].y() - originY;
+    float v = (y - originY) / pitchY;
+    if(v >= gridFirstY && v <= gridLastY) {
+      int row = qMin((int)v, gridLastY - 1);
+      float fractionY = v - row;
+      const QVector3D *bottom = vertices + (row * gridWidth);
+      const QVector3D *top = bottom + gridWidth;
+      int last = firstColumn(originX + (gridLastX * pitchX));
+      for(int column = firstColumn(originX + (gridFirstX * pitchX)); column < last; ++column) {
+        float u = (columnX(column) - originX) / pitchX;
+        int x = qBound(gridFirstX, (int)u, gridLastX - 1);
+        float fractionX = u - x;
+        float lower = (bottom[x].z() * (1.0f - fractionX)) + (bottom[x + 1].z() * fractionX);
+        float upper = (top[x].z() * (1.0f - fractionX)) + (top[x + 1].z() * fractionX);
+        crossings.append({column, (lower * (1.0f - fractionY)) + (upper * fractionY), gridWinding});
+      }
+    }
+  }
+
+  // Everything else is intersected with the slice plane. The facet normal
+  // tells if the solid is entered or left when crossing towards the front.
+  for(const auto &facet: layerFacets.at(layer)) {
+    QVector3D corners[3] = {mesh->vertex(facet * 3), mesh->vertex((facet * 3) + 1), mesh->vertex((facet * 3) + 2)};
+    float normalZ = ((corners[1].x() - corners[0].x()) * (corners[2].y() - corners[0].y())) -
+      ((corners[1].y() - corners[0].y()) * (corners[2].x() - corners[0].x()));
+    if(normalZ == 0.0) {
+      continue;
+    }
+    Point ends[2];
+    int found = 0;
+    for(int a = 0; a < 3; ++a) {
+      const QVector3D &from = corners[a];
+      const QVector3D &to = corners[(a + 1) % 3];
+      if((from.y() >= y) != (to.y() >= y) && found < 2) {
+        float t = (y - from.y()) / (to.y() - from.y());
+        ends[found++] = {from.x() + ((to.x() - from.x()) * t), from.z() + ((to.z() - from.z()) * t)};
+      }
+    }
+    if(found == 2) {
+      addSegment(crossings, ends[0], ends[1], (normalZ > 0.0?-1:1));
+    }
+  }
+  std::sort(crossings.begin(), crossings.end());
+
+  // Turn the crossings into intervals using the nonzero rule, which merges
+  // overlapping parts such as the frame and the image. Intervals in
+  // neighbouring columns that overlap one to one belong to the same island.
+  QVector<Island> islands;
+  QVector<int> open;
+  QVector<int> stillOpen;
+  QVector<Point> intervals;
+  int previousColumn = -2;
+  int a = 0;
+  while(a < crossings.length()) {
+    int column = crossings.at(a).column;
+    intervals.clear();
+    int winding = 0;
+    float start = 0.0;
+    for(; a < crossings.length() && crossings.at(a).column == column; ++a) {
+      const Crossing &crossing = crossings.at(a);
+      int before = winding;
+      winding += crossing.winding;
+      if(before == 0 && winding != 0) {
+        start = crossing.z;
+      } else if(before != 0 && winding == 0) {
+        if(!intervals.isEmpty() && start - intervals.last().z < mergeDistance) {
+          intervals.last().z = crossing.z;
+        } else {
+          intervals.append({start, crossing.z});
+        }
+      }
+    }
+    if(column != previousColumn + 1) {
+      open.clear();
+    }
+    stillOpen.clear();
+    for(const auto &interval: intervals) {
+      int match = -1;
+      int matches = 0;
+      for(const auto &index: open) {
+        const Island &island = islands.at(index);
+        if(island.lo.last() <= interval.z && island.hi.last() >= interval.x) {
+          match = index;
+          matches++;
+        }
+      }
+      if(matches == 1) {
+        const Island &island = islands.at(match);
+        for(const auto &other: intervals) {
+          if(&other != &interval && island.lo.last() <= other.z && island.hi.last() >= other.x) {
+            matches++;
+          }
+        }
+      }
+      if(matches != 1) {
+        match = islands.length();
+        islands.append(Island());
+        islands.last().first = column;
+      }
+      islands[match].lo.append(interval.x);
+      islands[match].hi.append(interval.z);
+      stillOpen.append(match);
+    }
+    open.swap(stillOpen);
+    previousColumn = column;
+  }
+
+  return islands;
+}
+
+static Island erode(const Island &island, const float &radius, const float &resolution)
+{
+  // Exact erosion by a disk: a point stays if the disk around it fits
+  // within every column it reaches. Each column remains a single interval.
+  int reach = (int)floor((radius / resolution) + 0.0001);
+  QVector<float> offsets(reach + 1);
+  for(int a = 0; a <= reach; ++a) {
+    offsets[a] = sqrt(qMax(0.0f, (radius * radius) - (a * resolution * a * resolution)));
+  }
+  Island eroded;
+  eroded.first = island.first;
+  eroded.lo.resize(island.length());
+  eroded.hi.resize(island.length());
+  for(int column = 0; column < island.length(); ++column) {
+    float lo = island.lo.at(column) + offsets.at(0);
+    float hi = island.hi.at(column) - offsets.at(0);
+    for(int a = 1; a <= reach && lo <= hi; ++a) {
+      for(const int &neighbour: {column - a, column + a}) {
+        if(neighbour < 0 || neighbour >= island.length() || island.isEmpty(neighbour)) {
+          lo = 1.0;
+          hi = 0.0;
+          break;
+        }
+        lo = qMax(lo, island.lo.at(neighbour) + offsets.at(a));
+        hi = qMin(hi, island.hi.at(neighbour) - offsets.at(a));
+      }
+    }
+    eroded.lo[column] = (lo <= hi?lo:1.0);
+    eroded.hi[column] = (lo <= hi?hi:0.0);
+  }
+
+  return eroded;
+}
+
+static QVector<Point> simplify(const QVector<Point> &points)
+{
+  // Douglas-Peucker. The front of the image changes with every column, but
+  // the back and the frame are straight.
+  if(points.length() < 3) {
+    return points;
+  }
+  QVector<char> keep(points.length(), 0);
+  keep.first() = 1;
+  keep.last() = 1;
+  QVector<QPair<int, int> > ranges({qMakePair(0, points.length() - 1)});
+  while(!ranges.isEmpty()) {
+    QPair<int, int> range = ranges.takeLast();
+    const Point &from = points.at(range.first);
+    const Point &to = points.at(range.second);
+    float length = distance(from, to);
+    float worst = 0.0;
+    int worstIndex = -1;
+    for(int a = range.first + 1; a < range.second; ++a) {
+      const Point &point = points.at(a);
+      float deviation = (length > 0.0?
+                         fabs(((to.x - from.x) * (from.z - point.z)) - ((from.x - point.x) * (to.z - from.z))) / length:
+                         distance(from, point));
+      if(deviation > worst) {
+        worst = deviation;
+        worstIndex = a;
+      }
+    }
+    if(worst > pathTolerance) {
+      keep[worstIndex] = 1;
+      ranges.append(qMakePair(range.first, worstIndex));
+      ranges.append(qMakePair(worstIndex, range.second));
+    }
+  }
+  QVector<Point> simplified;
+  for(int a = 0; a < points.length(); ++a) {
+    if(keep.at(a)) {
+      simplified.append(points.at(a));
+    }
+  }
+
+  return simplified;
+}
+
+static QVector<QVector<Point> > outlines(const Island &island, const Slicer &slicer)
+{
+  // One closed loop per run of non-empty columns, along the back from left
+  // to right and along the front back again
+  QVector<QVector<Point> > loops;
+  int column = 0;
+  while(column < island.length()) {
+    if(island.isEmpty(column)) {
+      column++;
+      continue;
+    }
+    QVector<Point> back;
+    QVector<Point> front;
+    for(; column < island.length() && !island.isEmpty(column); ++column) {
+      float x = slicer.columnX(island.first + column);
+      back.append({x, island.lo.at(column)});
+      front.append({x, island.hi.at(column)});
+    }
+    std::reverse(front.begin(), front.end());
+    QVector<Point> loop = simplify(back);
+    loop.append(simplify(front));
+    loops.append(loop);
+  }
+
+  return loops;
+}
+
+Toolpath::Toolpath(const PrinterProfile &profile, const float &offsetX, const float &offsetY,
+                   const float &top, const float &thickness)
+  : profile(profile), offsetX(offsetX), offsetY(offsetY), top(top)
+{
+  // Cross section of a flattened extrusion as used by most slicers: a
+  // rectangle with rounded ends
+  float area = (profile.extrusionWidth - (thickness * (1.0 - (M_PI / 4.0)))) * thickness;
+  float filamentArea = M_PI * (profile.filamentDiameter / 2.0) * (profile.filamentDiameter / 2.0);
+  extrusionPerMm = (area / filamentArea) * profile.extrusionMultiplier;
+}
+
+QByteArray Toolpath::coordinates(const Point &point) const
+{
+  return "X" + number(point.x + offsetX) + " Y" + number(point.z + offsetY);
+}
+
+void Toolpath::retract()
+{
+  if(!retracted && profile.retractLength > 0.0) {
+    gcode.append("G1 E-" + number(profile.retractLength, 5) + " F" + number(profile.retractSpeed * 60.0, 0) + "\n");
+    feedRate = profile.retractSpeed * 60.0;
+  }
+  retracted = true;
+}
+
+void Toolpath::travelTo(const Point &point)
+{
+  if(positionKnown && distance(position, point) < 0.0001) {
+    return;
+  }
+  if(!positionKnown || distance(position, point) > profile.retractBeforeTravel) {
+    retract();
+  }
+  bool lift = (retracted && profile.retractLift > 0.0);
+  if(lift) {
+    gcode.append("G1 Z" + number(top + profile.retractLift) + "\n");
+  }
+  gcode.append("G0 " + coordinates(point) + " F" + number(profile.travelSpeed * 60.0, 0) + "\n");
+  feedRate = profile.travelSpeed * 60.0;
+  if(lift) {
+    gcode.append("G1 Z" + number(top) + "\n");
+  }
+  position = point;
+  positionKnown = true;
+}
+
+void Toolpath::extrudeTo(const Point &point, const float &speed)
+{
+  float length = distance(position, point);
+  if(length < 0.0001) {
+    return;
+  }
+  if(retracted) {
+    if(profile.retractLength > 0.0) {
+      gcode.append("G1 E" + number(profile.retractLength, 5) + " F" + number(profile.retractSpeed * 60.0, 0) + "\n");
+      feedRate = profile.retractSpeed * 60.0;
+    }
+    retracted = false;
+  }
+  gcode.append("G1 " + coordinates(point) + " E" + number(length * extrusionPerMm, 5));
+  if(feedRate != speed * 60.0) {
+    feedRate = speed * 60.0;
+    gcode.append(" F" + number(feedRate, 0));
+  }
+  gcode.append("\n");
+  position = point;
+}
+
+void Toolpath::extrudeLoop(const QVector<Point> &loop, const float &speed)
+{
+  if(loop.isEmpty()) {
+    return;
+  }
+  travelTo(loop.first());
+  for(int a = 1; a < loop.length(); ++a) {
+    extrudeTo(loop.at(a), speed);
+  }
+  extrudeTo(loop.first(), speed);
+}
+
+QByteArray Toolpath::finish()
+{
+  retract();
+  return gcode;
+}
+
+static void addInfill(Toolpath &toolpath, const Island &region, const Slicer &slicer,
+                      const float &spacing, const bool &acrossThickness, const float &speed)
+{
+  if(acrossThickness) {
+    // Short lines through the thickness, zig-zagging along the layer. The
+    // columns are aligned to the same positions in every layer.
+    int step = qMax(1, qRound(spacing / slicer.resolution));
+    bool forwards = true;
+    int previous = INT_MIN;
+    for(int column = 0; column < region.length(); ++column) {
+      if((region.first + column) % step != 0 || region.isEmpty(column)) {
+        continue;
+      }
+      float x = slicer.columnX(region.first + column);
+      Point from = {x, (forwards?region.lo.at(column):region.hi.at(column))};
+      Point to = {x, (forwards?region.hi.at(column):region.lo.at(column))};
+      if(previous == column - step) {
+        toolpath.extrudeTo(from, speed);
+      } else {
+        toolpath.travelTo(from);
+      }
+      toolpath.extrudeTo(to, speed);
+      forwards = !forwards;
+      previous = column;
+    }
+  } else {
+    // Lines along the layer, alternating direction
+    float low = INFINITY;
+    float high = -INFINITY;
+    for(int column = 0; column < region.length(); ++column) {
+      if(!region.isEmpty(column)) {
+        low = qMin(low, region.lo.at(column));
+        high = qMax(high, region.hi.at(column));
+      }
+    }
+    bool forwards = true;
+    int line = qMax(0, (int)ceil(((low - slicer.minZ) / spacing) - 0.5));
+    for(float z = slicer.minZ + ((line + 0.5) * spacing); z <= high; z += spacing) {
+      QVector<QPair<float, float> > runs;
+      int column = 0;
+      while(column < region.length()) {
+        if(region.isEmpty(column) || region.lo.at(column) > z || region.hi.at(column) < z) {
+          column++;
+          continue;
+        }
+        int start = column;
+        while(column < region.length() && !region.isEmpty(column) &&
+              region.lo.at(column) <= z && region.hi.at(column) >= z) {
+          column++;
+        }
+        runs.append(qMakePair(slicer.columnX(region.first + start), slicer.columnX(region.first + column - 1)));
+      }
+      for(int a = 0; a < runs.length(); ++a) {
+        const QPair<float, float> &run = runs.at(forwards?a:runs.length() - 1 - a);
+        toolpath.travelTo({(forwards?run.first:run.second), z});
+        toolpath.extrudeTo({(forwards?run.second:run.first), z}, speed);
+      }
+      forwards = !forwards;
+    }
+  }
+}
+
+static QByteArray layerGcode(const Slicer &slicer, const PrinterProfile &profile, const int &layer,
+                             const float &offsetX, const float &offsetY)
+{
+  float top = slicer.layerTop(layer);
+  Toolpath toolpath(profile, offsetX, offsetY, top, slicer.layerThickness(layer));
+  toolpath.gcode.append(";LAYER:" + QByteArray::number(layer) + "\n");
+  if(layer == 1) {
+    toolpath.gcode.append("M104 S" + QByteArray::number(profile.temperature) + "\n");
+    toolpath.gcode.append("M140 S" + QByteArray::number(profile.bedTemperature) + "\n");
+  }
+  if(layer == profile.disableFanFirstLayers && profile.fanSpeed > 0) {
+    toolpath.gcode.append("M106 S" + QByteArray::number(qRound(profile.fanSpeed * 2.55)) + "\n");
+  }
+  toolpath.gcode.append("G1 Z" + number(top) + " F" + number(profile.travelSpeed * 60.0, 0) + "\n");
+
+  float width = profile.extrusionWidth;
+  float perimeterSpeed = (layer == 0?profile.firstLayerSpeed:profile.perimeterSpeed);
+  float infillSpeed = (layer == 0?profile.firstLayerSpeed:profile.infillSpeed);
+  for(const auto &island: slicer.slice(layer)) {
+    // Perimeters are printed from the inside out, the outermost last
+    QVector<Island> perimeters;
+    for(int a = 0; a < profile.perimeters; ++a) {
+      perimeters.append(erode((a == 0?island:perimeters.last()), (a == 0?width * 0.5:width), slicer.resolution));
+    }
+    for(int a = perimeters.length() - 1; a >= 0; --a) {
+      for(const auto &loop: outlines(perimeters.at(a), slicer)) {
+        toolpath.extrudeLoop(loop, perimeterSpeed);
+      }
+    }
+    // Infill overlaps the innermost perimeter by a quarter of its width
+    if(profile.infillDensity > 0.0) {
+      Island region = (perimeters.isEmpty()?erode(island, width * 0.5, slicer.resolution):
+                       erode(perimeters.last(), width * 0.75, slicer.resolution));
+      addInfill(toolpath, region, slicer, width / profile.infillDensity, layer % 2 == 0, infillSpeed);
+    }
+  }
+
+  return toolpath.finish();
+}
+
+GcodeExporter::GcodeExporter(const PrinterProfile &printerProfile) : printerProfile(printerProfile)
+{
+}
+
+QString GcodeExporter::name() const
+{
+  return "G-code (experimental)";
+}
+
+QString GcodeExporter::suffix() const
+{
+  return "gcode";
+}
+
+bool GcodeExporter::exportMesh(const Mesh &mesh, const QString &filename)
+{
+  if(mesh.isEmpty()) {
+    return false;
+  }
+  const PrinterProfile &profile = printerProfile;
+  Slicer slicer;
+  {
+    TRACE_SCOPE("gcode prepare");
+    slicer.prepare(mesh, profile);
+  }
+
+  // Standing upright, centered on the bed. The width of the lithophane runs
+  // along x and its thickness along y.
+  float sizeX = slicer.maxX - slicer.minX;
+  float sizeY = slicer.maxZ - slicer.minZ;
+  float sizeZ = slicer.layerTop(slicer.layers - 1);
+  if(sizeX > profile.bedMaxX - profile.bedMinX || sizeY > profile.bedMaxY - profile.bedMinY ||
+     sizeZ > profile.maxPrintHeight) {
+    printf("Lithophane (%.1f x %.1f x %.1f mm) doesn't fit the printer.\n", sizeX, sizeY, sizeZ);
+    return false;
+  }
+  float offsetX = ((profile.bedMinX + profile.bedMaxX - sizeX) / 2.0) - slicer.minX;
+  float offsetY = ((profile.bedMinY + profile.bedMaxY - sizeY) / 2.0) - slicer.minZ;
+
+  QFile gcodeFile(filename);
+  if(!gcodeFile.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  QByteArray header = "; Generated by LithoMaker " VERSION " (experimental G-code export)\n"
+    "; layers = " + QByteArray::number(slicer.layers) + "\n"
+    "; layer_height = " + number(profile.layerHeight) + "\n"
+    "; extrusion_width = " + number(profile.extrusionWidth) + "\n"
+    "; perimeters = " + QByteArray::number(profile.perimeters) + "\n"
+    "; fill_density = " + QByteArray::number(qRound(profile.infillDensity * 100.0)) + "%\n";
+  header.append(profile.expandPlaceholders(profile.startGcode).toUtf8());
+  if(!header.endsWith("\n")) {
+    header.append("\n");
+  }
+  // Relative extrusion, so every layer can be generated on its own
+  header.append("G21\nG90\nM83\nG92 E0\n");
+  if(profile.retractLength > 0.0) {
+    header.append("G1 E-" + number(profile.retractLength, 5) + " F" + number(profile.retractSpeed * 60.0, 0) + "\n");
+  }
+  bool success = (gcodeFile.write(header) == header.size());
+
+  // Layers are generated in batches to bound the memory held at once
+  int batchSize = omp_get_max_threads() * 4;
+  QVector<QByteArray> layers(batchSize);
+  for(int first = 0; success && first < slicer.layers; first += batchSize) {
+    int count = qMin(batchSize, slicer.layers - first);
+#pragma omp parallel for schedule(dynamic)
+    for(int a = 0; a < count; ++a) {
+      TRACE_SCOPE("gcode layer");
+      layers[a] = layerGcode(slicer, profile, first + a, offsetX, offsetY);
+    }
+    for(int a = 0; success && a < count; ++a) {
+      success = (gcodeFile.write(layers.at(a)) == layers.at(a).size());
+      layers[a] = QByteArray();
+    }
+  }
+
+  QByteArray footer = "M107\n" + profile.expandPlaceholders(profile.endGcode).toUtf8();
+  if(!footer.endsWith("\n")) {
+    footer.append("\n");
+  }
+  // Closing doesn't report a failed flush of the buffered tail
+  success = success && (gcodeFile.write(footer) == footer.size()) && gcodeFile.flush();
+  gcodeFile.close();
+
+  return success;
+}
@@ -0,0 +1,53 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            gcodeexporter.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __GCODEEXPORTER_H__
+#define __GCODEEXPORTER_H__
+
+#include <QString>
+
+#include "exporter.h"
+#include "printerprofile.h"
+
+// Experimental. Slices the lithophane standing upright straight into
+// G-code for the printer profile, skipping the slicer. The heightmap is
+// sliced from the grid directly, only the frame, stabilizer and hanger
+// facets are intersected with the layers. Each layer is sliced into
+// perimeters and rectilinear infill independently, so layers are sliced in
+// parallel.
+class GcodeExporter : public Exporter
+{
+public:
+  GcodeExporter(const PrinterProfile &printerProfile);
+  QString name() const override;
+  QString suffix() const override;
+  bool exportMesh(const Mesh &mesh, const QString &filename) override;
+
+private:
+  PrinterProfile printerProfile;
+};
+
+#endif // __GCODEEXPORTER_H__
@@ -0,0 +1,567 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            goldensuite.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <omp.h>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QCryptographicHash>
+
+#include "goldensuite.h"
+#include "lithophane.h"
+#include "renderjob.h"
+#include "meshfile.h"
+#include "meshfileexporter.h"
+#include "meshcomparison.h"
+#include "meshvalidation.h"
+
+constexpr int manifestVersion = 2;
+static const char *manifestName = "golden.json";
+// Frame borders of the settings matrix in mm
+static const float frameBorders[] = { 3.0, 6.0 };
+// No stabilizers, detachable and permanent stabilizers
+static const char *stabilizerNames[] = { "s0", "sd", "sp" };
+// The exported files compared by hash, the job also writes an .lmesh file
+// to compare its mesh
+static const QStringList exportFormats = { "binary", "ascii" };
+// Bands the memory budget of the banded job is sized for
+constexpr int bandedBands = 4;
+// The kinds of PNG decoded by the PNG reader, checked against QImage
+static const struct {
+  const char *name;
+  QImage::Format format;
+} pngFormats[] = {
+  { "gray8", QImage::Format_Grayscale8 },
+  { "gray16", QImage::Format_Grayscale16 },
+  { "rgb", QImage::Format_RGB32 }
+};
+
+GoldenSuite::GoldenSuite(const QString &goldenDir) : goldenDir(goldenDir)
+{
+}
+
+GoldenSuite::~GoldenSuite()
+{
+}
+
+void GoldenSuite::setInputFiles(const QStringList &inputFiles)
+{
+  this->inputFiles = inputFiles;
+}
+
+void GoldenSuite::setMaxSize(const int &maxSize)
+{
+  this->maxSize = maxSize;
+}
+
+void GoldenSuite::setTolerance(const float &tolerance)
+{
+  this->tolerance = tolerance;
+}
+
+int GoldenSuite::record()
+{
+  return run(true);
+}
+
+int GoldenSuite::check()
+{
+  return run(false);
+}
+
+QList<GoldenSuite::GoldenCase> GoldenSuite::cases(const QString &inputFile) const
+{
+  // The matrix starts from the built in defaults, so the config never
+  // changes what is rendered
+  QString baseName = QFileInfo(inputFile).completeBaseName();
+  QList<GoldenCase> result;
+  for(int stabilizers = 0; stabilizers < 3; ++stabilizers) {
+    for(int hangers = 0; hangers < 2; ++hangers) {
+      for(const auto &frameBorder: frameBorders) {
+        GoldenCase goldenCase;
+        goldenCase.name = baseName + "_" + stabilizerNames[stabilizers] + "_h" + QString::number(hangers) +
+          "_b" + QString::number(frameBorder);
+        goldenCase.renderSettings.enableStabilizers = (stabilizers > 0);
+        goldenCase.renderSettings.permanentStabilizers = (stabilizers == 2);
+        // Wide images can stay below the default height threshold, which
+        // would silently leave the stabilizers out
+        goldenCase.renderSettings.stabilizerThreshold = 0.0;
+        goldenCase.renderSettings.enableHangers = (hangers == 1);
+        goldenCase.renderSettings.frameBorder = frameBorder;
+        result.append(goldenCase);
+      }
+    }
+  }
+  // A 2 x 2 grid of tiles with alignment lips, named like the ui names them
+  for(int row = 0; row < 2; ++row) {
+    for(int column = 0; column < 2; ++column) {
+      GoldenCase goldenCase;
+      goldenCase.name = baseName + QString("_tiled_r%1c%2").arg(row + 1).arg(column + 1);
+      goldenCase.renderSettings.tileColumns = 2;
+      goldenCase.renderSettings.tileRows = 2;
+      goldenCase.renderSettings.alignmentLips = true;
+      goldenCase.renderSettings.tileColumn = column;
+      goldenCase.renderSettings.tileRow = row;
+      result.append(goldenCase);
+    }
+  }
+
+  return result;
+}
+
+bool GoldenSuite::compareMesh(const QString &mode, const Mesh &mesh, const QString &expectedHash,
+                              const QString &goldenFile, Mesh &golden, QStringList &results) const
+{
+  if(QString(MeshComparison::hash(mesh)) == expectedHash) {
+    results.append(mode + " identical");
+    return true;
+  }
+  // The golden mesh is only loaded once something differs
+  if(golden.isEmpty()) {
+    MeshFile meshFile(goldenFile);
+    if(!meshFile.open()) {
+      results.append(mode + " differs, golden mesh could not be read: " + meshFile.errorString());
+      return false;
+    }
+    golden = meshFile.mesh();
+  }
+  MeshComparison comparison = MeshComparison::compare(mesh, golden, tolerance);
+  if(comparison.isEquivalent()) {
+    results.append(mode + " equivalent, largest deviation " + QString::number(comparison.maxDeviation) + " mm");
+    return true;
+  }
+  results.append(mode + " differs, " + comparison.summary());
+  return false;
+}
+
+RenderJob GoldenSuite::caseJob(const QString &inputFile, const RenderSettings &renderSettings) const
+{
+  RenderJob job;
+  job.inputFile = inputFile;
+  job.maxSize = maxSize;
+  job.renderSettings = renderSettings;
+
+  return job;
+}
+
+qint64 GoldenSuite::bandedMemory(const RenderJob &job, const int &bands)
+{
+  // Sized the way the job plans it, so the plan gets exactly these bands
+  QSize decodedSize = QImageReader(job.inputFile).size();
+  QSize renderSize = decodedSize;
+  if(job.maxSize > 0 && (renderSize.width() > job.maxSize || renderSize.height() > job.maxSize)) {
+    renderSize.scale(job.maxSize, job.maxSize, Qt::KeepAspectRatio);
+  }
+  if(job.renderSettings.isTiled()) {
+    renderSize = RenderJob::tileRect(renderSize, job.renderSettings).size();
+  }
+  qint64 decoded = (decodedSize != renderSize?(qint64)decodedSize.width() * decodedSize.height() * 4:0);
+  int bandRows = qMax(1, (renderSize.height() - 1) / bands);
+
+  return decoded + Lithophane::estimateBandMemory(renderSize.width(), renderSize.height(), bandRows);
+}
+
+bool GoldenSuite::compareJob(const QString &mode, const RenderJob &job, const QJsonObject &expected,
+                             const QString &goldenFile, Mesh &golden, QStringList &results) const
+{
+  // The mesh is read back from the .lmesh output, or from the binary STL of
+  // jobs that stream their outputs
+  Mesh mesh;
+  for(const auto &output: job.outputs) {
+    if(output.format == "lmesh") {
+      MeshFile meshFile(output.file);
+      if(meshFile.open()) {
+        mesh = meshFile.mesh();
+      }
+      break;
+    }
+    if(output.format == "binary") {
+      mesh = readStl(output.file);
+    }
+  }
+  QString expectedHash = expected.value("meshHash").toString();
+  bool ok = compareMesh(mode, mesh, expectedHash, goldenFile, golden, results);
+  bool identical = (QString(MeshComparison::hash(mesh)) == expectedHash);
+  for(const auto &output: job.outputs) {
+    if(expected.contains(output.format)) {
+      QString format = mode + " " + output.format;
+      if(fileHash(output.file) == expected.value(output.format).toString()) {
+        results.append(format + " identical");
+      } else if(identical) {
+        // The same mesh must always be exported to the same bytes
+        results.append(format + " differs");
+        ok = false;
+      } else {
+        results.append(format + " changed with the mesh");
+      }
+    }
+    QFile::remove(output.file);
+  }
+
+  return ok;
+}
+
+bool GoldenSuite::comparePng(const QString &name, const QImage &image, const QString &directory,
+                             QStringList &results) const
+{
+  bool ok = true;
+  for(const auto &pngFormat: pngFormats) {
+    // Rebuilt from the pixels alone, since a saved color space would leave
+    // color images to QImage
+    QImage converted = image.convertToFormat(pngFormat.format);
+    QImage plain(converted.size(), converted.format());
+    for(int y = 0; y < plain.height(); ++y) {
+      memcpy(plain.scanLine(y), converted.constScanLine(y), plain.bytesPerLine());
+    }
+    QString pngFile = QDir(directory).filePath(name + "_" + pngFormat.name + ".png");
+    if(!plain.save(pngFile, "PNG")) {
+      results.append(QString(pngFormat.name) + " could not be written");
+      ok = false;
+      continue;
+    }
+    Lithophane pngLithophane;
+    Lithophane imageLithophane;
+    if(!pngLithophane.loadPng(pngFile)) {
+      results.append(QString(pngFormat.name) + " left to QImage");
+      ok = false;
+    } else {
+      imageLithophane.setImage(QImage(pngFile));
+      // The heights and the topology built alongside decoding must both match
+      RenderSettings renderSettings;
+      if(pngLithophane.contentHash() == imageLithophane.contentHash() &&
+         MeshComparison::hash(pngLithophane.render(renderSettings)) ==
+         MeshComparison::hash(imageLithophane.render(renderSettings))) {
+        results.append(QString(pngFormat.name) + " identical");
+      } else {
+        results.append(QString(pngFormat.name) + " differs");
+        ok = false;
+      }
+    }
+    QFile::remove(pngFile);
+  }
+
+  return ok;
+}
+
+QString GoldenSuite::fileHash(const QString &filename)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly)) {
+    return QString();
+  }
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  hash.addData(&file);
+  return hash.result().toHex();
+}
+
+Mesh GoldenSuite::readStl(const QString &filename)
+{
+  Mesh mesh;
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly)) {
+    return mesh;
+  }
+  QByteArray data = file.readAll();
+  quint32 facets = 0;
+  if(data.size() >= 84) {
+    memcpy(&facets, data.constData() + 80, sizeof(quint32));
+  }
+  if(data.size() != 84 + ((qint64)facets * 50)) {
+    return mesh;
+  }
+  // Each facet holds a normal, three corners and two attribute bytes
+  mesh.vertices.reserve(facets * 3);
+  mesh.indices.reserve(facets * 3);
+  for(quint32 facet = 0; facet < facets; ++facet) {
+    const char *corners = data.constData() + 84 + (facet * 50) + 12;
+    for(int corner = 0; corner < 3; ++corner) {
+      float xyz[3];
+      memcpy(xyz, corners + (corner * 12), sizeof(xyz));
+      mesh.indices.append(mesh.vertices.length());
+      mesh.vertices.append(QVector3D(xyz[0], xyz[1], xyz[2]));
+    }
+  }
+
+  return mesh;
+}
+
+int GoldenSuite::run(const bool &recording)
+{
+  QDir dir(goldenDir);
+  QString manifestFile = dir.filePath(manifestName);
+  QJsonObject goldenCases;
+  if(recording) {
+    if(inputFiles.isEmpty()) {
+      printf("No input images to record golden meshes from.\n");
+      return 1;
+    }
+    if(!dir.mkpath(".")) {
+      printf("Golden directory '%s' could not be created.\n", goldenDir.toStdString().c_str());
+      return 1;
+    }
+  } else {
+    QFile file(manifestFile);
+    if(!file.open(QIODevice::ReadOnly)) {
+      printf("Golden manifest '%s' could not be read.\n", manifestFile.toStdString().c_str());
+      return 1;
+    }
+    manifest = QJsonDocument::fromJson(file.readAll()).object();
+    if(manifest.value("version").toInt() != manifestVersion) {
+      printf("Golden manifest '%s' is invalid or from another version.\n", manifestFile.toStdString().c_str());
+      return 1;
+    }
+    goldenCases = manifest.value("cases").toObject();
+    // The meshes can only be compared at the size they were recorded at
+    maxSize = manifest.value("maxSize").toInt();
+    if(inputFiles.isEmpty()) {
+      for(const auto &inputFile: manifest.value("inputFiles").toArray()) {
+        inputFiles.append(inputFile.toString());
+      }
+    }
+  }
+  // The render job writes its outputs here to have them hashed
+  QTemporaryDir outputDir;
+  if(!outputDir.isValid()) {
+    printf("Temporary directory for the job outputs could not be created.\n");
+    return 1;
+  }
+
+  int threads = omp_get_max_threads();
+  int failed = 0;
+  int total = 0;
+  for(const auto &inputFile: inputFiles) {
+    QImage image(inputFile);
+    if(image.isNull()) {
+      printf("Input file '%s' could not be loaded.\n", inputFile.toStdString().c_str());
+      failed++;
+      continue;
+    }
+    // Scaled the same way as in the render job
+    if(maxSize > 0 && (image.width() > maxSize || image.height() > maxSize)) {
+      if(image.width() > image.height()) {
+        image = image.scaledToWidth(maxSize);
+      } else {
+        image = image.scaledToHeight(maxSize);
+      }
+    }
+    // The golden images are scaled, so the jobs never decode them with the
+    // PNG reader. It is checked on the scaled image against QImage instead.
+    QString baseName = QFileInfo(inputFile).completeBaseName();
+    QStringList pngResults;
+    total++;
+    printf("Checking '%s' as PNG... ", baseName.toStdString().c_str());
+    fflush(stdout);
+    if(comparePng(baseName, image, outputDir.path(), pngResults)) {
+      printf("Success: %s\n", pngResults.join(", ").toStdString().c_str());
+    } else {
+      printf("Failed: %s\n", pngResults.join(", ").toStdString().c_str());
+      failed++;
+    }
+    // Shared by the untiled cases of the image, the way the sweep reuses it
+    Lithophane shared;
+    for(const auto &goldenCase: cases(inputFile)) {
+      total++;
+      printf("%s '%s'... ", recording?"Recording":"Checking", goldenCase.name.toStdString().c_str());
+      fflush(stdout);
+      const RenderSettings &renderSettings = goldenCase.renderSettings;
+      QString goldenFile = dir.filePath(goldenCase.name + ".lmesh");
+      QJsonObject expected = goldenCases.value(goldenCase.name).toObject();
+      if(!recording && expected.isEmpty()) {
+        printf("Failed, no golden mesh recorded!\n");
+        failed++;
+        continue;
+      }
+      QImage caseImage = (renderSettings.isTiled()?image.copy(RenderJob::tileRect(image.size(), renderSettings)):image);
+
+      // The single threaded render is the reference for the other modes
+      omp_set_num_threads(1);
+      Lithophane serialLithophane;
+      serialLithophane.setImage(caseImage);
+      Mesh serial = serialLithophane.render(renderSettings);
+      omp_set_num_threads(threads);
+      Mesh golden;
+      if(recording) {
+        MeshValidation validation = MeshValidation::check(serial);
+        if(!validation.isValid()) {
+          printf("Failed, mesh validation: %s\n", validation.report().toStdString().c_str());
+          failed++;
+          continue;
+        }
+        if(!MeshFileExporter().exportMesh(serial, goldenFile)) {
+          printf("Failed, golden mesh could not be written!\n");
+          failed++;
+          continue;
+        }
+        golden = serial;
+        expected.insert("settings", renderSettings.toJson());
+        expected.insert("facets", serial.facetCount());
+        expected.insert("meshHash", QString(MeshComparison::hash(serial)));
+      }
+      QString expectedHash = expected.value("meshHash").toString();
+      QStringList results;
+      bool ok = compareMesh("serial", serial, expectedHash, goldenFile, golden, results);
+
+      Lithophane tileLithophane;
+      Lithophane &lithophane = (renderSettings.isTiled()?tileLithophane:shared);
+      if(lithophane.isNull()) {
+        lithophane.setImage(caseImage);
+      }
+      Mesh parallel = lithophane.render(renderSettings);
+      ok = compareMesh("parallel", parallel, expectedHash, goldenFile, golden, results) && ok;
+      // Welding must only share vertices, never move or drop facets
+      ok = compareMesh("welded", parallel.welded(), expectedHash, goldenFile, golden, results) && ok;
+
+      // The complete job decodes, scales and crops the image itself
+      RenderJob job = caseJob(inputFile, renderSettings);
+      job.addOutputs(QDir(outputDir.path()).filePath(goldenCase.name + ".lmesh"), "lmesh", exportFormats);
+      Lithophane jobLithophane;
+      if(job.run(jobLithophane) != RenderJob::Finished) {
+        results.append("job failed, " + job.errorString);
+        ok = false;
+      } else {
+        if(recording) {
+          for(const auto &output: job.outputs) {
+            if(output.format != "lmesh") {
+              expected.insert(output.format, fileHash(output.file));
+            }
+          }
+        }
+        ok = compareJob("job", job, expected, goldenFile, golden, results) && ok;
+      }
+
+      // Banded within a memory budget, streaming the bands to the STL files
+      RenderJob bandedJob = caseJob(inputFile, renderSettings);
+      bandedJob.addOutputs(QDir(outputDir.path()).filePath(goldenCase.name + ".stl"), "binary", exportFormats);
+      bandedJob.maxMemory = bandedMemory(bandedJob, bandedBands);
+      Lithophane bandedLithophane;
+      if(bandedJob.run(bandedLithophane) != RenderJob::Finished) {
+        results.append("banded failed, " + bandedJob.errorString);
+        ok = false;
+      } else if(bandedJob.renderPlan.strategy != RenderPlan::Banded) {
+        results.append("banded rendered " + bandedJob.renderPlan.name());
+        ok = false;
+      } else {
+        ok = compareJob("banded", bandedJob, expected, goldenFile, golden, results) && ok;
+      }
+
+      // Checkpointed in the same bands, interrupted once the first band is
+      // written and resumed by a new lithophane, as after a restart
+      RenderJob checkpointJob = caseJob(inputFile, renderSettings);
+      checkpointJob.addOutputs(QDir(outputDir.path()).filePath(goldenCase.name + "_checkpoint.stl"), "binary",
+                               exportFormats);
+      checkpointJob.maxMemory = bandedMemory(checkpointJob, bandedBands);
+      checkpointJob.checkpoint = true;
+      Lithophane interruptedLithophane;
+      QObject::connect(&interruptedLithophane, &Lithophane::progress, [&interruptedLithophane](int value, int) {
+          if(value > 0) {
+            interruptedLithophane.cancel();
+          }
+        });
+      RenderJob::Status checkpointStatus = checkpointJob.run(interruptedLithophane);
+      if(checkpointStatus != RenderJob::Cancelled) {
+        results.append(checkpointStatus == RenderJob::Failed?"checkpoint failed, " + checkpointJob.errorString:
+                       QString("checkpoint finished before it was interrupted"));
+        ok = false;
+      } else {
+        Lithophane resumedLithophane;
+        if(checkpointJob.run(resumedLithophane) != RenderJob::Finished) {
+          results.append("checkpoint failed to resume, " + checkpointJob.errorString);
+          ok = false;
+        } else if(checkpointJob.stats.resumedRows <= 0) {
+          results.append("checkpoint rendered again from the start");
+          ok = false;
+        } else {
+          ok = compareJob("checkpoint", checkpointJob, expected, goldenFile, golden, results) && ok;
+        }
+      }
+
+      // Split into two bands rendered by separate jobs, then merged into
+      // the outputs by a third, as when they run on different hosts
+      RenderJob splitJob = caseJob(inputFile, renderSettings);
+      splitJob.addOutputs(QDir(outputDir.path()).filePath(goldenCase.name + "_split.lmesh"), "lmesh",
+                          exportFormats);
+      splitJob.bands = 2;
+      bool split = true;
+      for(int band = 0; band < splitJob.bands && split; ++band) {
+        RenderJob bandJob = splitJob;
+        bandJob.band = band;
+        Lithophane bandLithophane;
+        if(bandJob.run(bandLithophane) != RenderJob::Finished) {
+          results.append("split band " + QString::number(band + 1) + " failed, " + bandJob.errorString);
+          split = false;
+        }
+      }
+      if(split) {
+        splitJob.merge = true;
+        Lithophane mergeLithophane;
+        if(splitJob.run(mergeLithophane) != RenderJob::Finished) {
+          results.append("split merge failed, " + splitJob.errorString);
+          split = false;
+        } else {
+          ok = compareJob("split", splitJob, expected, goldenFile, golden, results) && ok;
+        }
+      }
+      ok = split && ok;
+
+      if(recording) {
+        goldenCases.insert(goldenCase.name, expected);
+      }
+      if(ok) {
+        printf("Success, %d facets: %s\n", serial.facetCount(), results.join(", ").toStdString().c_str());
+      } else {
+        printf("Failed: %s\n", results.join(", ").toStdString().c_str());
+        failed++;
+      }
+    }
+  }
+
+  if(recording) {
+    if(failed > 0) {
+      printf("Golden manifest not written, %d of %d cases failed.\n", failed, total);
+      return 1;
+    }
+    manifest.insert("version", manifestVersion);
+    manifest.insert("maxSize", maxSize);
+    manifest.insert("inputFiles", QJsonArray::fromStringList(inputFiles));
+    manifest.insert("cases", goldenCases);
+    QSaveFile file(manifestFile);
+    if(!file.open(QIODevice::WriteOnly) ||
+       file.write(QJsonDocument(manifest).toJson()) == -1 || !file.commit()) {
+      printf("Golden manifest '%s' could not be written.\n", manifestFile.toStdString().c_str());
+      return 1;
+    }
+  }
+  printf("%d of %d cases passed.\n", total - failed, total);
+
+  return (failed == 0?0:1);
+}
@@ -0,0 +1,97 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            goldensuite.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __GOLDENSUITE_H__
+#define __GOLDENSUITE_H__
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QImage>
+#include <QJsonObject>
+
+#include "rendersettings.h"
+#include "mesh.h"
+#include "renderjob.h"
+
+// Renders a set of images with a fixed matrix of render settings and checks
+// the meshes and exported files against golden copies recorded earlier, so
+// changes to the mesh code can be verified to keep the output the same.
+// Every case is rendered on one thread, on all threads reusing the
+// lithophane of the previous case, through a complete render job, through
+// a job banded by its memory budget, through the same job checkpointed,
+// interrupted and resumed, and split into two bands merged by a third job.
+// The reference is the single threaded render. Each image is also checked
+// to decode the same with the PNG reader as with QImage. Meshes are first compared by
+// hash and, if that fails, against the golden mesh within a tolerance and
+// in any facet order.
+class GoldenSuite
+{
+public:
+  GoldenSuite(const QString &goldenDir);
+  ~GoldenSuite();
+  // Defaults to the images the golden meshes were recorded from
+  void setInputFiles(const QStringList &inputFiles);
+  void setMaxSize(const int &maxSize);
+  void setTolerance(const float &tolerance);
+  // Renders every case and writes the golden meshes and manifest
+  int record();
+  // Renders every case and compares it against the golden meshes
+  int check();
+
+private:
+  struct GoldenCase
+  {
+    QString name;
+    RenderSettings renderSettings;
+  };
+
+  int run(const bool &recording);
+  QList<GoldenCase> cases(const QString &inputFile) const;
+  bool compareMesh(const QString &mode, const Mesh &mesh, const QString &expectedHash,
+                   const QString &goldenFile, Mesh &golden, QStringList &results) const;
+  RenderJob caseJob(const QString &inputFile, const RenderSettings &renderSettings) const;
+  // A memory budget the job plans to render in the given number of bands
+  static qint64 bandedMemory(const RenderJob &job, const int &bands);
+  // Compares the mesh and exported files of a finished job and removes them
+  bool compareJob(const QString &mode, const RenderJob &job, const QJsonObject &expected,
+                  const QString &goldenFile, Mesh &golden, QStringList &results) const;
+  // Saves the image as each kind of PNG the PNG reader decodes and checks
+  // that it renders the same as the image loaded by QImage
+  bool comparePng(const QString &name, const QImage &image, const QString &directory,
+                  QStringList &results) const;
+  static QString fileHash(const QString &filename);
+  // Reads a binary STL file into a mesh without shared vertices
+  static Mesh readStl(const QString &filename);
+
+  QString goldenDir;
+  QStringList inputFiles;
+  int maxSize = 200;
+  float tolerance = 0.001;
+  QJsonObject manifest;
+};
+
+#endif // __GOLDENSUITE_H__
@@ -0,0 +1,1635 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            lithophane.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <omp.h>
+
+#include <QCryptographicHash>
+
+#include "lithophane.h"
+#include "pngreader.h"
+#include "trace.h"
+
+// Cells per block when building the grid, and rows per band when placing
+// the vertices. A block of facet indices is 192 kB, a band of vertices at
+// 2000 pixels wide about 1.5 MB.
+constexpr int blockWidth = 128;
+constexpr int blockHeight = 64;
+
+Lithophane::Lithophane()
+{
+}
+
+Lithophane::~Lithophane()
+{
+}
+
+void Lithophane::setImage(QImage image, const bool &topology)
+{
+  TRACE_SCOPE("prepare image");
+  // Converting or inverting the image detaches it from the caller's copy
+  TrackedBuffer imageBuffer(MemoryStats::Image);
+  if(!image.isGrayscale()) {
+    TRACE_SCOPE("grayscale");
+    printf("Converting image to grayscale.\n");
+    image = image.convertToFormat(QImage::Format_Grayscale8);
+  }
+  {
+    TRACE_SCOPE("invert");
+    image.invertPixels();
+  }
+  imageBuffer.resize(image.sizeInBytes());
+
+  imageWidth = image.width();
+  imageHeight = image.height();
+
+  // Heights are stored bottom row first, since y points upwards in the mesh
+  TRACE_SCOPE("heightmap");
+  heights.resize(imageWidth * imageHeight);
+  for(int y = 0; y < imageHeight; ++y) {
+    quint8 *row = heights.data() + (y * imageWidth);
+    if(image.format() == QImage::Format_Grayscale8) {
+      memcpy(row, image.constScanLine(imageHeight - 1 - y), imageWidth);
+    } else {
+      for(int x = 0; x < imageWidth; ++x) {
+        row[x] = image.pixelColor(x, imageHeight - 1 - y).red();
+      }
+    }
+  }
+
+  gridIndices.clear();
+  if(topology) {
+    buildTopology();
+  }
+  heightmapBuffer.resize(imageMemory());
+}
+
+bool Lithophane::loadPng(const QString &filename, const bool &topology)
+{
+  TRACE_SCOPE("prepare image");
+  PngReader reader(filename);
+  if(!reader.open()) {
+    return false;
+  }
+  if(!reader.isGrayscale()) {
+    printf("Converting image to grayscale.\n");
+  }
+  imageWidth = reader.width();
+  imageHeight = reader.height();
+  heights.resize(imageWidth * imageHeight);
+
+  // The topology only depends on the size of the image
+  gridIndices.clear();
+  std::thread topologyThread;
+  if(topology) {
+    topologyThread = std::thread([this]() {
+        buildTopology();
+      });
+  }
+  bool success = reader.read(heights.data());
+  if(topologyThread.joinable()) {
+    topologyThread.join();
+  }
+  if(!success) {
+    printf("ERROR: PNG image could not be decoded: %s\n", reader.errorString().toStdString().c_str());
+    imageWidth = 0;
+    imageHeight = 0;
+    heights.clear();
+    gridIndices.clear();
+  }
+  heightmapBuffer.resize(imageMemory());
+
+  return success;
+}
+
+void Lithophane::shareImage(const Lithophane &other)
+{
+  // The prepared heights and topology are implicitly shared, so this is cheap
+  imageWidth = other.imageWidth;
+  imageHeight = other.imageHeight;
+  heights = other.heights;
+  gridIndices = other.gridIndices;
+  // Accounted for by the lithophane that prepared them
+  heightmapBuffer.resize(0);
+}
+
+qint64 Lithophane::imageMemory() const
+{
+  return (qint64)heights.length() + ((qint64)gridIndices.length() * sizeof(quint32));
+}
+
+QByteArray Lithophane::contentHash() const
+{
+  // Hashes the prepared heights, so identical images hash the same no matter
+  // which file format or color depth they were decoded from
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  hash.addData(QByteArray::number(imageWidth) + "x" + QByteArray::number(imageHeight));
+  hash.addData((const char *)heights.constData(), heights.length());
+  return hash.result();
+}
+
+void Lithophane::cancel()
+{
+  // Cancelling is permanent for this instance. Any ongoing and later renders
+  // return an empty mesh.
+  cancelled.storeRelease(1);
+}
+
+bool Lithophane::isCancelled() const
+{
+  return cancelled.loadAcquire();
+}
+
+bool Lithophane::isNull() const
+{
+  return heights.isEmpty();
+}
+
+int Lithophane::width() const
+{
+  return imageWidth;
+}
+
+int Lithophane::height() const
+{
+  return imageHeight;
+}
+
+qint64 Lithophane::estimateMemory(const int &width, const int &height)
+{
+  // Per pixel: the decoded 32 bit image, the prepared heights, the grid
+  // topology plus its copy in the rendered mesh and the vertex table
+  qint64 pixels = (qint64)width * height;
+  return (pixels * (4 + 1 + 24 + 24 + 12)) + (16 * 1024 * 1024);
+}
+
+qint64 Lithophane::estimateBandMemory(const int &width, const int &height, const int &bandRows)
+{
+  // The decoded 32 bit image and the prepared heights, plus the vertices and
+  // facet indices of one band. A band also holds the rows it shares with its
+  // neighbours, and the floor ring along the edges is held throughout.
+  qint64 pixels = (qint64)width * height;
+  qint64 bandPixels = (qint64)(bandRows + 2) * width;
+  qint64 edgePixels = ((qint64)width + height) * 2;
+  return (pixels * (4 + 1)) + ((bandPixels + edgePixels) * (24 + 12)) + (16 * 1024 * 1024);
+}
+
+qint64 Lithophane::estimateFacets(const int &width, const int &height,
+                                  const RenderSettings &renderSettings)
+{
+  // The grid and backside follow from the image size alone. The frame
+  // pieces depend on the settings in too many ways to count, but they are
+  // few, so they are simply built.
+  qint64 facets = 0;
+  if(width > 1 && height > 1) {
+    qint64 cells = width - 1;
+    facets = (12 + (cells * 18) + ((qint64)(height - 2) * (12 + (cells * 6)))) / 3;
+    facets += (height == 2?cells * 2:(cells * 2) + 2 + ((qint64)(height - 3) * 2));
+  }
+  Lithophane lithophane;
+  lithophane.imageWidth = width;
+  lithophane.imageHeight = height;
+  lithophane.renderSettings = renderSettings;
+  lithophane.border = renderSettings.frameBorder;
+  lithophane.widthFactor = (renderSettings.width - (lithophane.border * 2)) / qMax(width, 1);
+  Mesh frame;
+  TrackedBuffer frameBuffer(MemoryStats::Geometry);
+  lithophane.appendGeometry(frame, frameBuffer);
+
+  return facets + frame.facetCount();
+}
+
+quint32 Lithophane::topIndex(const int &x, const int &y) const
+{
+  return (y * imageWidth) + x;
+}
+
+quint32 Lithophane::floorIndex(const int &x, const int &y) const
+{
+  // The floor vertices only exist along the image edges. They are stored
+  // after the heightmap vertices as bottom row, top row, left column and
+  // right column. The columns exclude the corners.
+  quint32 floorBase = imageWidth * imageHeight;
+  if(y == 0) {
+    return floorBase + x;
+  } else if(y == imageHeight - 1) {
+    return floorBase + imageWidth + x;
+  } else if(x == 0) {
+    return floorBase + (imageWidth * 2) + (y - 1);
+  }
+  return floorBase + (imageWidth * 2) + (imageHeight - 2) + (y - 1);
+}
+
+int Lithophane::floorCount() const
+{
+  return (imageWidth * 2) + ((imageHeight > 2?imageHeight - 2:0) * 2);
+}
+
+void Lithophane::buildTopology()
+{
+  // The facet order matches the original row-by-row STL render exactly,
+  // apart from the backside at the end. Since every row of cells has a known
+  // offset in that order, the grid is built in parallel in blocks of cells
+  // small enough to stay in cache, each writing its facets straight to their
+  // place. Blocks are handed out on demand, as the blocks holding the top
+  // and bottom walls take longer.
+  TRACE_SCOPE("topology");
+  gridIndices.clear();
+  if(imageWidth < 2 || imageHeight < 2) {
+    return;
+  }
+  gridIndices.reserve(((imageHeight - 1) * (12 + ((imageWidth - 1) * 6))) + ((imageWidth - 1) * 12) + (imageWidth * 6) + (imageHeight * 6));
+  gridIndices.resize(rowOffset(imageHeight - 1));
+  quint32 *indices = gridIndices.data();
+  int blockColumns = ((imageWidth - 1) + blockWidth - 1) / blockWidth;
+  int blockRows = ((imageHeight - 1) + blockHeight - 1) / blockHeight;
+#pragma omp parallel for schedule(dynamic)
+  for(int block = 0; block < blockColumns * blockRows; ++block) {
+    TRACE_SCOPE("topology block");
+    int x = (block % blockColumns) * blockWidth;
+    int y = (block / blockColumns) * blockHeight;
+    buildBlock(indices, x, y, qMin(x + blockWidth, imageWidth - 1), qMin(y + blockHeight, imageHeight - 1));
+  }
+
+  addBackside(gridIndices);
+}
+
+void Lithophane::addBackside(QVector<quint32> &indices) const
+{
+  // The backside is fanned out against the floor vertices along the edges
+  // instead of being two large triangles, since the side walls would
+  // otherwise meet it in T-junctions that leave the mesh open.
+  if(imageHeight == 2) {
+    for(int x = 0; x < imageWidth - 1; ++x) {
+      indices.append(floorIndex(x, 0));
+      indices.append(floorIndex(x, 1));
+      indices.append(floorIndex(x + 1, 1));
+
+      indices.append(floorIndex(x, 0));
+      indices.append(floorIndex(x + 1, 1));
+      indices.append(floorIndex(x + 1, 0));
+    }
+    return;
+  }
+  for(int x = 0; x < imageWidth - 1; ++x) {
+    indices.append(floorIndex(x + 1, 0));
+    indices.append(floorIndex(x, 0));
+    indices.append(floorIndex(0, 1));
+
+    indices.append(floorIndex(x, imageHeight - 1));
+    indices.append(floorIndex(x + 1, imageHeight - 1));
+    indices.append(floorIndex(0, imageHeight - 2));
+  }
+  indices.append(floorIndex(imageWidth - 1, 1));
+  indices.append(floorIndex(imageWidth - 1, 0));
+  indices.append(floorIndex(0, 1));
+
+  indices.append(floorIndex(0, imageHeight - 2));
+  indices.append(floorIndex(imageWidth - 1, imageHeight - 1));
+  indices.append(floorIndex(imageWidth - 1, imageHeight - 2));
+  for(int y = 1; y < imageHeight - 2; ++y) {
+    indices.append(floorIndex(0, y));
+    indices.append(floorIndex(0, y + 1));
+    indices.append(floorIndex(imageWidth - 1, y + 1));
+
+    indices.append(floorIndex(0, y));
+    indices.append(floorIndex(imageWidth - 1, y + 1));
+    indices.append(floorIndex(imageWidth - 1, y));
+  }
+}
+
+int Lithophane::rowOffset(const int &y) const
+{
+  // The first row of cells also closes the top and bottom of the grid
+  int cells = imageWidth - 1;
+  return (y == 0?0:(12 + (cells * 18)) + ((y - 1) * (12 + (cells * 6))));
+}
+
+void Lithophane::buildBlock(quint32 *indices, const int &x0, const int &y0,
+                            const int &x1, const int &y1, const int &offset) const
+{
+  // Writes the facets of the cells from x0, y0 up to but not including
+  // x1, y1. Blocks along the edges also write the side walls. The offset is
+  // where the given indices start in the full grid, for writing a band of it.
+  auto addTriangle = [](quint32 *&out, const quint32 &a, const quint32 &b, const quint32 &c) {
+    out[0] = a;
+    out[1] = b;
+    out[2] = c;
+    out += 3;
+  };
+  for(int y = y0; y < y1; ++y) {
+    quint32 *row = indices + (rowOffset(y) - offset);
+    int cellSize = (y == 0?18:6);
+    if(x0 == 0) {
+      // Close left side
+      quint32 *out = row;
+      addTriangle(out, floorIndex(0, y), topIndex(0, y), topIndex(0, y + 1));
+      addTriangle(out, topIndex(0, y + 1), floorIndex(0, y + 1), floorIndex(0, y));
+    }
+    quint32 *out = row + 6 + (x0 * cellSize);
+    for(int x = x0; x < x1; ++x) {
+      if(y == 0) {
+        // Close top
+        addTriangle(out, topIndex(x + 1, 0), topIndex(x, 0), floorIndex(x, 0));
+        addTriangle(out, floorIndex(x, 0), floorIndex(x + 1, 0), topIndex(x + 1, 0));
+
+        // Close bottom
+        addTriangle(out, floorIndex(x, imageHeight - 1), topIndex(x, imageHeight - 1), topIndex(x + 1, imageHeight - 1));
+        addTriangle(out, topIndex(x + 1, imageHeight - 1), floorIndex(x + 1, imageHeight - 1), floorIndex(x, imageHeight - 1));
+      }
+      // The lithophane heightmap
+      addTriangle(out, topIndex(x, y), topIndex(x + 1, y + 1), topIndex(x, y + 1));
+      addTriangle(out, topIndex(x, y), topIndex(x + 1, y), topIndex(x + 1, y + 1));
+    }
+    if(x1 == imageWidth - 1) {
+      // Close right side
+      addTriangle(out, topIndex(imageWidth - 1, y + 1), topIndex(imageWidth - 1, y), floorIndex(imageWidth - 1, y));
+      addTriangle(out, floorIndex(imageWidth - 1, y), floorIndex(imageWidth - 1, y + 1), topIndex(imageWidth - 1, y + 1));
+    }
+  }
+}
+
+void Lithophane::quantizeRow(const quint8 *row, float *depths, const int &layers,
+                             float *errors, float *nextErrors, const bool &reverse) const
+{
+  // Snaps a row of heights to whole layers. Given error buffers, the rounding
+  // error is diffused Floyd-Steinberg style: 7/16 to the next pixel in the
+  // row and 3/16, 5/16 and 1/16 to the three pixels in the row above. Every
+  // other row runs backwards so the error doesn't drift to one side. The
+  // buffers are padded by a pixel at each end, so the edges need no checks.
+  float layerHeight = renderSettings.layerHeight;
+  float levelFactor = depthFactor / layerHeight;
+  int step = (reverse?-1:1);
+  if(nextErrors != nullptr) {
+    memset(nextErrors, 0, (imageWidth + 2) * sizeof(float));
+  }
+  for(int a = 0; a < imageWidth; ++a) {
+    int x = (reverse?imageWidth - 1 - a:a);
+    float level = row[x] * levelFactor;
+    if(errors != nullptr) {
+      level += errors[x + 1];
+    }
+    int snapped = qBound(0, qRound(level), layers);
+    depths[x] = snapped * layerHeight;
+    if(errors != nullptr) {
+      float error = level - snapped;
+      errors[x + 1 + step] += error * (7.0 / 16.0);
+      nextErrors[x + 1 - step] += error * (3.0 / 16.0);
+      nextErrors[x + 1] += error * (5.0 / 16.0);
+      nextErrors[x + 1 + step] += error * (1.0 / 16.0);
+    }
+  }
+}
+
+int Lithophane::setupRender(const RenderSettings &renderSettings)
+{
+  // Sets up the scales for the settings and returns the number of layers
+  // the heights are snapped to, 0 for none
+  this->renderSettings = renderSettings;
+  border = renderSettings.frameBorder;
+  depthFactor = (renderSettings.totalThickness - renderSettings.minThickness) / 255.0;
+  widthFactor = (renderSettings.width - (border * 2)) / imageWidth;
+
+  // Snapping to layers is done a row at a time while the vertices are
+  // placed, so dithering only needs the error of the current and next row
+  int layers = 0;
+  if(renderSettings.layerHeight > 0.0) {
+    layers = (int)(((renderSettings.totalThickness - renderSettings.minThickness) / renderSettings.layerHeight) + 0.001);
+    if(layers < 1) {
+      printf("Layer height exceeds the lithophane depth, rendering without layers.\n");
+    }
+  }
+
+  return layers;
+}
+
+void Lithophane::placeRow(const int &y, const int &layers, float *depths, QVector3D *vertices,
+                          float *errors, float *nextErrors)
+{
+  // Places the heightmap vertices of a row. Given error buffers, the layers
+  // are dithered and the buffers swapped by the caller after each row.
+  const quint8 *row = heights.constData() + (y * imageWidth);
+  if(layers > 0) {
+    quantizeRow(row, depths, layers, errors, nextErrors, errors != nullptr && y % 2 == 1);
+    for(int x = 0; x < imageWidth; ++x) {
+      vertices[x] = getVertex(x, y, depths[x], true);
+    }
+  } else {
+    for(int x = 0; x < imageWidth; ++x) {
+      vertices[x] = getVertex(x, y, row[x] * depthFactor, true);
+    }
+  }
+}
+
+Mesh Lithophane::render(const RenderSettings &renderSettings)
+{
+  int layers = setupRender(renderSettings);
+  float minThickness = renderSettings.minThickness * -1;
+
+  Mesh mesh;
+  if(isNull() || isCancelled()) {
+    return mesh;
+  }
+  if(gridIndices.isEmpty()) {
+    buildTopology();
+    heightmapBuffer.resize(imageMemory());
+  }
+
+  // A solid is stitched together per render, since the ring of pixels the
+  // frame slope lands on depends on the settings
+  int inset = 0;
+  if(renderSettings.solid) {
+    inset = solidInset();
+    if(inset < 1) {
+      printf("Image too small for a solid mesh, rendering the regular mesh instead.\n");
+    }
+  }
+
+  // Only the vertex positions depend on the render settings. The facets
+  // reuse the grid topology built when the image was set.
+  mesh.vertices.resize((imageWidth * imageHeight) + (inset > 0?0:floorCount()));
+  TrackedBuffer meshBuffer(MemoryStats::Mesh, mesh.memory());
+  QVector3D *vertices = mesh.vertices.data();
+  emit progress(0, imageHeight);
+  if(layers > 0 && renderSettings.ditherLayers) {
+    // The rounding error is carried from row to row, so dithered rows are
+    // placed in order
+    TRACE_SCOPE("dithered rows");
+    QVector<float> depths(imageWidth);
+    QVector<float> errors(imageWidth + 2, 0.0);
+    QVector<float> nextErrors(imageWidth + 2, 0.0);
+    for(int y = 0; y < imageHeight; ++y) {
+      placeRow(y, layers, depths.data(), vertices + topIndex(0, y), errors.data(), nextErrors.data());
+      errors.swap(nextErrors);
+      if(cancelled.loadAcquire()) {
+        return Mesh();
+      }
+      emit progress(y + 1, imageHeight);
+    }
+  } else {
+    // Otherwise rows don't depend on each other and bands of rows are placed
+    // in parallel. Only the calling thread reports progress.
+    int bands = (imageHeight + blockHeight - 1) / blockHeight;
+    QAtomicInt placed = 0;
+#pragma omp parallel
+    {
+      QVector<float> depths(layers > 0?imageWidth:0);
+#pragma omp for schedule(dynamic)
+      for(int band = 0; band < bands; ++band) {
+        if(cancelled.loadAcquire()) {
+          continue;
+        }
+        TRACE_SCOPE("vertex band");
+        int first = band * blockHeight;
+        int last = qMin(first + blockHeight, imageHeight);
+        for(int y = first; y < last; ++y) {
+          placeRow(y, layers, depths.data(), vertices + topIndex(0, y));
+        }
+        int rows = placed.fetchAndAddRelaxed(last - first) + (last - first);
+        if(omp_get_thread_num() == 0) {
+          emit progress(rows, imageHeight);
+        }
+      }
+    }
+    if(cancelled.loadAcquire()) {
+      return Mesh();
+    }
+    emit progress(imageHeight, imageHeight);
+  }
+  if(inset > 0) {
+    // The frame slope replaces the pixels of the inset ring, so the grid
+    // vertices are no longer the heightmap and gridWidth stays unset
+    float totalHeight = (border * 2) + (imageHeight * widthFactor);
+    if(renderSettings.enableStabilizers && totalHeight > renderSettings.stabilizerThreshold) {
+      printf("Stabilizers are left out of solid meshes.\n");
+    }
+    if(renderSettings.alignmentLips && renderSettings.isTiled()) {
+      printf("Alignment lips are left out of solid meshes.\n");
+    }
+    TRACE_SCOPE("solid");
+    addSolid(mesh, inset, renderSettings.width, totalHeight);
+    meshBuffer.resize(mesh.memory());
+    return mesh;
+  }
+  mesh.gridWidth = imageWidth;
+  mesh.gridHeight = imageHeight;
+  for(int x = 0; x < imageWidth; ++x) {
+    vertices[floorIndex(x, 0)] = getVertex(x, 0, minThickness, true);
+    vertices[floorIndex(x, imageHeight - 1)] = getVertex(x, imageHeight - 1, minThickness, true);
+  }
+  for(int y = 1; y < imageHeight - 1; ++y) {
+    vertices[floorIndex(0, y)] = getVertex(0, y, minThickness, true);
+    vertices[floorIndex(imageWidth - 1, y)] = getVertex(imageWidth - 1, y, minThickness, true);
+  }
+  mesh.indices = gridIndices;
+  appendGeometry(mesh, meshBuffer);
+
+  return mesh;
+}
+
+bool Lithophane::renderBands(const RenderSettings &renderSettings, const int &bandRows,
+                             const std::function<bool(const Mesh &)> &sink, const int &firstRow,
+                             const int &stopRow)
+{
+  // Each band holds the vertex rows its cells span and the floor ring. The
+  // first band also closes the top and bottom walls, so it holds the last
+  // row as well. The grid indices are built per band at their offset in the
+  // full grid and then moved to the vertices of the band.
+  int layers = setupRender(renderSettings);
+  float minThickness = renderSettings.minThickness * -1;
+  if(isNull() || isCancelled()) {
+    return false;
+  }
+  if(renderSettings.solid) {
+    printf("Solid meshes can't be rendered in bands, rendering the regular mesh instead.\n");
+  }
+
+  QVector<QVector3D> floor(floorCount());
+  quint32 gridVertices = imageWidth * imageHeight;
+  for(int x = 0; x < imageWidth; ++x) {
+    floor[floorIndex(x, 0) - gridVertices] = getVertex(x, 0, minThickness, true);
+    floor[floorIndex(x, imageHeight - 1) - gridVertices] = getVertex(x, imageHeight - 1, minThickness, true);
+  }
+  for(int y = 1; y < imageHeight - 1; ++y) {
+    floor[floorIndex(0, y) - gridVertices] = getVertex(0, y, minThickness, true);
+    floor[floorIndex(imageWidth - 1, y) - gridVertices] = getVertex(imageWidth - 1, y, minThickness, true);
+  }
+
+  // Dithered rows depend on all rows below them, so the last row is
+  // dithered up front and the error buffers are carried from band to band
+  bool dithered = (layers > 0 && renderSettings.ditherLayers);
+  QVector<float> depths(imageWidth);
+  QVector<float> errors(imageWidth + 2, 0.0);
+  QVector<float> nextErrors(imageWidth + 2, 0.0);
+  QVector<QVector3D> lastRow(imageWidth);
+  QVector<QVector3D> sharedRow(imageWidth);
+  int cells = (imageWidth < 2?0:imageHeight - 1);
+  if(cells > 0) {
+    TRACE_SCOPE("last row");
+    if(dithered) {
+      for(int y = 0; y < imageHeight; ++y) {
+        placeRow(y, layers, depths.data(), lastRow.data(), errors.data(), nextErrors.data());
+        errors.swap(nextErrors);
+      }
+      errors.fill(0.0);
+    } else {
+      placeRow(imageHeight - 1, layers, depths.data(), lastRow.data());
+    }
+  }
+
+  Mesh band;
+  TrackedBuffer bandBuffer(MemoryStats::Mesh);
+  int rows = qMax(bandRows, 1);
+  int blockColumns = ((imageWidth - 1) + blockWidth - 1) / blockWidth;
+  int endRow = (stopRow < 0?cells:qMin(stopRow, cells));
+  emit progress(0, imageHeight);
+  for(int first = 0; first < endRow; first += rows) {
+    TRACE_SCOPE("band");
+    int last = qMin(first + rows, cells);
+    // Bands ending at or before the first row were rendered earlier. Only the
+    // row shared with the next band is placed, or all of their rows when
+    // dithering, to carry the error buffers over.
+    if(last <= firstRow) {
+      for(int y = (dithered?(first > 0?first + 1:0):last); y <= last; ++y) {
+        if(dithered) {
+          placeRow(y, layers, depths.data(), sharedRow.data(), errors.data(), nextErrors.data());
+          errors.swap(nextErrors);
+        } else {
+          placeRow(y, layers, depths.data(), sharedRow.data());
+        }
+      }
+      emit progress(last, imageHeight);
+      continue;
+    }
+    quint32 floorBase = (last - first + 1) * imageWidth;
+    quint32 lastRowBase = floorBase + floor.length();
+    bool holdsLastRow = (first == 0 && last < cells);
+    band.vertices.resize(lastRowBase + (holdsLastRow?imageWidth:0));
+    QVector3D *vertices = band.vertices.data();
+
+    // The first row is shared with the band before
+    int placeFrom = first;
+    if(first > 0) {
+      std::copy(sharedRow.constBegin(), sharedRow.constEnd(), vertices);
+      placeFrom++;
+    }
+    if(dithered) {
+      for(int y = placeFrom; y <= last; ++y) {
+        placeRow(y, layers, depths.data(), vertices + ((y - first) * imageWidth), errors.data(), nextErrors.data());
+        errors.swap(nextErrors);
+      }
+    } else {
+#pragma omp parallel
+      {
+        QVector<float> rowDepths(layers > 0?imageWidth:0);
+#pragma omp for schedule(static)
+        for(int y = placeFrom; y <= last; ++y) {
+          placeRow(y, layers, rowDepths.data(), vertices + ((y - first) * imageWidth));
+        }
+      }
+    }
+    std::copy(vertices + ((last - first) * imageWidth), vertices + floorBase, sharedRow.begin());
+    std::copy(floor.constBegin(), floor.constEnd(), vertices + floorBase);
+    if(holdsLastRow) {
+      std::copy(lastRow.constBegin(), lastRow.constEnd(), vertices + lastRowBase);
+    }
+
+    int offset = rowOffset(first);
+    band.indices.resize(rowOffset(last) - offset);
+    quint32 *indices = band.indices.data();
+#pragma omp parallel for schedule(dynamic)
+    for(int block = 0; block < blockColumns; ++block) {
+      int x = block * blockWidth;
+      buildBlock(indices, x, first, qMin(x + blockWidth, imageWidth - 1), last, offset);
+    }
+    quint32 bandStart = first * imageWidth;
+    quint32 bandEnd = (last + 1) * imageWidth;
+    quint32 lastRowStart = (imageHeight - 1) * imageWidth;
+    int count = band.indices.length();
+#pragma omp parallel for schedule(static)
+    for(int a = 0; a < count; ++a) {
+      quint32 index = indices[a];
+      if(index >= gridVertices) {
+        indices[a] = floorBase + (index - gridVertices);
+      } else if(index >= bandStart && index < bandEnd) {
+        indices[a] = index - bandStart;
+      } else {
+        indices[a] = lastRowBase + (index - lastRowStart);
+      }
+    }
+    bandBuffer.resize(band.memory());
+
+    if(!sink(band) || cancelled.loadAcquire()) {
+      return false;
+    }
+    emit progress(last, imageHeight);
+  }
+
+  // The backside and frame come last, as in render()
+  if(endRow < cells) {
+    return true;
+  }
+  TRACE_SCOPE("frame band");
+  band.clear();
+  band.vertices = floor;
+  if(cells > 0) {
+    addBackside(band.indices);
+    for(auto &index: band.indices) {
+      index -= gridVertices;
+    }
+  }
+  bandBuffer.resize(band.memory());
+  appendGeometry(band, bandBuffer);
+  if(!sink(band) || cancelled.loadAcquire()) {
+    return false;
+  }
+  emit progress(imageHeight, imageHeight);
+
+  return true;
+}
+
+void Lithophane::appendGeometry(Mesh &mesh, TrackedBuffer &meshBuffer)
+{
+  // The triangle lists are accounted for while they are appended, which is
+  // when they are held along with the growing mesh. QList keeps every
+  // QVector3D in a node of its own.
+  TrackedBuffer geometryBuffer(MemoryStats::Geometry);
+  auto append = [&mesh, &meshBuffer, &geometryBuffer](const QList<QVector3D> &triangles) {
+    geometryBuffer.resize((qint64)triangles.length() * (sizeof(QVector3D) + sizeof(void *)));
+    mesh.appendTriangles(triangles);
+    meshBuffer.resize(mesh.memory());
+  };
+
+  // Stabilizers
+  TRACE_SCOPE("frame");
+  double totalHeight = ((border * 2) + (imageHeight * widthFactor));
+  double stabilizerHeightFactor = renderSettings.stabilizerHeightFactor;
+  float lipStart = 0.0;
+  if(renderSettings.enableStabilizers &&
+     totalHeight > renderSettings.stabilizerThreshold) {
+    append(addStabilizer(0, ((border * 2) + (imageHeight * widthFactor)) * stabilizerHeightFactor));
+    append(addStabilizer(renderSettings.width - (border < 4?border:4), totalHeight * stabilizerHeightFactor));
+    lipStart = totalHeight * stabilizerHeightFactor;
+  }
+
+  // Frame
+  append(addFrame(renderSettings.width, (border * 2) + (imageHeight * widthFactor)));
+
+  // Alignment lips
+  if(renderSettings.alignmentLips && renderSettings.isTiled()) {
+    append(addLips(renderSettings.width, totalHeight, lipStart));
+  }
+
+  // Hanger(s), only on the top row of tiles
+  if(renderSettings.enableHangers && renderSettings.tileRow == 0) {
+    append(addHangers(renderSettings.width, (border * 2) + (imageHeight * widthFactor)));
+  }
+}
+
+QList<QVector3D> Lithophane::addFrame(const float &width, const float &height)
+{
+  float minThickness = renderSettings.minThickness;
+  float depth = renderSettings.totalThickness - minThickness;
+  float frameSlope = depth * renderSettings.frameSlopeFactor;
+
+  QList<QVector3D> frame;
+  frame.append(getVertex(width, height, - minThickness));
+  frame.append(getVertex(0.000000, height, - minThickness));
+  frame.append(getVertex(0.000000, height, depth));
+
+  frame.append(getVertex(width, height, - minThickness));
+  frame.append(getVertex(0.000000, height, depth));
+  frame.append(getVertex(width, height, depth));
+
+  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
+  frame.append(getVertex(width - border - frameSlope, height - border - frameSlope, 0.000000));
+  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
+
+  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
+  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
+  frame.append(getVertex(border + frameSlope, border + frameSlope, 0.000000));
+
+  frame.append(getVertex(0.000000, 0.000000, depth));
+  frame.append(getVertex(0.000000, height, depth));
+  frame.append(getVertex(0.000000, height, - minThickness));
+
+  frame.append(getVertex(0.000000, 0.000000, depth));
+  frame.append(getVertex(0.000000, height, - minThickness));
+  frame.append(getVertex(0.000000, 0.000000, - minThickness));
+
+  frame.append(getVertex(0.000000, 0.000000, - minThickness));
+  frame.append(getVertex(width, 0.000000, - minThickness));
+  frame.append(getVertex(width, 0.000000, depth));
+
+  frame.append(getVertex(0.000000, 0.000000, - minThickness));
+  frame.append(getVertex(width, 0.000000, depth));
+  frame.append(getVertex(0.000000, 0.000000, depth));
+
+  frame.append(getVertex(width, 0.000000, - minThickness));
+  frame.append(getVertex(width, height, - minThickness));
+  frame.append(getVertex(width, height, depth));
+
+  frame.append(getVertex(width, 0.000000, - minThickness));
+  frame.append(getVertex(width, height, depth));
+  frame.append(getVertex(width, 0.000000, depth));
+
+  frame.append(getVertex(0.000000, 0.000000, - minThickness));
+  frame.append(getVertex(0.000000, height, - minThickness));
+  frame.append(getVertex(width, height, - minThickness));
+
+  frame.append(getVertex(0.000000, 0.000000, - minThickness));
+  frame.append(getVertex(width, height, - minThickness));
+  frame.append(getVertex(width, 0.000000, - minThickness));
+
+  frame.append(getVertex(border, border, depth));
+  frame.append(getVertex(border, height - border, depth));
+  frame.append(getVertex(0.000000, height, depth));
+
+  frame.append(getVertex(border, border, depth));
+  frame.append(getVertex(0.000000, height, depth));
+  frame.append(getVertex(0.000000, 0.000000, depth));
+
+  frame.append(getVertex(width - border, height - border, depth));
+  frame.append(getVertex(width - border, border, depth));
+  frame.append(getVertex(width, 0.000000, depth));
+
+  frame.append(getVertex(width - border, height - border, depth));
+  frame.append(getVertex(width, 0.000000, depth));
+  frame.append(getVertex(width, height, depth));
+
+  frame.append(getVertex(border, height - border, depth));
+  frame.append(getVertex(width - border, height - border, depth));
+  frame.append(getVertex(width, height, depth));
+
+  frame.append(getVertex(border, height - border, depth));
+  frame.append(getVertex(width, height, depth));
+  frame.append(getVertex(0.000000, height, depth));
+
+  frame.append(getVertex(width - border, border, depth));
+  frame.append(getVertex(border, border, depth));
+  frame.append(getVertex(0.000000, 0.000000, depth));
+
+  frame.append(getVertex(width - border, border, depth));
+  frame.append(getVertex(0.000000, 0.000000, depth));
+  frame.append(getVertex(width, 0.000000, depth));
+
+  frame.append(getVertex(border + frameSlope, border + frameSlope, 0.000000));
+  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
+  frame.append(getVertex(border, height - border, depth));
+
+  frame.append(getVertex(border + frameSlope, border + frameSlope, 0.000000));
+  frame.append(getVertex(border, height - border, depth));
+  frame.append(getVertex(border, border, depth));
+
+  frame.append(getVertex(width - border - frameSlope, height - border - frameSlope, 0.000000));
+  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
+  frame.append(getVertex(width - border, border, depth));
+
+  frame.append(getVertex(width - border - frameSlope, height - border - frameSlope, 0.000000));
+  frame.append(getVertex(width - border, border, depth));
+  frame.append(getVertex(width - border, height - border, depth));
+
+  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
+  frame.append(getVertex(width - border - frameSlope, height - border - frameSlope, 0.000000));
+  frame.append(getVertex(width - border, height - border, depth));
+
+  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
+  frame.append(getVertex(width - border, height - border, depth));
+  frame.append(getVertex(border, height - border, depth));
+
+  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
+  frame.append(getVertex(border + frameSlope, border + frameSlope, 0.000000));
+  frame.append(getVertex(border, border, depth));
+
+  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
+  frame.append(getVertex(border, border, depth));
+  frame.append(getVertex(width - border, border, depth));
+
+  return frame;
+}
+
+QList<QVector3D> Lithophane::addHangers(const float &width, const float &height)
+{
+  int noOfHangers = renderSettings.hangers;
+  float xDelta = (width / noOfHangers) / 2.0;
+  float x = xDelta - 4.5; // 4.5 is half the width of a hanger
+
+  QList<QVector3D> hangers;
+  for(int a = 0; a < noOfHangers; a++) {
+    hangers.append(getVertex(x + 3, height, 0.000000));
+    hangers.append(getVertex(x, height, 0.000000));
+    hangers.append(getVertex(x + 3, height + 3, 0.000000));
+
+    hangers.append(getVertex(x + 3, height + 3, 0.000000));
+    hangers.append(getVertex(x + 6, height + 3, 0.000000));
+    hangers.append(getVertex(x + 9, height, 0.000000));
+
+    hangers.append(getVertex(x + 9, height, 0.000000));
+    hangers.append(getVertex(x + 6, height, 0.000000));
+    hangers.append(getVertex(x + 5, height + 1, 0.000000));
+
+    hangers.append(getVertex(x + 4, height + 1, 0.000000));
+    hangers.append(getVertex(x + 3, height, 0.000000));
+    hangers.append(getVertex(x + 3, height + 3, 0.000000));
+
+    hangers.append(getVertex(x + 3, height + 3, 0.000000));
+    hangers.append(getVertex(x + 9, height, 0.000000));
+    hangers.append(getVertex(x + 5, height + 1, 0.000000));
+
+    hangers.append(getVertex(x + 3, height + 3, 0.000000));
+    hangers.append(getVertex(x + 5, height + 1, 0.000000));
+    hangers.append(getVertex(x + 4, height + 1, 0.000000));
+
+    hangers.append(getVertex(x + 3, height + 3, 2));
+    hangers.append(getVertex(x, height, 2));
+    hangers.append(getVertex(x + 3, height, 2));
+
+    hangers.append(getVertex(x + 3, height + 3, 2));
+    hangers.append(getVertex(x + 3, height, 2));
+    hangers.append(getVertex(x + 4, height + 1, 2));
+
+    hangers.append(getVertex(x + 9, height, 2));
+    hangers.append(getVertex(x + 6, height + 3, 2));
+    hangers.append(getVertex(x + 3, height + 3, 2));
+
+    hangers.append(getVertex(x + 5, height + 1, 2));
+    hangers.append(getVertex(x + 6, height, 2));
+    hangers.append(getVertex(x + 9, height, 2));
+
+    hangers.append(getVertex(x + 3, height + 3, 2));
+    hangers.append(getVertex(x + 4, height + 1, 2));
+    hangers.append(getVertex(x + 5, height + 1, 2));
+
+    hangers.append(getVertex(x + 5, height + 1, 2));
+    hangers.append(getVertex(x + 9, height, 2));
+    hangers.append(getVertex(x + 3, height + 3, 2));
+
+    hangers.append(getVertex(x + 5, height + 1, 0.000000));
+    hangers.append(getVertex(x + 6, height, 0.000000));
+    hangers.append(getVertex(x + 6, height, 2));
+
+    hangers.append(getVertex(x + 5, height + 1, 0.000000));
+    hangers.append(getVertex(x + 6, height, 2));
+    hangers.append(getVertex(x + 5, height + 1, 2));
+
+    hangers.append(getVertex(x + 9, height, 0.000000));
+    hangers.append(getVertex(x + 6, height + 3, 0.000000));
+    hangers.append(getVertex(x + 6, height + 3, 2));
+
+    hangers.append(getVertex(x + 9, height, 0.000000));
+    hangers.append(getVertex(x + 6, height + 3, 2));
+    hangers.append(getVertex(x + 9, height, 2));
+
+    hangers.append(getVertex(x + 3, height + 3, 0.000000));
+    hangers.append(getVertex(x, height, 0.000000));
+    hangers.append(getVertex(x, height, 2));
+
+    hangers.append(getVertex(x + 3, height + 3, 0.000000));
+    hangers.append(getVertex(x, height, 2));
+    hangers.append(getVertex(x + 3, height + 3, 2));
+
+    hangers.append(getVertex(x, height, 0.000000));
+    hangers.append(getVertex(x + 3, height, 0.000000));
+    hangers.append(getVertex(x + 3, height, 2));
+
+    hangers.append(getVertex(x, height, 0.000000));
+    hangers.append(getVertex(x + 3, height, 2));
+    hangers.append(getVertex(x, height, 2));
+
+    hangers.append(getVertex(x + 4, height + 1, 0.000000));
+    hangers.append(getVertex(x + 5, height + 1, 0.000000));
+    hangers.append(getVertex(x + 5, height + 1, 2));
+
+    hangers.append(getVertex(x + 4, height + 1, 0.000000));
+    hangers.append(getVertex(x + 5, height + 1, 2));
+    hangers.append(getVertex(x + 4, height + 1, 2));
+
+    hangers.append(getVertex(x + 6, height, 0.000000));
+    hangers.append(getVertex(x + 9, height, 0.000000));
+    hangers.append(getVertex(x + 9, height, 2));
+
+    hangers.append(getVertex(x + 6, height, 0.000000));
+    hangers.append(getVertex(x + 9, height, 2));
+    hangers.append(getVertex(x + 6, height, 2));
+
+    hangers.append(getVertex(x + 6, height + 3, 0.000000));
+    hangers.append(getVertex(x + 3, height + 3, 0.000000));
+    hangers.append(getVertex(x + 3, height + 3, 2));
+
+    hangers.append(getVertex(x + 6, height + 3, 0.000000));
+    hangers.append(getVertex(x + 3, height + 3, 2));
+    hangers.append(getVertex(x + 6, height + 3, 2));
+
+    hangers.append(getVertex(x + 3, height, 0.000000));
+    hangers.append(getVertex(x + 4, height + 1, 0.000000));
+    hangers.append(getVertex(x + 4, height + 1, 2));
+
+    hangers.append(getVertex(x + 3, height, 0.000000));
+    hangers.append(getVertex(x + 4, height + 1, 2));
+    hangers.append(getVertex(x + 3, height, 2));
+
+    // Move over to the next hanger placement
+    x += xDelta * 2;
+  }
+
+  return hangers;
+}
+
+QList<QVector3D> Lithophane::addStabilizer(const float &x, const float &height)
+{
+  float depth = height * 0.5;
+  float z;
+
+  QList<QVector3D> stabilizer;
+
+  // The breakaway tabs are 1 mm in from either side, so stabilizers
+  // narrower than 3 mm have no room for them
+  float stabilizerWidth = (border < 4?border:4);
+  if(renderSettings.permanentStabilizers || stabilizerWidth < 3) {
+    // Permanent stabilizers have no breakaway tabs, which would otherwise
+    // collapse into zero thickness facets. They are plain wedges resting on
+    // the front and back of the frame.
+    auto addQuad = [&stabilizer](const QVector3D &a, const QVector3D &b, const QVector3D &c, const QVector3D &d) {
+      stabilizer << a << b << c << a << c << d;
+    };
+    for(const float &side: {1.0f, -1.0f}) {
+      z = (side > 0?renderSettings.totalThickness - renderSettings.minThickness:renderSettings.minThickness * -1);
+      QVector3D a[4] = {getVertex(x, 0.000000, z), getVertex(x, 0.000000, z + (side * depth)),
+                        getVertex(x, height, z + (side * 3)), getVertex(x, height, z)};
+      QVector3D b[4];
+      for(int c = 0; c < 4; ++c) {
+        b[c] = getVertex(x + stabilizerWidth, a[c].y(), a[c].z());
+      }
+      // The back is mirrored, so its winding is reversed
+      QVector3D quads[6][4] = {{a[0], a[1], a[2], a[3]}, {b[0], b[3], b[2], b[1]},
+                               {a[0], a[3], b[3], b[0]}, {a[0], b[0], b[1], a[1]},
+                               {a[3], a[2], b[2], b[3]}, {a[1], b[1], b[2], a[2]}};
+      for(const auto &quad: quads) {
+        if(side > 0) {
+          addQuad(quad[0], quad[1], quad[2], quad[3]);
+        } else {
+          addQuad(quad[0], quad[3], quad[2], quad[1]);
+        }
+      }
+    }
+    return stabilizer;
+  }
+
+  // Front
+  z = renderSettings.totalThickness - renderSettings.minThickness;
+  stabilizer.append(getVertex(x, 0.000000, z + 1));
+  stabilizer.append(getVertex(x, 0.000000, z + depth));
+  stabilizer.append(getVertex(x, height, z + 3));
+                    
+  stabilizer.append(getVertex(x, height, z + 3));
+  stabilizer.append(getVertex(x, height, z + 1));
+  stabilizer.append(getVertex(x, height - 1, z + 1));
+
+  stabilizer.append(getVertex(x, height, z + 3));
+  stabilizer.append(getVertex(x, height - 1, z + 1));
+  stabilizer.append(getVertex(x, 0.000000, z + 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + depth));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
+
+  stabilizer.append(getVertex(x + 1, height, z + 1));
+  stabilizer.append(getVertex(x, height, z + 1));
+  stabilizer.append(getVertex(x, height, z + 3));
+
+  stabilizer.append(getVertex(x, height, z + 3));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1));
+  stabilizer.append(getVertex(x + 1, height, z + 1));
+  stabilizer.append(getVertex(x, height, z + 3));
+
+  stabilizer.append(getVertex(x, height, z + 3));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1));
+
+  stabilizer.append(getVertex(x, 0.000000, z + depth));
+  stabilizer.append(getVertex(x, 0.000000, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1));
+
+  stabilizer.append(getVertex(x, 0.000000, z + depth));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + depth));
+
+  stabilizer.append(getVertex(x, height, z + 3));
+  stabilizer.append(getVertex(x, 0.000000, z + depth));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + depth));
+
+  stabilizer.append(getVertex(x, height, z + 3));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + depth));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x + 1, height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+  stabilizer.append(getVertex(x, height, z));
+  stabilizer.append(getVertex(x + 1, height, z));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+  stabilizer.append(getVertex(x, height - 1, z));
+  stabilizer.append(getVertex(x, height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1));
+
+  stabilizer.append(getVertex(x, height, z + 1));
+  stabilizer.append(getVertex(x + 1, height, z + 1));
+  stabilizer.append(getVertex(x + 1, height, z));
+
+  stabilizer.append(getVertex(x, height, z + 1));
+  stabilizer.append(getVertex(x + 1, height, z));
+  stabilizer.append(getVertex(x, height, z));
+
+  stabilizer.append(getVertex(x, height - 1, z + 1));
+  stabilizer.append(getVertex(x, height, z + 1));
+  stabilizer.append(getVertex(x, height, z));
+
+  stabilizer.append(getVertex(x, height - 1, z + 1));
+  stabilizer.append(getVertex(x, height, z));
+  stabilizer.append(getVertex(x, height - 1, z));
+
+  stabilizer.append(getVertex(x + 1, height, z + 1));
+  stabilizer.append(getVertex(x + 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+
+  stabilizer.append(getVertex(x + 1, height, z + 1));
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+  stabilizer.append(getVertex(x + 1, height, z));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+  stabilizer.append(getVertex(x + 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x, height - 1, z + 1));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+  stabilizer.append(getVertex(x, height - 1, z + 1));
+  stabilizer.append(getVertex(x, height - 1, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1));
+  stabilizer.append(getVertex(x, 0.000000, z + 1));
+  stabilizer.append(getVertex(x, height - 1, z + 1));
+
+  stabilizer.append(getVertex(x, height - 1, z + 1));
+  stabilizer.append(getVertex(x + 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1));
+
+  // Back
+  z = (renderSettings.minThickness * -1);
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - depth));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - 1));
+
+  stabilizer.append(getVertex(x, height, z - 3));
+  stabilizer.append(getVertex(x, 0.000000, z - depth));
+  stabilizer.append(getVertex(x, 0.000000, z - 1));
+
+  stabilizer.append(getVertex(x, height - 1, z - 1));
+  stabilizer.append(getVertex(x, height, z - 1));
+  stabilizer.append(getVertex(x, height, z - 3));
+
+  stabilizer.append(getVertex(x, 0.000000, z - 1));
+  stabilizer.append(getVertex(x, height - 1, z - 1));
+  stabilizer.append(getVertex(x, height, z - 3));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
+  stabilizer.append(getVertex(x, height, z - 3));
+  stabilizer.append(getVertex(x, height, z - 1));
+
+  stabilizer.append(getVertex(x + 1, height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
+  stabilizer.append(getVertex(x, height, z - 1));
+  stabilizer.append(getVertex(x + 1, height, z - 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - depth));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - 1));
+  stabilizer.append(getVertex(x, 0.000000, z - 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - depth));
+  stabilizer.append(getVertex(x, 0.000000, z - 1));
+  stabilizer.append(getVertex(x, 0.000000, z - depth));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - depth));
+  stabilizer.append(getVertex(x, 0.000000, z - depth));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
+  stabilizer.append(getVertex(x, 0.000000, z - depth));
+  stabilizer.append(getVertex(x, height, z - 3));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1));
+  stabilizer.append(getVertex(x + 1, height, z - 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x + 1, height, z - 1));
+  stabilizer.append(getVertex(x + 1, height - 1, z - 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+  stabilizer.append(getVertex(x, height, z));
+  stabilizer.append(getVertex(x, height - 1, z));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+  stabilizer.append(getVertex(x + 1, height, z));
+  stabilizer.append(getVertex(x, height, z));
+
+  stabilizer.append(getVertex(x, height, z - 1));
+  stabilizer.append(getVertex(x, height - 1, z - 1));
+  stabilizer.append(getVertex(x, height - 1, z));
+
+  stabilizer.append(getVertex(x, height, z - 1));
+  stabilizer.append(getVertex(x, height - 1, z));
+  stabilizer.append(getVertex(x, height, z));
+
+  stabilizer.append(getVertex(x + 1, height, z - 1));
+  stabilizer.append(getVertex(x, height, z - 1));
+  stabilizer.append(getVertex(x, height, z));
+
+  stabilizer.append(getVertex(x + 1, height, z - 1));
+  stabilizer.append(getVertex(x, height, z));
+  stabilizer.append(getVertex(x + 1, height, z));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x + 1, height, z - 1));
+  stabilizer.append(getVertex(x + 1, height, z));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x + 1, height, z));
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+  stabilizer.append(getVertex(x, height - 1, z));
+  stabilizer.append(getVertex(x, height - 1, z - 1));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z));
+  stabilizer.append(getVertex(x, height - 1, z - 1));
+  stabilizer.append(getVertex(x + 1, height - 1, z - 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
+
+  stabilizer.append(getVertex(x, 0.000000, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1));
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x, 0.000000, z - 1));
+
+  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x + 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x, 0.000000, z - 1));
+
+  stabilizer.append(getVertex(x + 1, height - 1, z - 1));
+  stabilizer.append(getVertex(x, height - 1, z - 1));
+  stabilizer.append(getVertex(x, 0.000000, z - 1));
+
+  return stabilizer;
+}
+
+static void addTriangle(QVector<quint32> &indices, const quint32 &a, const quint32 &b, const quint32 &c)
+{
+  indices.append(a);
+  indices.append(b);
+  indices.append(c);
+}
+
+static void addQuad(QVector<quint32> &indices, const quint32 &a, const quint32 &b, const quint32 &c, const quint32 &d)
+{
+  addTriangle(indices, a, b, c);
+  addTriangle(indices, a, c, d);
+}
+
+static void addStrip(QVector<quint32> &indices, const QVector<QVector3D> &vertices,
+                     const QVector<quint32> &a, const QVector<quint32> &b,
+                     const bool &alongX, const float &direction)
+{
+  // Triangulates the band between two polylines using only their own
+  // vertices, so neighbouring faces sharing them never get a T-junction.
+  // The first and last vertices of both lines form the band ends. Seen from
+  // the outside 'b' must lie to the left when walking along 'a'.
+  auto position = [&](const quint32 &index) {
+    return (alongX?vertices.at(index).x():vertices.at(index).y()) * direction;
+  };
+  int i = 0;
+  int j = 0;
+  while(i < a.size() - 1 || j < b.size() - 1) {
+    if(i < a.size() - 1 && (j == b.size() - 1 || position(a.at(i + 1)) <= position(b.at(j + 1)))) {
+      addTriangle(indices, a.at(i), a.at(i + 1), b.at(j));
+      ++i;
+    } else {
+      addTriangle(indices, a.at(i), b.at(j + 1), b.at(j));
+      ++j;
+    }
+  }
+}
+
+QList<QVector3D> Lithophane::addLips(const float &width, const float &height, const float &start)
+{
+  // Tiles get a thin plate on the back of their right and top frame borders
+  // wherever a neighbouring tile continues the image. The plate reaches
+  // across the frame border of the neighbour, so the tiles line up when
+  // glued together. Right lips start above the stabilizers and top lips keep
+  // clear of the corners, so the lips of adjacent tiles never meet.
+  QList<QVector3D> lips;
+  float back = renderSettings.minThickness * -1;
+  float thickness = renderSettings.minThickness;
+  auto addBox = [this, &lips](const float &x0, const float &y0, const float &z0,
+                              const float &x1, const float &y1, const float &z1) {
+    QVector3D quads[6][4] = {
+      {getVertex(x0, y0, z0), getVertex(x0, y0, z1), getVertex(x0, y1, z1), getVertex(x0, y1, z0)},
+      {getVertex(x1, y0, z0), getVertex(x1, y1, z0), getVertex(x1, y1, z1), getVertex(x1, y0, z1)},
+      {getVertex(x0, y0, z0), getVertex(x1, y0, z0), getVertex(x1, y0, z1), getVertex(x0, y0, z1)},
+      {getVertex(x0, y1, z0), getVertex(x0, y1, z1), getVertex(x1, y1, z1), getVertex(x1, y1, z0)},
+      {getVertex(x0, y0, z0), getVertex(x0, y1, z0), getVertex(x1, y1, z0), getVertex(x1, y0, z0)},
+      {getVertex(x0, y0, z1), getVertex(x1, y0, z1), getVertex(x1, y1, z1), getVertex(x0, y1, z1)}};
+    for(const auto &quad: quads) {
+      lips << quad[0] << quad[1] << quad[2] << quad[0] << quad[2] << quad[3];
+    }
+  };
+
+  if(renderSettings.tileColumn < renderSettings.tileColumns - 1 && start < height) {
+    addBox(width - border, start, back - thickness, width + border, height, back);
+  }
+  if(renderSettings.tileRow > 0 && width > border * 4) {
+    addBox(border * 2, height - border, back - thickness, width - (border * 2), height + border, back);
+  }
+
+  return lips;
+}
+
+int Lithophane::solidInset() const
+{
+  // The number of pixel rings hidden below the frame slope. At least one
+  // ring is needed to keep the slope from turning into a vertical wall.
+  float frameSlope = (renderSettings.totalThickness - renderSettings.minThickness) * renderSettings.frameSlopeFactor;
+  int inset = qMax(1, qRound(frameSlope / widthFactor));
+  return qMin(inset, (qMin(imageWidth, imageHeight) - 2) / 2);
+}
+
+void Lithophane::addSolid(Mesh &mesh, const int &inset, const float &width, const float &height)
+{
+  // Builds the frame and heightmap as one closed, consistently wound surface.
+  // The frame slope lands directly on the ring of grid vertices 'inset'
+  // pixels in, which replaces the pixels the regular frame overlaps. Every
+  // face is triangulated against the vertices of its neighbours, so the
+  // result needs no boolean union or repair in the slicer.
+  float minThickness = renderSettings.minThickness;
+  float depth = renderSettings.totalThickness - minThickness;
+  QVector<QVector3D> &vertices = mesh.vertices;
+  QVector<quint32> &indices = mesh.indices;
+  auto addVertex = [&vertices](const QVector3D &vertex) {
+    vertices.append(vertex);
+    return (quint32)(vertices.size() - 1);
+  };
+  int left = inset;
+  int right = imageWidth - 1 - inset;
+  int bottom = inset;
+  int top = imageHeight - 1 - inset;
+
+  // The lithophane heightmap inside the inset ring
+  indices.clear();
+  indices.reserve((right - left) * (top - bottom) * 6);
+  for(int y = bottom; y < top; ++y) {
+    for(int x = left; x < right; ++x) {
+      addTriangle(indices, topIndex(x, y), topIndex(x + 1, y + 1), topIndex(x, y + 1));
+      addTriangle(indices, topIndex(x, y), topIndex(x + 1, y), topIndex(x + 1, y + 1));
+    }
+  }
+
+  // The inner edge of the frame front gets a vertex for every column and row
+  // of the ring the slope lands on. The polylines run counter-clockwise and
+  // share their corners.
+  float innerRight = width - border;
+  float innerTop = height - border;
+  QVector<quint32> innerBottom = {addVertex(getVertex(border, border, depth))};
+  QVector<quint32> innerRightSide = {addVertex(getVertex(innerRight, border, depth))};
+  QVector<quint32> innerTopSide = {addVertex(getVertex(innerRight, innerTop, depth))};
+  QVector<quint32> innerLeft = {addVertex(getVertex(border, innerTop, depth))};
+  for(int x = left; x <= right; ++x) {
+    innerBottom.append(addVertex(QVector3D(getVertex(x, 0, 0, true).x(), border, depth)));
+  }
+  for(int y = bottom; y <= top; ++y) {
+    innerRightSide.append(addVertex(QVector3D(innerRight, getVertex(0, y, 0, true).y(), depth)));
+  }
+  for(int x = right; x >= left; --x) {
+    innerTopSide.append(addVertex(QVector3D(getVertex(x, 0, 0, true).x(), innerTop, depth)));
+  }
+  for(int y = top; y >= bottom; --y) {
+    innerLeft.append(addVertex(QVector3D(border, getVertex(0, y, 0, true).y(), depth)));
+  }
+  innerBottom.append(innerRightSide.first());
+  innerRightSide.append(innerTopSide.first());
+  innerTopSide.append(innerLeft.first());
+  innerLeft.append(innerBottom.first());
+
+  // Frame slope, as one quad per ring pixel plus a quad in each corner
+  for(int x = left; x < right; ++x) {
+    addQuad(indices, innerBottom.at(x - left + 1), innerBottom.at(x - left + 2),
+            topIndex(x + 1, bottom), topIndex(x, bottom));
+    addQuad(indices, topIndex(x, top), topIndex(x + 1, top),
+            innerTopSide.at(right - x), innerTopSide.at(right - x + 1));
+  }
+  for(int y = bottom; y < top; ++y) {
+    addQuad(indices, topIndex(right, y), innerRightSide.at(y - bottom + 1),
+            innerRightSide.at(y - bottom + 2), topIndex(right, y + 1));
+    addQuad(indices, innerLeft.at(top - y + 1), topIndex(left, y),
+            topIndex(left, y + 1), innerLeft.at(top - y));
+  }
+  addQuad(indices, innerBottom.first(), innerBottom.at(1), topIndex(left, bottom), innerLeft.at(innerLeft.size() - 2));
+  addQuad(indices, innerBottom.at(innerBottom.size() - 2), innerRightSide.first(), innerRightSide.at(1), topIndex(right, bottom));
+  addQuad(indices, topIndex(right, top), innerRightSide.at(innerRightSide.size() - 2), innerTopSide.first(), innerTopSide.at(1));
+  addQuad(indices, innerLeft.at(1), topIndex(left, top), innerTopSide.at(innerTopSide.size() - 2), innerLeft.first());
+
+  // Frame front, from the outer corners to the inner edge
+  quint32 frontBottomLeft = addVertex(getVertex(0.000000, 0.000000, depth));
+  quint32 frontBottomRight = addVertex(getVertex(width, 0.000000, depth));
+  quint32 frontTopRight = addVertex(getVertex(width, height, depth));
+  quint32 frontTopLeft = addVertex(getVertex(0.000000, height, depth));
+  addStrip(indices, vertices, {frontBottomLeft, frontBottomRight}, innerBottom, true, 1.0);
+  addStrip(indices, vertices, {frontBottomRight, frontTopRight}, innerRightSide, false, 1.0);
+  addStrip(indices, vertices, {frontTopRight, frontTopLeft}, innerTopSide, true, -1.0);
+  addStrip(indices, vertices, {frontTopLeft, frontBottomLeft}, innerLeft, false, -1.0);
+
+  // Outer walls and backside
+  quint32 backBottomLeft = addVertex(getVertex(0.000000, 0.000000, - minThickness));
+  quint32 backBottomRight = addVertex(getVertex(width, 0.000000, - minThickness));
+  quint32 backTopRight = addVertex(getVertex(width, height, - minThickness));
+  quint32 backTopLeft = addVertex(getVertex(0.000000, height, - minThickness));
+  addQuad(indices, backBottomLeft, backBottomRight, frontBottomRight, frontBottomLeft);
+  addQuad(indices, backBottomRight, backTopRight, frontTopRight, frontBottomRight);
+  addQuad(indices, backTopLeft, backBottomLeft, frontBottomLeft, frontTopLeft);
+  addQuad(indices, backBottomLeft, backTopLeft, backTopRight, backBottomRight);
+
+  // The top wall has a hole for each hanger foot. Holes are given as bottom
+  // left, bottom right, top right and top left corners, seen from the front.
+  QVector<quint32> holes;
+  if(renderSettings.enableHangers && renderSettings.tileRow == 0) {
+    holes = addSolidHangers(mesh, width, height);
+  }
+  QVector<quint32> wall;
+  if(holes.isEmpty()) {
+    addQuad(wall, backTopLeft, backTopRight, frontTopRight, frontTopLeft);
+  } else {
+    // Below, above and between the holes, using only the wall corners and
+    // the hole corners
+    QVector<quint32> holeBottoms;
+    QVector<quint32> holeTops;
+    for(int a = 0; a < holes.size(); a += 4) {
+      holeBottoms << holes.at(a) << holes.at(a + 1);
+      holeTops << holes.at(a + 3) << holes.at(a + 2);
+      if(a > 0) {
+        addQuad(wall, holes.at(a - 3), holes.at(a), holes.at(a + 3), holes.at(a - 2));
+      }
+    }
+    addStrip(wall, vertices, {backTopLeft, backTopRight}, holeBottoms, true, 1.0);
+    addStrip(wall, vertices, holeTops, {frontTopLeft, frontTopRight}, true, 1.0);
+    addQuad(wall, backTopLeft, holes.first(), holes.at(3), frontTopLeft);
+    addQuad(wall, holes.at(holes.size() - 3), backTopRight, frontTopRight, holes.at(holes.size() - 2));
+  }
+  // The wall faces away from the viewpoint used above, so flip the winding
+  for(int a = 0; a < wall.size(); a += 3) {
+    addTriangle(indices, wall.at(a), wall.at(a + 2), wall.at(a + 1));
+  }
+}
+
+QVector<quint32> Lithophane::addSolidHangers(Mesh &mesh, const float &width, const float &height)
+{
+  // Same shape and placement as addHangers(), but indexed and without the
+  // faces where the feet touch the frame, so the frame top wall can be
+  // stitched to them. Hangers are left out if they wouldn't fit the frame.
+  QVector<quint32> holes;
+  float thickness = qMin(2.0f, renderSettings.totalThickness - renderSettings.minThickness - 0.4f);
+  int noOfHangers = renderSettings.hangers;
+  float xDelta = (width / noOfHangers) / 2.0;
+  float x = xDelta - 4.5; // 4.5 is half the width of a hanger
+  if(thickness < 0.4 || noOfHangers < 1 || x <= 0.0 || xDelta * 2 <= 9.0 ||
+     x + (xDelta * 2 * (noOfHangers - 1)) + 9 >= width) {
+    printf("Hangers don't fit the frame of a solid mesh, leaving them out.\n");
+    return holes;
+  }
+
+  // Outline seen from the front, counter-clockwise starting at the left foot
+  static const float outline[8][2] = {{0, 0}, {3, 0}, {4, 1}, {5, 1}, {6, 0}, {9, 0}, {6, 3}, {3, 3}};
+  static const int front[6][3] = {{1, 0, 7}, {7, 6, 5}, {5, 4, 3}, {2, 1, 7}, {7, 5, 3}, {7, 3, 2}};
+  for(int a = 0; a < noOfHangers; a++) {
+    quint32 base = mesh.vertices.size();
+    for(int b = 0; b < 8; ++b) {
+      mesh.vertices.append(getVertex(x + outline[b][0], height + outline[b][1], 0.000000));
+    }
+    for(int b = 0; b < 8; ++b) {
+      mesh.vertices.append(getVertex(x + outline[b][0], height + outline[b][1], thickness));
+    }
+    for(int b = 0; b < 6; ++b) {
+      addTriangle(mesh.indices, base + front[b][0], base + front[b][1], base + front[b][2]);
+      addTriangle(mesh.indices, base + 8 + front[b][2], base + 8 + front[b][1], base + 8 + front[b][0]);
+    }
+    for(int b = 0; b < 8; ++b) {
+      // Skip the feet
+      if(b == 0 || b == 4) {
+        continue;
+      }
+      addQuad(mesh.indices, base + b, base + ((b + 1) % 8), base + 8 + ((b + 1) % 8), base + 8 + b);
+    }
+    holes << base + 0 << base + 1 << base + 8 + 1 << base + 8 + 0;
+    holes << base + 4 << base + 5 << base + 8 + 5 << base + 8 + 4;
+
+    // Move over to the next hanger placement
+    x += xDelta * 2;
+  }
+
+  return holes;
+}
+
+QVector3D Lithophane::getVertex(float x, float y, float z, const bool &scale)
+{
+  float add = 0.0;
+  if(scale) {
+    x = x * widthFactor;
+    y = y * widthFactor;
+    //z = z * widthFactor;
+    add = border;
+  }
+  return QVector3D(x + add, y + add, z);
+}
@@ -0,0 +1,134 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            lithophane.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __LITHOPHANE_H__
+#define __LITHOPHANE_H__
+
+#include <functional>
+#include <QObject>
+#include <QAtomicInt>
+#include <QImage>
+#include <QVector>
+#include <QVector3D>
+
+#include "mesh.h"
+#include "rendersettings.h"
+#include "memorystats.h"
+
+// Renders lithophane meshes from an image without any ui involvement.
+// The image is prepared (grayscale and inverted) and the heightmap grid
+// topology is built once in setImage(). Each call to render() then only
+// needs to calculate the vertex positions and the frame geometry for the
+// given render settings. Images too large to hold the whole mesh in
+// memory can be rendered in bands with renderBands() instead.
+class Lithophane : public QObject
+{
+  Q_OBJECT
+  // The benchmarks time the grid and frame pieces on their own
+  friend class Benchmark;
+
+public:
+  Lithophane();
+  ~Lithophane();
+  // The grid topology can be left out when only rendering in bands. It is
+  // then built by the first call to render().
+  void setImage(QImage image, const bool &topology = true);
+  // Prepares the same heights as setImage() straight from a PNG file, with
+  // the grid topology built while the image is decoded. Returns false,
+  // leaving the lithophane empty, for files PngReader leaves to QImage.
+  bool loadPng(const QString &filename, const bool &topology = true);
+  void shareImage(const Lithophane &other);
+  bool isNull() const;
+  int width() const;
+  int height() const;
+  Mesh render(const RenderSettings &renderSettings);
+  // Renders the same facets in the same order as render(), but hands them
+  // to the sink a band of cell rows at a time, followed by a last part with
+  // the backside and frame. Each part is a mesh of its own that is only
+  // valid during the call. Returns false if cancelled or if the sink returns
+  // false. Solid meshes can't be rendered in bands. Bands ending at or before
+  // the first row are skipped, to resume a render with the same band rows.
+  // Bands starting at or after the stop row are left out, and so are the
+  // backside and frame unless the stop row is the end of the image, to
+  // share the bands of a render between several processes.
+  bool renderBands(const RenderSettings &renderSettings, const int &bandRows,
+                   const std::function<bool(const Mesh &)> &sink, const int &firstRow = 0,
+                   const int &stopRow = -1);
+  static qint64 estimateMemory(const int &width, const int &height);
+  static qint64 estimateBandMemory(const int &width, const int &height, const int &bandRows);
+  // Facets of a regular (not solid) render of an image of the given size
+  static qint64 estimateFacets(const int &width, const int &height,
+                               const RenderSettings &renderSettings);
+  qint64 imageMemory() const;
+  QByteArray contentHash() const;
+  bool isCancelled() const;
+
+public slots:
+  void cancel();
+
+signals:
+  void progress(int value, int maximum);
+
+private:
+  void buildTopology();
+  quint32 topIndex(const int &x, const int &y) const;
+  quint32 floorIndex(const int &x, const int &y) const;
+  int floorCount() const;
+  int rowOffset(const int &y) const;
+  void buildBlock(quint32 *indices, const int &x0, const int &y0,
+                  const int &x1, const int &y1, const int &offset = 0) const;
+  void addBackside(QVector<quint32> &indices) const;
+  void quantizeRow(const quint8 *row, float *depths, const int &layers,
+                   float *errors, float *nextErrors, const bool &reverse) const;
+
+  int imageWidth = 0;
+  int imageHeight = 0;
+  QVector<quint8> heights;
+  QVector<quint32> gridIndices;
+  QAtomicInt cancelled;
+  TrackedBuffer heightmapBuffer{MemoryStats::Heightmap};
+
+  RenderSettings renderSettings;
+  float depthFactor = -1.0;
+  float widthFactor = -1.0;
+  float border = -1.0;
+
+  QVector3D getVertex(float x, float y, float z, const bool &scale = false);
+  int setupRender(const RenderSettings &renderSettings);
+  void placeRow(const int &y, const int &layers, float *depths, QVector3D *vertices,
+                float *errors = nullptr, float *nextErrors = nullptr);
+  void appendGeometry(Mesh &mesh, TrackedBuffer &meshBuffer);
+
+  QList<QVector3D> addFrame(const float &width, const float &height);
+  QList<QVector3D> addHangers(const float &width, const float &height);
+  QList<QVector3D> addStabilizer(const float &x, const float &height);
+  QList<QVector3D> addLips(const float &width, const float &height, const float &start);
+  int solidInset() const;
+  void addSolid(Mesh &mesh, const int &inset, const float &width, const float &height);
+  QVector<quint32> addSolidHangers(Mesh &mesh, const float &width, const float &height);
+};
+
+#endif // __LITHOPHANE_H__
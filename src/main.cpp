@@ -31,11 +31,22 @@
 #include <QStyleFactory>
 
 #include "mainwindow.h"
+#include "commandline.h"
 
 QSettings *settings;
 
 int main(int argc, char *argv[])
 {
+  if(CommandLine::isHeadless(argc, argv)) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationVersion(VERSION);
+
+    QSettings s("LithoMaker");
+    settings = &s;
+
+    return CommandLine::run(app.arguments());
+  }
+
   QApplication app(argc, argv);
   app.setStyle(QStyleFactory::create("Fusion"));
   
@@ -25,7 +25,6 @@
  */
 
 #include <stdio.h>
-#include <fstream>
 #include <QtWidgets>
 #include <QSettings>
 
@@ -33,6 +32,12 @@
 #include "aboutbox.h"
 #include "configdialog.h"
 #include "slider.h"
+#include "rendersettings.h"
+#include "rendercache.h"
+#include "renderjob.h"
+#include "exporter.h"
+#include "printerprofile.h"
+#include "trace.h"
 
 extern QSettings *settings;
 
@@ -52,6 +57,10 @@ MainWindow::MainWindow()
 
   setWindowTitle("LithoMaker v" VERSION);
 
+  // Tracing stays on for the whole session, the file is written on exit
+  traceFile = settings->value("main/traceFile", "").toString();
+  Trace::setEnabled(!traceFile.isEmpty());
+
   createActions();
   createMenus();
 
@@ -83,10 +92,24 @@ MainWindow::MainWindow()
   outputLayout->addWidget(outputLineEdit);
   outputLayout->addWidget(outputButton);
 
+  // The estimate follows every change to the settings and filenames
+  calibration = RenderCalibration::fromConfig(*settings);
+  estimateLabel = new QLabel();
+  estimateLabel->setWordWrap(true);
+  for(const auto &slider: {minThicknessSlider, totalThicknessSlider, borderSlider, widthSlider}) {
+    connect(slider, &Slider::valueChanged, this, &MainWindow::updateEstimate);
+  }
+  connect(inputLineEdit, &QLineEdit::textChanged, this, &MainWindow::updateEstimate);
+  connect(outputLineEdit, &QLineEdit::textChanged, this, &MainWindow::updateEstimate);
+  updateEstimate();
+
   renderButton = new QPushButton(tr("Render and export"));
-  connect(renderButton, &QPushButton::clicked, this, &MainWindow::createMesh);
-  renderProgress = new QProgressBar(this);
-  renderProgress->setMinimum(0);
+  connect(renderButton, &QPushButton::clicked, this, &MainWindow::queueRender);
+
+  renderQueue = new RenderQueue();
+  connect(renderQueue, &RenderQueue::jobMessage, this, [this](const QString &message) {
+      statusBar()->showMessage(message, 10000);
+    });
   
   QVBoxLayout *layout = new QVBoxLayout();
   layout->addWidget(minThicknessLabel);
@@ -101,8 +124,9 @@ MainWindow::MainWindow()
   layout->addLayout(inputLayout);
   layout->addWidget(outputLabel);
   layout->addLayout(outputLayout);
+  layout->addWidget(estimateLabel);
   layout->addWidget(renderButton);
-  layout->addWidget(renderProgress);
+  layout->addWidget(renderQueue);
 
   setCentralWidget(new QWidget());
   centralWidget()->setLayout(layout);
@@ -115,6 +139,9 @@ MainWindow::~MainWindow()
   settings->setValue("main/windowState", saveGeometry());
   settings->setValue("main/inputFilePath", inputLineEdit->text());
   settings->setValue("main/outputFilePath", outputLineEdit->text());
+  if(!traceFile.isEmpty() && !Trace::write(traceFile)) {
+    printf("Trace file '%s' could not be written.\n", traceFile.toStdString().c_str());
+  }
 }
 
 void MainWindow::createActions()
@@ -163,9 +190,12 @@ void MainWindow::showPreferences()
   // Spawn preferences dialog
   ConfigDialog preferences(this);
   preferences.exec();
+  // Formats, render settings or the calibration may have changed
+  calibration = RenderCalibration::fromConfig(*settings);
+  updateEstimate();
 }
 
-void MainWindow::createMesh()
+void MainWindow::queueRender()
 {
   if(!QFileInfo::exists(inputLineEdit->text())) {
     QMessageBox::warning(this, tr("File not found"), tr("Input file doesn't exist. Please check filename and permissions."));
@@ -177,796 +207,72 @@ void MainWindow::createMesh()
     return;
   }
 
-  disableUi();
-  
-  printf("Rendering STL...\n");
-  polygons.clear();
-  QImage image(inputLineEdit->text());
-  if((image.width() > maxSize || image.height() > maxSize) &&
-     QMessageBox::question(this, tr("Large image"), tr("The input image is quite large. It is recommended to keep it at a resolution lower or equal to ") + QString::number(maxSize) + " x " + QString::number(maxSize) + tr(" pixels to avoid an unnecessarily complex 3D mesh. Do you want LithoMaker to resize the image before processing it?")) == QMessageBox::Yes) {
-    if(image.width() > image.height()) {
-      image = image.scaledToWidth(maxSize);
-    } else {
-      image = image.scaledToHeight(maxSize);
+  // All questions are asked up front, the job itself runs in the background
+  RenderJob job;
+  job.inputFile = inputLineEdit->text();
+  job.addOutputs(outputLineEdit->text(), settings->value("export/stlFormat", "binary").toString(),
+                 Exporter::parseFormats(settings->value("export/additionalFormats", "").toString()));
+  for(const auto &output: job.outputs) {
+    if(!Exporter::formats().contains(output.format)) {
+      QMessageBox::warning(this, tr("Unknown export format"), tr("The additional export format '%1' is unknown. Please correct it in the export preferences.").arg(output.format));
+      return;
     }
   }
-  if(!image.isGrayscale()) {
-    printf("Converting image to grayscale.\n");
-    image = image.convertToFormat(QImage::Format_Grayscale8);
+  bool profileOk = true;
+  job.printerProfile = PrinterProfile::fromFile(settings->value("export/printerProfile", "").toString(), &profileOk);
+  if(!profileOk && Exporter::parseFormats(settings->value("export/stlFormat", "binary").toString() + "," +
+                                          settings->value("export/additionalFormats", "").toString()).contains("gcode")) {
+    QMessageBox::warning(this, tr("Printer profile not found"), tr("The printer profile for G-code export could not be read. Please check the filename in the export preferences."));
+    return;
   }
-  image.invertPixels();
-  border = settings->value("render/frameBorder").toFloat();
-  depthFactor = (settings->value("render/totalThickness").toFloat() - settings->value("render/minThickness").toFloat()) / 255.0;
-  widthFactor = (settings->value("render/width").toFloat() - (border * 2)) / image.width();
-  float minThickness = settings->value("render/minThickness").toFloat() * -1;
-  renderProgress->setMaximum(image.height() - 1);
-  renderProgress->setValue(0);
-  renderProgress->setFormat(tr("Rendering %p%"));
-  for(int y = 0; y < image.height() - 1; ++y) {
-    // Close left side
-    polygons.append(getVertex(0, y, minThickness, true));
-    polygons.append(getVertex(0, y, getPixel(image, 0, y) * depthFactor, true));
-    polygons.append(getVertex(0, y + 1, getPixel(image, 0, y + 1) * depthFactor, true));
-    
-    polygons.append(getVertex(0, y + 1, getPixel(image, 0, y + 1) * depthFactor, true));
-    polygons.append(getVertex(0, y + 1, minThickness, true));
-    polygons.append(getVertex(0, y, minThickness, true));
-    for(int x = 0; x < image.width() - 1; ++x) {
-      if(y == 0) {
-        // Close top
-        polygons.append(getVertex(x + 1, 0, getPixel(image, x + 1, 0) * depthFactor, true));
-        polygons.append(getVertex(x, 0, getPixel(image, x, 0) * depthFactor, true));
-        polygons.append(getVertex(x, 0, minThickness, true));
-    	
-        polygons.append(getVertex(x, 0, minThickness, true));
-        polygons.append(getVertex(x + 1, 0, minThickness, true));
-        polygons.append(getVertex(x + 1, 0, getPixel(image, x + 1, 0) * depthFactor, true));
-    
-        // Close bottom
-        polygons.append(getVertex(x, image.height() - 1, minThickness, true));
-        polygons.append(getVertex(x, image.height() - 1, getPixel(image, x, image.height() - 1) * depthFactor, true));
-        polygons.append(getVertex(x + 1, image.height() - 1, getPixel(image, x + 1, image.height() - 1) * depthFactor, true));
-    	
-        polygons.append(getVertex(x + 1, image.height() - 1, getPixel(image, x + 1, image.height() - 1) * depthFactor, true));
-        polygons.append(getVertex(x + 1, image.height() - 1, minThickness, true));
-        polygons.append(getVertex(x, image.height() - 1, minThickness, true));
-      }
-      // The lithophane heightmap
-      polygons.append(getVertex(x, y, getPixel(image, x, y) * depthFactor, true));
-      polygons.append(getVertex(x + 1, y + 1, getPixel(image, x + 1, y + 1) * depthFactor, true));
-      polygons.append(getVertex(x, y + 1, getPixel(image, x, y + 1) * depthFactor, true));
-  
-      polygons.append(getVertex(x, y, getPixel(image, x, y) * depthFactor, true));
-      polygons.append(getVertex(x + 1, y, getPixel(image, x + 1, y) * depthFactor, true));
-      polygons.append(getVertex(x + 1, y + 1, getPixel(image, x + 1, y + 1) * depthFactor, true));
-    }
-    // Close right side
-    polygons.append(getVertex(image.width() - 1, y + 1, getPixel(image, image.width() - 1, y + 1) * depthFactor, true));
-    polygons.append(getVertex(image.width() - 1, y, getPixel(image, image.width() - 1, y) * depthFactor, true));
-    polygons.append(getVertex(image.width() - 1, y, minThickness, true));
-    
-    polygons.append(getVertex(image.width() - 1, y, minThickness, true));
-    polygons.append(getVertex(image.width() - 1, y + 1, minThickness, true));
-    polygons.append(getVertex(image.width() - 1, y + 1, getPixel(image, image.width() - 1, y + 1) * depthFactor, true));
-    renderProgress->setValue(renderProgress->value() + 1);
+  // Snapshot the settings so they can be changed while the job runs. A
+  // tiled job is queued as one job per tile, so they render in parallel.
+  job.renderSettings = RenderSettings::fromConfig();
+  job.validate = settings->value("export/validateMesh", true).toBool();
+  QList<RenderJob> jobs = job.tiles();
+  QStringList outputFiles;
+  for(const auto &tile: jobs) {
+    outputFiles.append(tile.outputFiles());
   }
-  renderProgress->setValue(renderProgress->maximum());
-  renderProgress->setFormat("Ready!");
-
-  // Backside
-  polygons.append(getVertex(0, image.height() - 1, minThickness, true));
-  polygons.append(getVertex(image.width() - 1, image.height() - 1, minThickness, true));
-  polygons.append(getVertex(0, 0, minThickness, true));
-
-  polygons.append(getVertex(image.width() - 1, image.height() - 1, minThickness, true));
-  polygons.append(getVertex(image.width() - 1, 0, minThickness, true));
-  polygons.append(getVertex(0, 0, minThickness, true));
-
-  // Stabilizers
-  double totalHeight = ((border * 2) + (image.height() * widthFactor));
-  double stabilizerHeightFactor = settings->value("render/stabilizerHeightFactor", 0.15).toDouble();
-  if(settings->value("render/enableStabilizers", true).toBool() &&
-     totalHeight > settings->value("render/stabilizerThreshold", 60.0).toDouble()) {
-    polygons.append(addStabilizer(0, ((border * 2) + (image.height() * widthFactor)) * stabilizerHeightFactor));
-    polygons.append(addStabilizer(settings->value("render/width").toFloat() - (border < 4?border:4), totalHeight * stabilizerHeightFactor));
+  if(renderQueue->isActive(outputFiles)) {
+    QMessageBox::warning(this, tr("Output in use"), tr("A job in the render queue is already exporting to this STL file. Please wait for it to finish or choose another filename."));
+    return;
   }
-
-  // Frame
-  polygons.append(addFrame(settings->value("render/width").toFloat(), (border * 2) + (image.height() * widthFactor)));
-
-  // Hanger(s)
-  if(settings->value("render/enableHangers", true).toBool()) {
-    polygons.append(addHangers(settings->value("render/width").toFloat(), (border * 2) + (image.height() * widthFactor)));
+  QSize size = QImageReader(job.inputFile).size();
+  if((size.width() > maxSize || size.height() > maxSize) &&
+     QMessageBox::question(this, tr("Large image"), tr("The input image is quite large. It is recommended to keep it at a resolution lower or equal to ") + QString::number(maxSize) + " x " + QString::number(maxSize) + tr(" pixels to avoid an unnecessarily complex 3D mesh. Do you want LithoMaker to resize the image before processing it?")) == QMessageBox::Yes) {
+    job.maxSize = maxSize;
   }
-  
-  printf("Rendering finished...\n");
-  exportStl();
-}
-
-void MainWindow::exportStl()
-{
-  if(polygons.isEmpty()) {
-    QMessageBox::warning(this, tr("Empty STL buffer"), tr("There is currently no rendered lithophane in the STL buffer. You need to render one before you can export it."));
-    enableUi();
-    return;
+  bool exists = false;
+  for(const auto &outputFile: outputFiles) {
+    exists = exists || QFileInfo::exists(outputFile);
   }
-  if(QFileInfo::exists(outputLineEdit->text()) && !settings->value("export/alwaysOverwrite", false).toBool() && QMessageBox::question(this, tr("Overwrite file?"), tr("The output STL file already exists. Do you want to overwrite it?")) != QMessageBox::Yes) {
-    enableUi();
+  if(exists && !settings->value("export/alwaysOverwrite", false).toBool() && QMessageBox::question(this, tr("Overwrite file?"), tr("The output STL file already exists. Do you want to overwrite it?")) != QMessageBox::Yes) {
     return;
   }
 
-  printf("Exporting to file: '%s'... ", outputLineEdit->text().toStdString().c_str());
-  
-  if(settings->value("export/stlFormat", "binary").toString() == "binary") {
-    // Export as binary
-    std::ofstream out(outputLineEdit->text().toStdString(), std::ios::binary);
-    if(out.good()) {
-      char title[80];
-      memset(title, 0, 80);
-      strcpy(title, "lithophane");
-      out.write((char *)&title, 80);
-      quint32 polCount = polygons.length() / 3;
-      out.write((char *)&polCount, sizeof(quint32));;
-      quint16 attrByteCount = 0;
-      for(int a = 0; a < polygons.length(); a += 3) {
-        float normal = 0.0;
-        out.write((char *)&normal, sizeof(float));
-        out.write((char *)&normal, sizeof(float));
-        out.write((char *)&normal, sizeof(float));
-        float x, y, z;
-        x = polygons.at(a).x();
-        y = polygons.at(a).y();
-        z = polygons.at(a).z();
-        out.write((char *)&x, sizeof(float));
-        out.write((char *)&y, sizeof(float));
-        out.write((char *)&z, sizeof(float));
-        x = polygons.at(a + 1).x();
-        y = polygons.at(a + 1).y();
-        z = polygons.at(a + 1).z();
-        out.write((char *)&x, sizeof(float));
-        out.write((char *)&y, sizeof(float));
-        out.write((char *)&z, sizeof(float));
-        x = polygons.at(a + 2).x();
-        y = polygons.at(a + 2).y();
-        z = polygons.at(a + 2).z();
-        out.write((char *)&x, sizeof(float));
-        out.write((char *)&y, sizeof(float));
-        out.write((char *)&z, sizeof(float));
-        out.write((char *)&attrByteCount, sizeof(quint16));
-      }
-      out.close();
-      printf("Success!\n");
-      QMessageBox::information(this, tr("Export succeeded"), tr("The binary STL was successfully exported. You can now import it in your preferred 3D printing slicer."));
-    } else {
-      printf("Failed!\n");
-      QMessageBox::warning(this, tr("Export failed"), tr("File could not be opened for writing. Please check export filename and try again."));
-    }
-  } else if(settings->value("export/stlFormat", "binary").toString() == "ascii") {
-    // Export as ascii
-    QFile stlFile(outputLineEdit->text());
-    if(stlFile.open(QIODevice::WriteOnly)) {
-      stlFile.write("solid lithophane\n");
-      for(int a = 0; a < polygons.length(); a += 3) {
-        stlFile.write("facet normal 0.0 0.0 0.0\n");
-        stlFile.write("\touter loop\n");
-        stlFile.write("\t\tvertex " + QByteArray::number(polygons.at(a).x(), 'g') + " " + QByteArray::number(polygons.at(a).y(), 'g') + " " + QByteArray::number(polygons.at(a).z(), 'g') + "\n");
-        stlFile.write("\t\tvertex " + QByteArray::number(polygons.at(a + 1).x(), 'g') + " " + QByteArray::number(polygons.at(a + 1).y(), 'g') + " " + QByteArray::number(polygons.at(a + 1).z(), 'g') + "\n");
-        stlFile.write("\t\tvertex " + QByteArray::number(polygons.at(a + 2).x(), 'g') + " " + QByteArray::number(polygons.at(a + 2).y(), 'g') + " " + QByteArray::number(polygons.at(a + 2).z(), 'g') + "\n");
-        stlFile.write("\tendloop\n");
-        stlFile.write("endfacet\n");
-      }
-      stlFile.write("endsolid\n");
-      stlFile.close();
-      printf("Success!\n");
-      QMessageBox::information(this, tr("Export succeeded"), tr("The ascii STL was successfully exported. You can now import it in your preferred 3D printing slicer."));
-    } else {
-      printf("Failed!\n");
-      QMessageBox::warning(this, tr("Export failed"), tr("File could not be opened for writing. Please check export filename and try again."));
-    }
-  }
-  enableUi();
-}
-
-QList<QVector3D> MainWindow::addFrame(const float &width, const float &height)
-{
-  float minThickness = settings->value("render/minThickness").toFloat();
-  float depth = settings->value("render/totalThickness").toFloat() - minThickness;
-  float frameSlope = depth * settings->value("render/frameSlopeFactor", "0.75").toFloat();
-
-  QList<QVector3D> frame;
-  frame.append(getVertex(width, height, - minThickness));
-  frame.append(getVertex(0.000000, height, - minThickness));
-  frame.append(getVertex(0.000000, height, depth));
-
-  frame.append(getVertex(width, height, - minThickness));
-  frame.append(getVertex(0.000000, height, depth));
-  frame.append(getVertex(width, height, depth));
-
-  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
-  frame.append(getVertex(width - border - frameSlope, height - border - frameSlope, 0.000000));
-  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
-
-  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
-  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
-  frame.append(getVertex(border + frameSlope, border + frameSlope, 0.000000));
-
-  frame.append(getVertex(0.000000, 0.000000, depth));
-  frame.append(getVertex(0.000000, height, depth));
-  frame.append(getVertex(0.000000, height, - minThickness));
-
-  frame.append(getVertex(0.000000, 0.000000, depth));
-  frame.append(getVertex(0.000000, height, - minThickness));
-  frame.append(getVertex(0.000000, 0.000000, - minThickness));
-
-  frame.append(getVertex(0.000000, 0.000000, - minThickness));
-  frame.append(getVertex(width, 0.000000, - minThickness));
-  frame.append(getVertex(width, 0.000000, depth));
-
-  frame.append(getVertex(0.000000, 0.000000, - minThickness));
-  frame.append(getVertex(width, 0.000000, depth));
-  frame.append(getVertex(0.000000, 0.000000, depth));
-
-  frame.append(getVertex(width, 0.000000, - minThickness));
-  frame.append(getVertex(width, height, - minThickness));
-  frame.append(getVertex(width, height, depth));
-
-  frame.append(getVertex(width, 0.000000, - minThickness));
-  frame.append(getVertex(width, height, depth));
-  frame.append(getVertex(width, 0.000000, depth));
-
-  frame.append(getVertex(0.000000, 0.000000, - minThickness));
-  frame.append(getVertex(0.000000, height, - minThickness));
-  frame.append(getVertex(width, height, - minThickness));
-
-  frame.append(getVertex(0.000000, 0.000000, - minThickness));
-  frame.append(getVertex(width, height, - minThickness));
-  frame.append(getVertex(width, 0.000000, - minThickness));
-
-  frame.append(getVertex(border, border, depth));
-  frame.append(getVertex(border, height - border, depth));
-  frame.append(getVertex(0.000000, height, depth));
-
-  frame.append(getVertex(border, border, depth));
-  frame.append(getVertex(0.000000, height, depth));
-  frame.append(getVertex(0.000000, 0.000000, depth));
-
-  frame.append(getVertex(width - border, height - border, depth));
-  frame.append(getVertex(width - border, border, depth));
-  frame.append(getVertex(width, 0.000000, depth));
-
-  frame.append(getVertex(width - border, height - border, depth));
-  frame.append(getVertex(width, 0.000000, depth));
-  frame.append(getVertex(width, height, depth));
-
-  frame.append(getVertex(border, height - border, depth));
-  frame.append(getVertex(width - border, height - border, depth));
-  frame.append(getVertex(width, height, depth));
-
-  frame.append(getVertex(border, height - border, depth));
-  frame.append(getVertex(width, height, depth));
-  frame.append(getVertex(0.000000, height, depth));
-
-  frame.append(getVertex(width - border, border, depth));
-  frame.append(getVertex(border, border, depth));
-  frame.append(getVertex(0.000000, 0.000000, depth));
-
-  frame.append(getVertex(width - border, border, depth));
-  frame.append(getVertex(0.000000, 0.000000, depth));
-  frame.append(getVertex(width, 0.000000, depth));
-
-  frame.append(getVertex(border + frameSlope, border + frameSlope, 0.000000));
-  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
-  frame.append(getVertex(border, height - border, depth));
-
-  frame.append(getVertex(border + frameSlope, border + frameSlope, 0.000000));
-  frame.append(getVertex(border, height - border, depth));
-  frame.append(getVertex(border, border, depth));
-
-  frame.append(getVertex(width - border - frameSlope, height - border - frameSlope, 0.000000));
-  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
-  frame.append(getVertex(width - border, border, depth));
-
-  frame.append(getVertex(width - border - frameSlope, height - border - frameSlope, 0.000000));
-  frame.append(getVertex(width - border, border, depth));
-  frame.append(getVertex(width - border, height - border, depth));
-
-  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
-  frame.append(getVertex(width - border - frameSlope, height - border - frameSlope, 0.000000));
-  frame.append(getVertex(width - border, height - border, depth));
-
-  frame.append(getVertex(border + frameSlope, height - border - frameSlope, 0.000000));
-  frame.append(getVertex(width - border, height - border, depth));
-  frame.append(getVertex(border, height - border, depth));
-
-  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
-  frame.append(getVertex(border + frameSlope, border + frameSlope, 0.000000));
-  frame.append(getVertex(border, border, depth));
-
-  frame.append(getVertex(width - border - frameSlope, border + frameSlope, 0.000000));
-  frame.append(getVertex(border, border, depth));
-  frame.append(getVertex(width - border, border, depth));
-
-  return frame;
-}
-
-QList<QVector3D> MainWindow::addHangers(const float &width, const float &height)
-{
-  int noOfHangers = settings->value("render/hangers").toInt();
-  float xDelta = (width / noOfHangers) / 2.0;
-  float x = xDelta - 4.5; // 4.5 is half the width of a hanger
-
-  QList<QVector3D> hangers;
-  for(int a = 0; a < noOfHangers; a++) {
-    hangers.append(getVertex(x + 3, height, 0.000000));
-    hangers.append(getVertex(x, height, 0.000000));
-    hangers.append(getVertex(x + 3, height + 3, 0.000000));
-
-    hangers.append(getVertex(x + 3, height + 3, 0.000000));
-    hangers.append(getVertex(x + 6, height + 3, 0.000000));
-    hangers.append(getVertex(x + 9, height, 0.000000));
-
-    hangers.append(getVertex(x + 9, height, 0.000000));
-    hangers.append(getVertex(x + 6, height, 0.000000));
-    hangers.append(getVertex(x + 5, height + 1, 0.000000));
-
-    hangers.append(getVertex(x + 4, height + 1, 0.000000));
-    hangers.append(getVertex(x + 3, height, 0.000000));
-    hangers.append(getVertex(x + 3, height + 3, 0.000000));
-
-    hangers.append(getVertex(x + 3, height + 3, 0.000000));
-    hangers.append(getVertex(x + 9, height, 0.000000));
-    hangers.append(getVertex(x + 5, height + 1, 0.000000));
-
-    hangers.append(getVertex(x + 3, height + 3, 0.000000));
-    hangers.append(getVertex(x + 5, height + 1, 0.000000));
-    hangers.append(getVertex(x + 4, height + 1, 0.000000));
-
-    hangers.append(getVertex(x + 3, height + 3, 2));
-    hangers.append(getVertex(x, height, 2));
-    hangers.append(getVertex(x + 3, height, 2));
-
-    hangers.append(getVertex(x + 3, height + 3, 2));
-    hangers.append(getVertex(x + 3, height, 2));
-    hangers.append(getVertex(x + 4, height + 1, 2));
-
-    hangers.append(getVertex(x + 9, height, 2));
-    hangers.append(getVertex(x + 6, height + 3, 2));
-    hangers.append(getVertex(x + 3, height + 3, 2));
-
-    hangers.append(getVertex(x + 5, height + 1, 2));
-    hangers.append(getVertex(x + 6, height, 2));
-    hangers.append(getVertex(x + 9, height, 2));
-
-    hangers.append(getVertex(x + 3, height + 3, 2));
-    hangers.append(getVertex(x + 4, height + 1, 2));
-    hangers.append(getVertex(x + 5, height + 1, 2));
-
-    hangers.append(getVertex(x + 5, height + 1, 2));
-    hangers.append(getVertex(x + 9, height, 2));
-    hangers.append(getVertex(x + 3, height + 3, 2));
-
-    hangers.append(getVertex(x + 5, height + 1, 0.000000));
-    hangers.append(getVertex(x + 6, height, 0.000000));
-    hangers.append(getVertex(x + 6, height, 2));
-
-    hangers.append(getVertex(x + 5, height + 1, 0.000000));
-    hangers.append(getVertex(x + 6, height, 2));
-    hangers.append(getVertex(x + 5, height + 1, 2));
-
-    hangers.append(getVertex(x + 9, height, 0.000000));
-    hangers.append(getVertex(x + 6, height + 3, 0.000000));
-    hangers.append(getVertex(x + 6, height + 3, 2));
-
-    hangers.append(getVertex(x + 9, height, 0.000000));
-    hangers.append(getVertex(x + 6, height + 3, 2));
-    hangers.append(getVertex(x + 9, height, 2));
-
-    hangers.append(getVertex(x + 3, height + 3, 0.000000));
-    hangers.append(getVertex(x, height, 0.000000));
-    hangers.append(getVertex(x, height, 2));
-
-    hangers.append(getVertex(x + 3, height + 3, 0.000000));
-    hangers.append(getVertex(x, height, 2));
-    hangers.append(getVertex(x + 3, height + 3, 2));
-
-    hangers.append(getVertex(x, height, 0.000000));
-    hangers.append(getVertex(x + 3, height, 0.000000));
-    hangers.append(getVertex(x + 3, height, 2));
-
-    hangers.append(getVertex(x, height, 0.000000));
-    hangers.append(getVertex(x + 3, height, 2));
-    hangers.append(getVertex(x, height, 2));
-
-    hangers.append(getVertex(x + 4, height + 1, 0.000000));
-    hangers.append(getVertex(x + 5, height + 1, 0.000000));
-    hangers.append(getVertex(x + 5, height + 1, 2));
-
-    hangers.append(getVertex(x + 4, height + 1, 0.000000));
-    hangers.append(getVertex(x + 5, height + 1, 2));
-    hangers.append(getVertex(x + 4, height + 1, 2));
-
-    hangers.append(getVertex(x + 6, height, 0.000000));
-    hangers.append(getVertex(x + 9, height, 0.000000));
-    hangers.append(getVertex(x + 9, height, 2));
-
-    hangers.append(getVertex(x + 6, height, 0.000000));
-    hangers.append(getVertex(x + 9, height, 2));
-    hangers.append(getVertex(x + 6, height, 2));
-
-    hangers.append(getVertex(x + 6, height + 3, 0.000000));
-    hangers.append(getVertex(x + 3, height + 3, 0.000000));
-    hangers.append(getVertex(x + 3, height + 3, 2));
-
-    hangers.append(getVertex(x + 6, height + 3, 0.000000));
-    hangers.append(getVertex(x + 3, height + 3, 2));
-    hangers.append(getVertex(x + 6, height + 3, 2));
-
-    hangers.append(getVertex(x + 3, height, 0.000000));
-    hangers.append(getVertex(x + 4, height + 1, 0.000000));
-    hangers.append(getVertex(x + 4, height + 1, 2));
-
-    hangers.append(getVertex(x + 3, height, 0.000000));
-    hangers.append(getVertex(x + 4, height + 1, 2));
-    hangers.append(getVertex(x + 3, height, 2));
-
-    // Move over to the next hanger placement
-    x += xDelta * 2;
+  renderQueue->setStatsFile(settings->value("main/statsFile", "").toString());
+  // All jobs share the render cache of the configured directory
+  QSharedPointer<RenderCache> renderCache = RenderCache::fromConfig(*settings);
+  for(auto &tile: jobs) {
+    tile.maxSize = job.maxSize;
+    renderQueue->addJob(tile, renderCache);
   }
-
-  return hangers;
-}
-
-QList<QVector3D> MainWindow::addStabilizer(const float &x, const float &height)
-{
-  float depth = height * 0.5;
-  float z;
-
-  QList<QVector3D> stabilizer;
-
-  double zDelta = (settings->value("render/permanentStabilizers", false).toBool()?1.0:0.0);
-  
-  // Front
-  z = settings->value("render/totalThickness").toFloat() - settings->value("render/minThickness").toFloat();
-  stabilizer.append(getVertex(x, 0.000000, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, 0.000000, z + depth));
-  stabilizer.append(getVertex(x, height, z + 3));
-                    
-  stabilizer.append(getVertex(x, height, z + 3));
-  stabilizer.append(getVertex(x, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height - 1, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x, height, z + 3));
-  stabilizer.append(getVertex(x, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, 0.000000, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + depth));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
-
-  stabilizer.append(getVertex(x + 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height, z + 3));
-
-  stabilizer.append(getVertex(x, height, z + 3));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height, z + 3));
-
-  stabilizer.append(getVertex(x, height, z + 3));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x, 0.000000, z + depth));
-  stabilizer.append(getVertex(x, 0.000000, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x, 0.000000, z + depth));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + depth));
-
-  stabilizer.append(getVertex(x, height, z + 3));
-  stabilizer.append(getVertex(x, 0.000000, z + depth));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + depth));
-
-  stabilizer.append(getVertex(x, height, z + 3));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + depth));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 3));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-  stabilizer.append(getVertex(x + 1, height, z));
-  stabilizer.append(getVertex(x, height, z));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-  stabilizer.append(getVertex(x, height, z));
-  stabilizer.append(getVertex(x, height - 1, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + 1, height, z));
-
-  stabilizer.append(getVertex(x, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + 1, height, z));
-  stabilizer.append(getVertex(x, height, z));
-
-  stabilizer.append(getVertex(x, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height, z));
-
-  stabilizer.append(getVertex(x, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height, z));
-  stabilizer.append(getVertex(x, height - 1, z));
-
-  stabilizer.append(getVertex(x + 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + 1, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-
-  stabilizer.append(getVertex(x + 1, height, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-  stabilizer.append(getVertex(x + 1, height, z));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-  stabilizer.append(getVertex(x + 1, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height - 1, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-  stabilizer.append(getVertex(x, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height - 1, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, 0.000000, z + 1 - zDelta));
-  stabilizer.append(getVertex(x, height - 1, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + 1, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1 - zDelta));
-
-  stabilizer.append(getVertex(x, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z + 1 - zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z + 1 - zDelta));
-
-  // Back
-  z = (settings->value("render/minThickness").toFloat() * -1);
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - depth));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x, height, z - 3));
-  stabilizer.append(getVertex(x, 0.000000, z - depth));
-  stabilizer.append(getVertex(x, 0.000000, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height, z - 3));
-
-  stabilizer.append(getVertex(x, 0.000000, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height, z - 3));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
-  stabilizer.append(getVertex(x, height, z - 3));
-  stabilizer.append(getVertex(x, height, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
-  stabilizer.append(getVertex(x, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - depth));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, 0.000000, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - depth));
-  stabilizer.append(getVertex(x, 0.000000, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, 0.000000, z - depth));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - depth));
-  stabilizer.append(getVertex(x, 0.000000, z - depth));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 3));
-  stabilizer.append(getVertex(x, 0.000000, z - depth));
-  stabilizer.append(getVertex(x, height, z - 3));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height - 1, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-  stabilizer.append(getVertex(x, height - 1, z));
-  stabilizer.append(getVertex(x, height, z));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-  stabilizer.append(getVertex(x, height, z));
-  stabilizer.append(getVertex(x + 1, height, z));
-
-  stabilizer.append(getVertex(x, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height - 1, z));
-
-  stabilizer.append(getVertex(x, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height - 1, z));
-  stabilizer.append(getVertex(x, height, z));
-
-  stabilizer.append(getVertex(x + 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height, z));
-
-  stabilizer.append(getVertex(x + 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height, z));
-  stabilizer.append(getVertex(x + 1, height, z));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height, z));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height, z));
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-  stabilizer.append(getVertex(x, height - 1, z));
-  stabilizer.append(getVertex(x, height - 1, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z));
-  stabilizer.append(getVertex(x, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height - 1, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height, z));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z));
-
-  stabilizer.append(getVertex(x, 0.000000, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), 0.000000, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + (border < 4?border:4) - 1, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height - 1, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + 1, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, 0.000000, z - 1 + zDelta));
-
-  stabilizer.append(getVertex(x + (border < 4?border:4), height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x + 1, height - 1, z - 1 + zDelta));
-  stabilizer.append(getVertex(x, 0.000000, z - 1 + zDelta));
-
-  return stabilizer;
 }
 
-int MainWindow::getPixel(const QImage &image, const int &x, const int &y)
+void MainWindow::updateEstimate()
 {
-  return image.pixelColor(x, image.height() - 1 - y).red();
-}
-
-QVector3D MainWindow::getVertex(float x, float y, float z, const bool &scale)
-{
-  float add = 0.0;
-  if(scale) {
-    x = x * widthFactor;
-    y = y * widthFactor;
-    //z = z * widthFactor;
-    add = border;
+  // Only the image header is read, so this is cheap enough to run on every
+  // step of a slider
+  if(estimateLabel == nullptr) {
+    return;
   }
-  return QVector3D(x + add, y + add, z);
+  RenderJob job;
+  job.inputFile = inputLineEdit->text();
+  job.addOutputs(outputLineEdit->text(), settings->value("export/stlFormat", "binary").toString(),
+                 Exporter::parseFormats(settings->value("export/additionalFormats", "").toString()));
+  job.renderSettings = RenderSettings::fromConfig();
+  estimateLabel->setText(RenderEstimate::forJob(job, calibration).summary());
 }
 
 void MainWindow::inputSelect()
@@ -979,25 +285,12 @@ void MainWindow::inputSelect()
 
 void MainWindow::outputSelect()
 {
-  QString selectedFile = QFileDialog::getSaveFileName(this, tr("Enter output file"), QFileInfo(outputLineEdit->text()).absolutePath(), "*.stl");
+  QString suffix = Exporter::suffix(settings->value("export/stlFormat", "binary").toString());
+  QString selectedFile = QFileDialog::getSaveFileName(this, tr("Enter output file"), QFileInfo(outputLineEdit->text()).absolutePath(), "*." + suffix);
   if(selectedFile != QByteArray()) {
-    if(selectedFile.right(4).toLower() != ".stl") {
-      selectedFile.append(".stl");
+    if(QFileInfo(selectedFile).suffix().toLower() != suffix) {
+      selectedFile.append("." + suffix);
     }
     outputLineEdit->setText(selectedFile);
   }
 }
-
-void MainWindow::enableUi()
-{
-  inputButton->setEnabled(true);
-  outputButton->setEnabled(true);
-  renderButton->setEnabled(true);
-}
-
-void MainWindow::disableUi()
-{
-  inputButton->setEnabled(false);
-  outputButton->setEnabled(false);
-  renderButton->setEnabled(false);
-}
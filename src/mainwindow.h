@@ -32,10 +32,12 @@
 #include <QAction>
 #include <QMenu>
 #include <QMenuBar>
-#include <QProgressBar>
 #include <QPushButton>
+#include <QLabel>
 
 #include "slider.h"
+#include "renderqueue.h"
+#include "renderestimate.h"
 
 class MainWindow : public QMainWindow
 {
@@ -56,17 +58,12 @@ private slots:
   void showPreferences();
   void inputSelect();
   void outputSelect();
+  void queueRender();
+  void updateEstimate();
   
 private:
-  void enableUi();
-  void disableUi();
-  void createMesh();
-  void exportStl();
-  int getPixel(const QImage &image, const int &x, const int &y);
   void createActions();
   void createMenus();
-  //QByteArray stlString;
-  QList<QVector3D> polygons;
   Slider *minThicknessSlider;
   //QLineEdit *minThicknessLineEdit;
   Slider *totalThicknessSlider;
@@ -78,9 +75,12 @@ private:
   QPushButton *inputButton;
   QLineEdit *inputLineEdit;
   QPushButton *outputButton;
-  QProgressBar *renderProgress;
   QPushButton *renderButton;
+  RenderQueue *renderQueue;
   QLineEdit *outputLineEdit;
+  // Null until the window is set up, as the preferences may be shown first
+  QLabel *estimateLabel = nullptr;
+  RenderCalibration calibration;
   QAction *quitAct;
   QAction *preferencesAct;
   QAction *aboutAct;
@@ -88,16 +88,7 @@ private:
   QMenu *optionsMenu;
   QMenu *helpMenu;
   QMenuBar *menuBar;
-
-  float depthFactor = -1.0;
-  float widthFactor = -1.0;
-  float border = -1.0;
-  
-  QVector3D getVertex(float x, float y, float z, const bool &scale = false);
-  
-  QList<QVector3D> addFrame(const float &width, const float &height);
-  QList<QVector3D> addHangers(const float &width, const float &height);
-  QList<QVector3D> addStabilizer(const float &x, const float &height);
+  QString traceFile;
 };
 
 #endif // __MAINWINDOW_H__
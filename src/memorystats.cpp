@@ -0,0 +1,250 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            memorystats.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <atomic>
+#if defined(COUNT_HEAP) && defined(__GLIBC__)
+#include <errno.h>
+#include <stdlib.h>
+#include <malloc.h>
+#endif
+
+#include "memorystats.h"
+
+namespace {
+struct Counters
+{
+  std::atomic<qint64> allocations;
+  std::atomic<qint64> allocatedBytes;
+  std::atomic<qint64> liveBytes;
+  std::atomic<qint64> peakBytes;
+};
+
+// Zero initialized before any code runs, so the allocations made while the
+// process starts up are counted as well
+Counters heapCounters;
+Counters bufferCounters[MemoryStats::BufferCount];
+
+inline void allocated(Counters &counters, const qint64 &bytes)
+{
+  counters.allocations.fetch_add(1, std::memory_order_relaxed);
+  counters.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+  qint64 live = counters.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  qint64 peak = counters.peakBytes.load(std::memory_order_relaxed);
+  while(live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+inline void released(Counters &counters, const qint64 &bytes)
+{
+  counters.liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+MemoryUsage usage(const Counters &counters)
+{
+  MemoryUsage usage;
+  usage.allocations = counters.allocations.load(std::memory_order_relaxed);
+  usage.allocatedBytes = counters.allocatedBytes.load(std::memory_order_relaxed);
+  usage.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+  usage.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+  return usage;
+}
+
+void resetPeak(Counters &counters)
+{
+  counters.peakBytes.store(counters.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+}
+
+#if defined(COUNT_HEAP) && defined(__GLIBC__)
+// Replaces the allocation functions for the whole process, the Qt libraries
+// included, and forwards them to the glibc allocator. Sizes are the usable
+// sizes of the blocks, so freeing a block subtracts what was added. Every
+// thread updates the same counters, which slows down allocation heavy
+// threads, so this is only built into the benchmarks and into builds
+// configured with 'qmake CONFIG+=countheap'. Allocations glibc makes
+// internally without going through these aren't counted.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void *__libc_valloc(size_t size);
+void *__libc_pvalloc(size_t size);
+void __libc_free(void *pointer);
+
+static inline void *counted(void *pointer)
+{
+  if(pointer != nullptr) {
+    allocated(heapCounters, malloc_usable_size(pointer));
+  }
+  return pointer;
+}
+
+void *malloc(size_t size) __THROW
+{
+  return counted(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size) __THROW
+{
+  return counted(__libc_calloc(count, size));
+}
+
+void *realloc(void *pointer, size_t size) __THROW
+{
+  qint64 previous = (pointer != nullptr?malloc_usable_size(pointer):0);
+  void *result = __libc_realloc(pointer, size);
+  // A failed realloc leaves the block alone, a zero size frees it
+  if(result != nullptr || size == 0) {
+    released(heapCounters, previous);
+    counted(result);
+  }
+  return result;
+}
+
+void *reallocarray(void *pointer, size_t count, size_t size) __THROW
+{
+  size_t bytes = 0;
+  if(__builtin_mul_overflow(count, size, &bytes)) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  return realloc(pointer, bytes);
+}
+
+void free(void *pointer) __THROW
+{
+  if(pointer != nullptr) {
+    released(heapCounters, malloc_usable_size(pointer));
+  }
+  __libc_free(pointer);
+}
+
+void *memalign(size_t alignment, size_t size) __THROW
+{
+  return counted(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size) __THROW
+{
+  return counted(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) __THROW
+{
+  if(alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  void *result = counted(__libc_memalign(alignment, size));
+  if(result == nullptr) {
+    return ENOMEM;
+  }
+  *pointer = result;
+  return 0;
+}
+
+void *valloc(size_t size) __THROW
+{
+  return counted(__libc_valloc(size));
+}
+
+void *pvalloc(size_t size) __THROW
+{
+  return counted(__libc_pvalloc(size));
+}
+}
+#endif
+
+bool MemoryStats::isCountingHeap()
+{
+#if defined(COUNT_HEAP) && defined(__GLIBC__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+MemoryUsage MemoryStats::heap()
+{
+  return usage(heapCounters);
+}
+
+MemoryUsage MemoryStats::buffer(const Buffer &buffer)
+{
+  return usage(bufferCounters[buffer]);
+}
+
+QString MemoryStats::name(const Buffer &buffer)
+{
+  switch(buffer) {
+  case Image:
+    return "image";
+  case Heightmap:
+    return "heightmap";
+  case Mesh:
+    return "mesh";
+  case Geometry:
+    return "geometry";
+  case Export:
+    return "export";
+  default:
+    return QString();
+  }
+}
+
+void MemoryStats::track(const Buffer &buffer, const qint64 &bytes)
+{
+  if(bytes > 0) {
+    allocated(bufferCounters[buffer], bytes);
+  } else if(bytes < 0) {
+    released(bufferCounters[buffer], -bytes);
+  }
+}
+
+void MemoryStats::resetPeaks()
+{
+  resetPeak(heapCounters);
+  for(auto &counters: bufferCounters) {
+    resetPeak(counters);
+  }
+}
+
+TrackedBuffer::TrackedBuffer(const MemoryStats::Buffer &buffer, const qint64 &bytes)
+  : buffer(buffer)
+{
+  resize(bytes);
+}
+
+TrackedBuffer::~TrackedBuffer()
+{
+  resize(0);
+}
+
+void TrackedBuffer::resize(const qint64 &bytes)
+{
+  MemoryStats::track(buffer, bytes - this->bytes);
+  this->bytes = bytes;
+}
@@ -0,0 +1,92 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            memorystats.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __MEMORYSTATS_H__
+#define __MEMORYSTATS_H__
+
+#include <QString>
+
+// Memory handed out and in use, in bytes. The peak is the most in use at
+// once since the last MemoryStats::resetPeaks().
+struct MemoryUsage
+{
+  qint64 allocations = 0;
+  qint64 allocatedBytes = 0;
+  qint64 liveBytes = 0;
+  qint64 peakBytes = 0;
+};
+
+// Memory accounting for finding out where the memory of a render goes. The
+// large buffers of the pipeline are accounted for by name where they are
+// created. Builds with COUNT_HEAP defined, such as the benchmarks, also
+// count every malloc of the process with glibc, which includes operator new
+// as well as the QImage, QVector and QByteArray buffers. That costs a few
+// atomic operations on shared counters per allocation, so it is left out
+// of regular builds. Both are process wide, so with several jobs running at
+// once they include the other jobs as well.
+class MemoryStats
+{
+public:
+  enum Buffer {
+    // Decoded, scaled, cropped and grayscale copies of the input image
+    Image,
+    // Prepared heights and grid topology kept by a lithophane
+    Heightmap,
+    // Vertices and indices of rendered and welded meshes
+    Mesh,
+    // Frame, stabilizer, hanger and lip triangle lists
+    Geometry,
+    // Blocks and compressed chunks of the exporters
+    Export,
+    BufferCount
+  };
+
+  static bool isCountingHeap();
+  static MemoryUsage heap();
+  static MemoryUsage buffer(const Buffer &buffer);
+  static QString name(const Buffer &buffer);
+  // Negative sizes release memory
+  static void track(const Buffer &buffer, const qint64 &bytes);
+  // Starts new heap and buffer peaks from the memory in use now
+  static void resetPeaks();
+};
+
+// Accounts for a buffer of the pipeline for as long as it is in scope
+class TrackedBuffer
+{
+public:
+  TrackedBuffer(const MemoryStats::Buffer &buffer, const qint64 &bytes = 0);
+  TrackedBuffer(const TrackedBuffer &) = delete;
+  TrackedBuffer &operator=(const TrackedBuffer &) = delete;
+  ~TrackedBuffer();
+  void resize(const qint64 &bytes);
+
+private:
+  MemoryStats::Buffer buffer;
+  qint64 bytes = 0;
+};
+
+#endif // __MEMORYSTATS_H__
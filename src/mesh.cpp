@@ -0,0 +1,166 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            mesh.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <string.h>
+#include <unordered_map>
+
+#include "mesh.h"
+
+namespace {
+struct VertexKey
+{
+  quint32 bits[3];
+  bool operator==(const VertexKey &other) const
+  {
+    return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+  }
+};
+
+struct VertexKeyHash
+{
+  size_t operator()(const VertexKey &key) const
+  {
+    size_t hash = key.bits[0];
+    hash = hash * 0x9e3779b97f4a7c15ULL + key.bits[1];
+    hash = hash * 0x9e3779b97f4a7c15ULL + key.bits[2];
+    return hash ^ (hash >> 29);
+  }
+};
+}
+
+Mesh::Mesh()
+{
+}
+
+Mesh::~Mesh()
+{
+}
+
+void Mesh::clear()
+{
+  vertices.clear();
+  indices.clear();
+  isWelded = false;
+  gridWidth = 0;
+  gridHeight = 0;
+}
+
+bool Mesh::isEmpty() const
+{
+  return indices.isEmpty();
+}
+
+int Mesh::facetCount() const
+{
+  return indices.length() / 3;
+}
+
+QVector3D Mesh::vertex(const int &index) const
+{
+  return vertices.at(indices.at(index));
+}
+
+void Mesh::appendTriangles(const QList<QVector3D> &triangles)
+{
+  // Unshared vertices, three per facet, in the order they were given
+  quint32 first = vertices.length();
+  isWelded = false;
+  vertices.reserve(vertices.length() + triangles.length());
+  indices.reserve(indices.length() + triangles.length());
+  for(int a = 0; a < triangles.length(); ++a) {
+    vertices.append(triangles.at(a));
+    indices.append(first + a);
+  }
+}
+
+void Mesh::append(const Mesh &other)
+{
+  quint32 first = vertices.length();
+  isWelded = false;
+  vertices.reserve(vertices.length() + other.vertices.length());
+  indices.reserve(indices.length() + other.indices.length());
+  vertices.append(other.vertices);
+  for(const auto &index: other.indices) {
+    indices.append(first + index);
+  }
+}
+
+qint64 Mesh::memory() const
+{
+  return ((qint64)vertices.capacity() * sizeof(QVector3D)) + ((qint64)indices.capacity() * sizeof(quint32));
+}
+
+Mesh Mesh::welded() const
+{
+  // Merges vertices with identical coordinates and drops unused ones. The
+  // frame, stabilizers and hangers are built from unshared vertices, the
+  // indexed export formats want them shared with their neighbours. Vertices
+  // keep their relative order, so the heightmap grid stays in front unless
+  // one of its vertices is dropped or merged with another.
+  if(isWelded) {
+    return *this;
+  }
+  Mesh mesh;
+  mesh.isWelded = true;
+  QVector<char> used(vertices.length(), 0);
+  for(const auto &index: indices) {
+    used[index] = 1;
+  }
+  mesh.vertices.reserve(vertices.length());
+  QVector<quint32> remap(vertices.length(), 0);
+  std::unordered_map<VertexKey, quint32, VertexKeyHash> unique;
+  unique.reserve(vertices.length());
+  for(int a = 0; a < vertices.length(); ++a) {
+    if(!used.at(a)) {
+      continue;
+    }
+    const QVector3D &vertex = vertices.at(a);
+    // Adding zero turns -0.0 into 0.0 so they weld together
+    float coordinates[3] = { vertex.x() + 0.0f, vertex.y() + 0.0f, vertex.z() + 0.0f };
+    VertexKey key;
+    memcpy(key.bits, coordinates, sizeof(key.bits));
+    auto inserted = unique.emplace(key, (quint32)mesh.vertices.length());
+    if(inserted.second) {
+      mesh.vertices.append(vertex);
+    }
+    remap[a] = inserted.first->second;
+  }
+  mesh.indices.resize(indices.length());
+  for(int a = 0; a < indices.length(); ++a) {
+    mesh.indices[a] = remap.at(indices.at(a));
+  }
+  qint64 gridCount = (qint64)gridWidth * gridHeight;
+  bool gridKept = (gridCount > 0 && gridCount <= vertices.length());
+  for(int a = 0; gridKept && a < gridCount; ++a) {
+    gridKept = (used.at(a) && remap.at(a) == (quint32)a);
+  }
+  if(gridKept) {
+    mesh.gridWidth = gridWidth;
+    mesh.gridHeight = gridHeight;
+  }
+
+  return mesh;
+}
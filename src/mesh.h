@@ -0,0 +1,64 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            mesh.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __MESH_H__
+#define __MESH_H__
+
+#include <QList>
+#include <QVector>
+#include <QVector3D>
+
+// Indexed triangle mesh. Every three consecutive indices make up one facet.
+// Vertices can be shared between facets, which is what allows the
+// heightmap grid to be built once and reused across renders.
+class Mesh
+{
+public:
+  Mesh();
+  ~Mesh();
+  void clear();
+  bool isEmpty() const;
+  int facetCount() const;
+  QVector3D vertex(const int &index) const;
+  void appendTriangles(const QList<QVector3D> &triangles);
+  // Appends the facets of another mesh along with its vertices. The heightmap
+  // grid of the other mesh is not kept.
+  void append(const Mesh &other);
+  Mesh welded() const;
+  // Bytes held by the vertex and index buffers
+  qint64 memory() const;
+
+  QVector<QVector3D> vertices;
+  QVector<quint32> indices;
+  // Set on meshes returned by welded(), so welding them again is free
+  bool isWelded = false;
+  // If set, the first gridWidth * gridHeight vertices are the heightmap grid
+  // in row-major order, bottom row first
+  int gridWidth = 0;
+  int gridHeight = 0;
+};
+
+#endif // __MESH_H__
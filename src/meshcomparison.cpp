@@ -0,0 +1,214 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            meshcomparison.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include <QCryptographicHash>
+
+#include "meshcomparison.h"
+
+// Facets hashed per call to addData()
+constexpr int hashBatch = 4096;
+// Centroid cells are never smaller than this, so exact comparisons don't
+// end up with a cell per facet
+constexpr float minCellSize = 0.01;
+// Cell coordinates are packed into 21 bits each. Cells wrapping around
+// only add candidates, every candidate is compared corner by corner.
+constexpr int cellBits = 21;
+constexpr quint64 cellMask = (1ULL << cellBits) - 1;
+
+namespace {
+struct CellEntry
+{
+  quint64 key;
+  quint32 facet;
+  bool operator<(const CellEntry &other) const
+  {
+    return key < other.key || (key == other.key && facet < other.facet);
+  }
+};
+
+QVector3D centroid(const Mesh &mesh, const qint64 &facet)
+{
+  return (mesh.vertex(facet * 3) + mesh.vertex(facet * 3 + 1) + mesh.vertex(facet * 3 + 2)) / 3.0;
+}
+
+quint64 cellKey(const qint64 &x, const qint64 &y, const qint64 &z)
+{
+  return (((quint64)x & cellMask) << (cellBits * 2)) | (((quint64)y & cellMask) << cellBits) | ((quint64)z & cellMask);
+}
+
+// Tries the three rotations of the corners, which all describe the same
+// facet with the same winding
+bool matchFacet(const Mesh &mesh, const qint64 &facet, const Mesh &reference,
+                const qint64 &referenceFacet, const float &tolerance, float &deviation)
+{
+  QVector3D corners[3];
+  QVector3D referenceCorners[3];
+  for(int a = 0; a < 3; ++a) {
+    corners[a] = mesh.vertex(facet * 3 + a);
+    referenceCorners[a] = reference.vertex(referenceFacet * 3 + a);
+  }
+  for(int rotation = 0; rotation < 3; ++rotation) {
+    float largest = 0.0;
+    for(int a = 0; a < 3 && largest <= tolerance; ++a) {
+      QVector3D difference = corners[a] - referenceCorners[(a + rotation) % 3];
+      largest = std::max({largest, fabsf(difference.x()), fabsf(difference.y()), fabsf(difference.z())});
+    }
+    if(largest <= tolerance) {
+      deviation = largest;
+      return true;
+    }
+  }
+  return false;
+}
+}
+
+MeshComparison MeshComparison::compare(const Mesh &mesh, const Mesh &reference,
+                                       const float &tolerance)
+{
+  MeshComparison comparison;
+  comparison.tolerance = tolerance;
+  comparison.facets = mesh.facetCount();
+  comparison.referenceFacets = reference.facetCount();
+  if(comparison.facets == comparison.referenceFacets && hash(mesh) == hash(reference)) {
+    comparison.identical = true;
+    return comparison;
+  }
+
+  // Facets at the same position in both meshes are paired up front, which
+  // leaves only the reordered and changed facets for the grid lookups
+  std::vector<char> matched(comparison.facets, 0);
+  std::vector<char> used(comparison.referenceFacets, 0);
+  qint64 common = std::min(comparison.facets, comparison.referenceFacets);
+  float maxDeviation = 0.0;
+#pragma omp parallel for reduction(max:maxDeviation)
+  for(qint64 a = 0; a < common; ++a) {
+    float deviation = 0.0;
+    if(matchFacet(mesh, a, reference, a, tolerance, deviation)) {
+      matched[a] = 1;
+      used[a] = 1;
+      maxDeviation = std::max(maxDeviation, deviation);
+    }
+  }
+
+  // Corners within the tolerance put the centroids within the tolerance, so
+  // a facet's counterpart is always in one of the neighbouring cells
+  float cellSize = std::max(tolerance * 2, minCellSize);
+  std::vector<CellEntry> cells;
+  for(qint64 a = 0; a < comparison.referenceFacets; ++a) {
+    if(!used[a]) {
+      QVector3D center = centroid(reference, a) / cellSize;
+      cells.push_back({ cellKey(floorf(center.x()), floorf(center.y()), floorf(center.z())), (quint32)a });
+    }
+  }
+  std::sort(cells.begin(), cells.end());
+  for(qint64 a = 0; a < comparison.facets && !cells.empty(); ++a) {
+    if(matched[a]) {
+      continue;
+    }
+    QVector3D center = centroid(mesh, a) / cellSize;
+    qint64 x = floorf(center.x());
+    qint64 y = floorf(center.y());
+    qint64 z = floorf(center.z());
+    for(int b = 0; b < 27 && !matched[a]; ++b) {
+      CellEntry first = { cellKey(x + b % 3 - 1, y + (b / 3) % 3 - 1, z + b / 9 - 1), 0 };
+      for(auto entry = std::lower_bound(cells.begin(), cells.end(), first);
+          entry != cells.end() && entry->key == first.key; ++entry) {
+        float deviation = 0.0;
+        if(!used[entry->facet] && matchFacet(mesh, a, reference, entry->facet, tolerance, deviation)) {
+          matched[a] = 1;
+          used[entry->facet] = 1;
+          maxDeviation = std::max(maxDeviation, deviation);
+          break;
+        }
+      }
+    }
+  }
+
+  comparison.maxDeviation = maxDeviation;
+  for(qint64 a = comparison.facets - 1; a >= 0; --a) {
+    if(!matched[a]) {
+      comparison.unmatchedFacets++;
+      comparison.firstMismatch = centroid(mesh, a);
+    }
+  }
+  for(qint64 a = comparison.referenceFacets - 1; a >= 0; --a) {
+    if(!used[a]) {
+      comparison.missingFacets++;
+      if(comparison.unmatchedFacets == 0) {
+        comparison.firstMismatch = centroid(reference, a);
+      }
+    }
+  }
+
+  return comparison;
+}
+
+QByteArray MeshComparison::hash(const Mesh &mesh)
+{
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  std::vector<float> batch;
+  batch.reserve(hashBatch * 9);
+  for(int a = 0; a < mesh.indices.length(); ++a) {
+    // Adding zero turns -0.0 into 0.0, the same way welding does
+    const QVector3D &vertex = mesh.vertices.at(mesh.indices.at(a));
+    batch.push_back(vertex.x() + 0.0f);
+    batch.push_back(vertex.y() + 0.0f);
+    batch.push_back(vertex.z() + 0.0f);
+    if(batch.size() == (size_t)hashBatch * 9 || a == mesh.indices.length() - 1) {
+      hash.addData((const char *)batch.data(), batch.size() * sizeof(float));
+      batch.clear();
+    }
+  }
+  return hash.result().toHex();
+}
+
+bool MeshComparison::isIdentical() const
+{
+  return identical;
+}
+
+bool MeshComparison::isEquivalent() const
+{
+  return identical || (unmatchedFacets == 0 && missingFacets == 0);
+}
+
+QString MeshComparison::summary() const
+{
+  if(identical) {
+    return QString::number(facets) + " facets, identical";
+  }
+  if(isEquivalent()) {
+    return QString::number(facets) + " facets, equivalent within " + QString::number(tolerance) +
+      " mm, largest deviation " + QString::number(maxDeviation) + " mm";
+  }
+  return QString::number(unmatchedFacets) + " of " + QString::number(facets) + " facets unmatched, " +
+    QString::number(missingFacets) + " of " + QString::number(referenceFacets) +
+    " reference facets missing, first at (" + QString::number(firstMismatch.x()) + ", " +
+    QString::number(firstMismatch.y()) + ", " + QString::number(firstMismatch.z()) + ")";
+}
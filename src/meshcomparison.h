@@ -0,0 +1,69 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            meshcomparison.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __MESHCOMPARISON_H__
+#define __MESHCOMPARISON_H__
+
+#include <QByteArray>
+#include <QString>
+#include <QVector3D>
+
+#include "mesh.h"
+
+// Compares a mesh against a reference mesh, first exactly and then
+// geometrically. The geometric comparison pairs up facets whose corners are
+// within the tolerance of each other, in any facet order and starting at
+// any corner, as long as the winding is the same. Facets are looked up in a
+// grid of their centroids, so the comparison stays linear in the facets.
+class MeshComparison
+{
+public:
+  static MeshComparison compare(const Mesh &mesh, const Mesh &reference,
+                                const float &tolerance = 0.001);
+  // SHA-256 of the facet corners in facet order. Meshes with the same
+  // facets hash the same whether their vertices are shared or not.
+  static QByteArray hash(const Mesh &mesh);
+  // Bit for bit the same facets in the same order
+  bool isIdentical() const;
+  // The same facets within the tolerance, in any order
+  bool isEquivalent() const;
+  QString summary() const;
+
+  qint64 facets = 0;
+  qint64 referenceFacets = 0;
+  bool identical = false;
+  // Facets of the mesh without a counterpart in the reference
+  qint64 unmatchedFacets = 0;
+  // Facets of the reference without a counterpart in the mesh
+  qint64 missingFacets = 0;
+  // Largest distance along any axis between paired corners in mm
+  float maxDeviation = 0.0;
+  // Centroid of the first unmatched facet, if any
+  QVector3D firstMismatch;
+  float tolerance = 0.0;
+};
+
+#endif // __MESHCOMPARISON_H__
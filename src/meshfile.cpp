@@ -0,0 +1,187 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            meshfile.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <string.h>
+
+#include "meshfile.h"
+
+static const char meshFileMagic[8] = { 'L', 'I', 'T', 'H', 'M', 'E', 'S', 'H' };
+constexpr quint32 meshFileVersion = 1;
+
+static_assert(sizeof(MeshFileHeader) == 64, "MeshFileHeader must be 64 bytes");
+static_assert(sizeof(QVector3D) == 3 * sizeof(float), "QVector3D is expected to be packed");
+
+MeshFile::MeshFile(const QString &filename) : file(filename)
+{
+}
+
+MeshFile::~MeshFile()
+{
+  file.close();
+}
+
+bool MeshFile::open()
+{
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+  error = "Mesh files can only be used on little endian machines.";
+  return false;
+#endif
+  if(!file.open(QIODevice::ReadOnly)) {
+    error = "File could not be opened.";
+    return false;
+  }
+  if(file.size() < (qint64)sizeof(MeshFileHeader)) {
+    error = "File is too small to be a mesh file.";
+    return false;
+  }
+  data = file.map(0, file.size());
+  if(data == nullptr) {
+    error = "File could not be mapped.";
+    return false;
+  }
+  header = (const MeshFileHeader *)data;
+  // Only the header is checked, the tables are used as they are
+  quint64 vertexBytes = (quint64)header->vertexCount * sizeof(QVector3D);
+  quint64 indexBytes = (quint64)header->indexCount * sizeof(quint32);
+  if(memcmp(header->magic, meshFileMagic, sizeof(meshFileMagic)) != 0 ||
+     header->version != meshFileVersion || header->vertexFormat != 0) {
+    error = "Not a supported mesh file.";
+  } else if(header->fileSize != (quint64)file.size() ||
+            header->vertexOffset % 4 != 0 || header->indexOffset % 4 != 0 ||
+            header->vertexOffset < sizeof(MeshFileHeader) ||
+            header->vertexOffset + vertexBytes > header->fileSize ||
+            header->indexOffset + indexBytes > header->fileSize ||
+            header->indexCount % 3 != 0) {
+    error = "Mesh file is truncated or corrupt.";
+  } else if((header->flags & Heightmap) &&
+            (quint64)header->gridWidth * header->gridHeight > header->vertexCount) {
+    error = "Mesh file heightmap is larger than its vertex table.";
+  }
+  if(!error.isEmpty()) {
+    header = nullptr;
+    return false;
+  }
+
+  return true;
+}
+
+QString MeshFile::errorString() const
+{
+  return error;
+}
+
+int MeshFile::vertexCount() const
+{
+  return (header != nullptr?header->vertexCount:0);
+}
+
+int MeshFile::indexCount() const
+{
+  return (header != nullptr?header->indexCount:0);
+}
+
+int MeshFile::gridWidth() const
+{
+  return (header != nullptr && (header->flags & Heightmap)?header->gridWidth:0);
+}
+
+int MeshFile::gridHeight() const
+{
+  return (header != nullptr && (header->flags & Heightmap)?header->gridHeight:0);
+}
+
+const QVector3D *MeshFile::vertices() const
+{
+  return (header != nullptr?(const QVector3D *)(data + header->vertexOffset):nullptr);
+}
+
+const quint32 *MeshFile::indices() const
+{
+  return (header != nullptr?(const quint32 *)(data + header->indexOffset):nullptr);
+}
+
+Mesh MeshFile::mesh() const
+{
+  Mesh mesh;
+  if(header == nullptr) {
+    return mesh;
+  }
+  // Indices pointing outside the vertex table would make the exporters read
+  // out of bounds, so they are checked while copying
+  const quint32 *fileIndices = indices();
+  for(quint32 a = 0; a < header->indexCount; ++a) {
+    if(fileIndices[a] >= header->vertexCount) {
+      return mesh;
+    }
+  }
+  mesh.vertices.resize(header->vertexCount);
+  memcpy(mesh.vertices.data(), vertices(), header->vertexCount * sizeof(QVector3D));
+  mesh.indices.resize(header->indexCount);
+  memcpy(mesh.indices.data(), fileIndices, header->indexCount * sizeof(quint32));
+  mesh.gridWidth = gridWidth();
+  mesh.gridHeight = gridHeight();
+
+  return mesh;
+}
+
+bool MeshFile::write(const Mesh &mesh, const QString &filename)
+{
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+  return false;
+#endif
+  MeshFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, meshFileMagic, sizeof(meshFileMagic));
+  header.version = meshFileVersion;
+  header.vertexFormat = 0;
+  header.vertexCount = mesh.vertices.length();
+  header.indexCount = mesh.indices.length();
+  if(mesh.gridWidth > 0 && mesh.gridHeight > 0) {
+    header.flags |= Heightmap;
+    header.gridWidth = mesh.gridWidth;
+    header.gridHeight = mesh.gridHeight;
+  }
+  // The vertex table is 12 bytes per vertex, so the index buffer following
+  // it stays 4 byte aligned without padding
+  qint64 vertexBytes = (qint64)header.vertexCount * sizeof(QVector3D);
+  qint64 indexBytes = (qint64)header.indexCount * sizeof(quint32);
+  header.vertexOffset = sizeof(MeshFileHeader);
+  header.indexOffset = header.vertexOffset + vertexBytes;
+  header.fileSize = header.indexOffset + indexBytes;
+
+  // Written front to back in one pass without seeking
+  QFile meshFile(filename);
+  if(!meshFile.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  bool success = (meshFile.write((const char *)&header, sizeof(header)) == (qint64)sizeof(header) &&
+                  meshFile.write((const char *)mesh.vertices.constData(), vertexBytes) == vertexBytes &&
+                  meshFile.write((const char *)mesh.indices.constData(), indexBytes) == indexBytes &&
+                  meshFile.flush());
+  meshFile.close();
+
+  return success;
+}
@@ -0,0 +1,92 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            meshfile.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __MESHFILE_H__
+#define __MESHFILE_H__
+
+#include <QFile>
+#include <QString>
+#include <QVector3D>
+
+#include "mesh.h"
+
+// Native binary mesh file (.lmesh). All fields are little endian and the
+// file is laid out so it can be memory mapped and used without parsing:
+//
+//   header         64 bytes, see MeshFileHeader
+//   vertex table   vertexCount * 3 floats (x, y, z)
+//   index buffer   indexCount 32 bit indices, three per facet
+//
+// If the heightmap flag is set, the first gridWidth * gridHeight vertices
+// are the heightmap grid in row-major order, bottom row first.
+struct MeshFileHeader
+{
+  char magic[8];
+  quint32 version;
+  quint32 flags;
+  // 0 = 32 bit float x, y, z per vertex
+  quint32 vertexFormat;
+  quint32 vertexCount;
+  quint32 indexCount;
+  quint32 gridWidth;
+  quint32 gridHeight;
+  quint32 reserved;
+  quint64 vertexOffset;
+  quint64 indexOffset;
+  quint64 fileSize;
+};
+
+class MeshFile
+{
+public:
+  enum Flags {
+    Heightmap = 0x1
+  };
+
+  MeshFile(const QString &filename);
+  ~MeshFile();
+  bool open();
+  QString errorString() const;
+  int vertexCount() const;
+  int indexCount() const;
+  int gridWidth() const;
+  int gridHeight() const;
+  // Point straight into the mapped file and are valid until it is destroyed
+  const QVector3D *vertices() const;
+  const quint32 *indices() const;
+  // Copies the mapped tables into a mesh for the exporters
+  Mesh mesh() const;
+
+  static bool write(const Mesh &mesh, const QString &filename);
+
+private:
+  QFile file;
+  const uchar *data = nullptr;
+  const MeshFileHeader *header = nullptr;
+  QString error;
+};
+
+#endif // __MESHFILE_H__
@@ -0,0 +1,511 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            meshvalidation.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+#include <QElapsedTimer>
+#include <QByteArray>
+
+#include "meshvalidation.h"
+
+// Entries per bucket. Small enough for the bucket's hash table to stay in
+// the cache while it is being filled.
+constexpr qint64 bucketEntries = 1 << 18;
+// Memory the edge records may use at once. Larger meshes are checked in
+// several passes, each covering a range of vertex indices.
+constexpr qint64 maxRecordMemory = 256 * 1024 * 1024;
+// Vertex indices are packed into 28 bits each, a QVector<QVector3D> can't
+// hold more vertices than that anyway
+constexpr int indexBits = 28;
+constexpr quint64 indexMask = (1ULL << indexBits) - 1;
+
+namespace {
+quint64 mix(quint64 value)
+{
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+quint64 tableCapacity(const qint64 &entries)
+{
+  quint64 capacity = 64;
+  while(capacity < (quint64)entries * 2) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+quint64 vertexHash(const QVector3D &vertex, quint32 bits[3])
+{
+  // Adding zero turns -0.0 into 0.0 so they are treated as the same
+  float coordinates[3] = { vertex.x() + 0.0f, vertex.y() + 0.0f, vertex.z() + 0.0f };
+  memcpy(bits, coordinates, sizeof(coordinates));
+  return mix((((quint64)bits[0] << 32) | bits[1]) ^ mix(bits[2]));
+}
+
+// Open addressing tables with linear probing. They are sized for all
+// entries of a bucket up front, so they never fill up more than halfway.
+struct VertexSlot
+{
+  quint32 bits[3];
+  quint32 index;
+};
+
+class VertexTable
+{
+public:
+  VertexTable(const qint64 &entries) : table(tableCapacity(entries), VertexSlot({{0, 0, 0}, empty})) {}
+  // Returns the index of the first vertex inserted at this position
+  quint32 insert(const quint32 bits[3], const quint64 &hash, const quint32 &index)
+  {
+    quint64 mask = table.size() - 1;
+    for(quint64 slot = (hash >> 16) & mask; ; slot = (slot + 1) & mask) {
+      VertexSlot &entry = table[slot];
+      if(entry.index == empty) {
+        memcpy(entry.bits, bits, sizeof(entry.bits));
+        entry.index = index;
+        return index;
+      }
+      if(memcmp(entry.bits, bits, sizeof(entry.bits)) == 0) {
+        return entry.index;
+      }
+    }
+  }
+
+private:
+  static constexpr quint32 empty = 0xffffffff;
+  std::vector<VertexSlot> table;
+};
+
+class EdgeTable
+{
+public:
+  EdgeTable(const qint64 &entries) : table(tableCapacity(entries), 0) {}
+  // Each entry holds the edge key in the upper 56 bits and how many times it
+  // was used in each direction in two 4 bit counters. 0 means empty, which
+  // can't be a key since the two vertices of an edge differ.
+  void insert(const quint64 &key, const quint64 &hash, const bool &forward)
+  {
+    quint64 mask = table.size() - 1;
+    for(quint64 slot = (hash >> 16) & mask; ; slot = (slot + 1) & mask) {
+      quint64 &entry = table[slot];
+      if(entry == 0) {
+        entry = (key << 8) | (forward?0x10:0x01);
+        return;
+      }
+      if((entry >> 8) == key) {
+        // Saturate, anything above two uses is a problem anyway
+        if(forward && (entry & 0xf0) != 0xf0) {
+          entry += 0x10;
+        } else if(!forward && (entry & 0x0f) != 0x0f) {
+          entry += 0x01;
+        }
+        return;
+      }
+    }
+  }
+
+  std::vector<quint64> table;
+};
+
+struct Found
+{
+  // Vertex or facet index the problems are ordered by
+  quint64 order;
+  MeshProblem problem;
+};
+
+struct Tally
+{
+  qint64 counts[4] = {0, 0, 0, 0};
+  std::vector<Found> found[4];
+  // Edge records of the open edges, when they are asked for
+  std::vector<quint64> open;
+};
+
+void keepFirst(std::vector<Found> &found, const int &maxProblems)
+{
+  std::sort(found.begin(), found.end(), [](const Found &a, const Found &b) {
+      return a.order < b.order;
+    });
+  if((int)found.size() > maxProblems) {
+    found.resize(maxProblems);
+  }
+}
+
+void addProblem(Tally &tally, const int &maxProblems, const MeshProblem::Type &type,
+                const quint64 &order, const QVector3D &position)
+{
+  tally.counts[type]++;
+  Found found;
+  found.order = order;
+  found.problem.type = type;
+  found.problem.position = position;
+  tally.found[type].push_back(found);
+  // Only the first problems are kept, trim every now and then
+  if((int)tally.found[type].size() > maxProblems * 4) {
+    keepFirst(tally.found[type], maxProblems);
+  }
+}
+
+QVector<quint32> canonicalVertices(const Mesh &mesh)
+{
+  // Maps every vertex to the lowest index of a vertex at the same position
+  qint64 count = mesh.vertices.length();
+  QVector<quint32> canonical(count);
+  quint32 *result = canonical.data();
+  if(mesh.isWelded) {
+    for(qint64 a = 0; a < count; ++a) {
+      result[a] = a;
+    }
+    return canonical;
+  }
+  const QVector3D *vertices = mesh.vertices.constData();
+  int threads = omp_get_max_threads();
+  int buckets = qMax((qint64)1, count / bucketEntries);
+  std::vector<std::vector<quint32>> bucketed(threads * buckets);
+#pragma omp parallel num_threads(threads)
+  {
+    std::vector<quint32> *own = bucketed.data() + (omp_get_thread_num() * buckets);
+    quint32 bits[3];
+#pragma omp for schedule(static)
+    for(qint64 a = 0; a < count; ++a) {
+      own[vertexHash(vertices[a], bits) % buckets].push_back(a);
+    }
+  }
+  // Static scheduling hands out the vertices in ascending chunks by thread,
+  // so the first vertex inserted at a position is the lowest
+#pragma omp parallel for schedule(dynamic, 1)
+  for(int bucket = 0; bucket < buckets; ++bucket) {
+    qint64 size = 0;
+    for(int thread = 0; thread < threads; ++thread) {
+      size += bucketed[(thread * buckets) + bucket].size();
+    }
+    VertexTable table(size);
+    quint32 bits[3];
+    for(int thread = 0; thread < threads; ++thread) {
+      std::vector<quint32> &indices = bucketed[(thread * buckets) + bucket];
+      for(const auto &a: indices) {
+        quint64 hash = vertexHash(vertices[a], bits);
+        result[a] = table.insert(bits, hash, a);
+      }
+      std::vector<quint32>().swap(indices);
+    }
+  }
+
+  return canonical;
+}
+
+int problemCount(const QList<MeshProblem> &problems, const MeshProblem::Type &type)
+{
+  int count = 0;
+  for(const auto &problem: problems) {
+    count += (problem.type == type?1:0);
+  }
+  return count;
+}
+}
+
+MeshValidation MeshValidation::check(const Mesh &mesh, const int &maxProblems)
+{
+  return check(mesh, maxProblems, nullptr);
+}
+
+MeshValidation MeshValidation::check(const Mesh &mesh, const int &maxProblems, std::vector<quint64> *openEdges)
+{
+  QElapsedTimer timer;
+  timer.start();
+  MeshValidation validation;
+  validation.facets = mesh.facetCount();
+  const QVector<quint32> canonical = canonicalVertices(mesh);
+  const quint32 *indices = mesh.indices.constData();
+  const quint32 *vertexIds = canonical.constData();
+  const QVector3D *vertices = mesh.vertices.constData();
+  qint64 facets = validation.facets;
+  qint64 vertexCount = mesh.vertices.length();
+  int threads = omp_get_max_threads();
+
+  // Every directed edge becomes a record of its packed vertex pair and its
+  // direction, spread over the buckets by hash. Each bucket is then counted
+  // by a single thread.
+  qint64 edges = facets * 3;
+  int passes = qMax((qint64)1, ((edges * (qint64)sizeof(quint64)) + maxRecordMemory - 1) / maxRecordMemory);
+  int buckets = qMax((qint64)1, edges / passes / bucketEntries);
+  std::vector<std::vector<quint64>> bucketed(threads * buckets);
+  std::vector<Tally> tallies(buckets + 1);
+  for(int pass = 0; pass < passes; ++pass) {
+    quint64 first = (vertexCount * pass) / passes;
+    quint64 last = (vertexCount * (pass + 1)) / passes;
+#pragma omp parallel num_threads(threads)
+    {
+      std::vector<quint64> *own = bucketed.data() + (omp_get_thread_num() * buckets);
+#pragma omp for schedule(static)
+      for(qint64 facet = 0; facet < facets; ++facet) {
+        const quint32 *corners = indices + (facet * 3);
+        for(int a = 0; a < 3; ++a) {
+          quint64 from = vertexIds[corners[a]];
+          quint64 to = vertexIds[corners[(a + 1) % 3]];
+          quint64 low = qMin(from, to);
+          if(from == to || low < first || low >= last) {
+            continue;
+          }
+          quint64 key = (low << indexBits) | qMax(from, to);
+          own[mix(key) % buckets].push_back((key << 1) | (from < to?1:0));
+        }
+      }
+    }
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int bucket = 0; bucket < buckets; ++bucket) {
+      qint64 size = 0;
+      for(int thread = 0; thread < threads; ++thread) {
+        size += bucketed[(thread * buckets) + bucket].size();
+      }
+      EdgeTable table(size);
+      for(int thread = 0; thread < threads; ++thread) {
+        std::vector<quint64> &records = bucketed[(thread * buckets) + bucket];
+        for(const auto &record: records) {
+          quint64 key = record >> 1;
+          table.insert(key, mix(key), record & 1);
+        }
+        std::vector<quint64>().swap(records);
+      }
+      Tally &tally = tallies[bucket];
+      for(const auto &entry: table.table) {
+        if(entry == 0) {
+          continue;
+        }
+        int forward = (entry >> 4) & 0x0f;
+        int uses = forward + (entry & 0x0f);
+        MeshProblem::Type type;
+        if(uses == 1) {
+          type = MeshProblem::OpenEdge;
+          if(openEdges != nullptr) {
+            tally.open.push_back(((entry >> 8) << 1) | (forward?1:0));
+          }
+        } else if(uses > 2) {
+          type = MeshProblem::NonManifoldEdge;
+        } else if(forward != 1) {
+          type = MeshProblem::FlippedEdge;
+        } else {
+          continue;
+        }
+        quint64 key = entry >> 8;
+        QVector3D position = (vertices[key >> indexBits] + vertices[key & indexMask]) / 2.0;
+        addProblem(tally, maxProblems, type, key, position);
+      }
+    }
+  }
+
+  // Degenerate facets, with their own tally
+  Tally &degenerate = tallies[buckets];
+#pragma omp parallel
+  {
+    Tally tally;
+#pragma omp for schedule(static) nowait
+    for(qint64 facet = 0; facet < facets; ++facet) {
+      const quint32 *corners = indices + (facet * 3);
+      QVector3D a = vertices[vertexIds[corners[0]]];
+      QVector3D b = vertices[vertexIds[corners[1]]];
+      QVector3D c = vertices[vertexIds[corners[2]]];
+      bool repeated = (vertexIds[corners[0]] == vertexIds[corners[1]] ||
+                       vertexIds[corners[1]] == vertexIds[corners[2]] ||
+                       vertexIds[corners[2]] == vertexIds[corners[0]]);
+      // No area relative to the longest edge. Anything below this is lost
+      // in float precision anyway.
+      double longest = qMax(qMax((b - a).lengthSquared(), (c - b).lengthSquared()), (a - c).lengthSquared());
+      double area = QVector3D::crossProduct(b - a, c - a).length();
+      if(repeated || area <= longest * 1e-7) {
+        addProblem(tally, maxProblems, MeshProblem::DegenerateFacet, facet, (a + b + c) / 3.0);
+      }
+    }
+#pragma omp critical
+    {
+      degenerate.counts[MeshProblem::DegenerateFacet] += tally.counts[MeshProblem::DegenerateFacet];
+      std::vector<Found> &found = degenerate.found[MeshProblem::DegenerateFacet];
+      found.insert(found.end(), tally.found[MeshProblem::DegenerateFacet].begin(),
+                   tally.found[MeshProblem::DegenerateFacet].end());
+    }
+  }
+
+  for(int type = MeshProblem::OpenEdge; type <= MeshProblem::DegenerateFacet; ++type) {
+    std::vector<Found> found;
+    for(const auto &tally: tallies) {
+      found.insert(found.end(), tally.found[type].begin(), tally.found[type].end());
+    }
+    keepFirst(found, maxProblems);
+    for(const auto &problem: found) {
+      validation.problems.append(problem.problem);
+    }
+  }
+  for(const auto &tally: tallies) {
+    if(openEdges != nullptr) {
+      openEdges->insert(openEdges->end(), tally.open.begin(), tally.open.end());
+    }
+    validation.openEdges += tally.counts[MeshProblem::OpenEdge];
+    validation.nonManifoldEdges += tally.counts[MeshProblem::NonManifoldEdge];
+    validation.flippedEdges += tally.counts[MeshProblem::FlippedEdge];
+    validation.degenerateFacets += tally.counts[MeshProblem::DegenerateFacet];
+  }
+  validation.msecs = timer.elapsed();
+
+  return validation;
+}
+
+bool MeshValidation::addPart(const Mesh &part, const int &maxProblems)
+{
+  std::vector<quint64> open;
+  MeshValidation partValidation = check(part, maxProblems, &open);
+  facets += partValidation.facets;
+  nonManifoldEdges += partValidation.nonManifoldEdges;
+  flippedEdges += partValidation.flippedEdges;
+  degenerateFacets += partValidation.degenerateFacets;
+  for(const auto &problem: partValidation.problems) {
+    if(problem.type != MeshProblem::OpenEdge && problemCount(problems, problem.type) < maxProblems) {
+      problems.append(problem);
+    }
+  }
+
+  // The open edges are keyed by the positions of their vertices, lowest
+  // first, since the vertex indices of the parts differ. Each direction
+  // gets a 4 bit counter, as in the edge tables.
+  QElapsedTimer timer;
+  timer.start();
+  const QVector3D *vertices = part.vertices.constData();
+  for(const auto &record: open) {
+    quint64 key = record >> 1;
+    quint32 bits[2][3];
+    vertexHash(vertices[key >> indexBits], bits[0]);
+    vertexHash(vertices[key & indexMask], bits[1]);
+    // The record direction is from the lower vertex index to the higher
+    bool forward = (record & 1);
+    bool ordered = (memcmp(bits[0], bits[1], sizeof(bits[0])) < 0);
+    QByteArray edge((const char *)bits[ordered?0:1], sizeof(bits[0]));
+    edge.append((const char *)bits[ordered?1:0], sizeof(bits[0]));
+    int &uses = partEdges[edge];
+    uses += (forward == ordered?0x10:0x01);
+    if(uses == 0x11) {
+      partEdges.remove(edge);
+    }
+  }
+  msecs += partValidation.msecs + timer.elapsed();
+
+  return (nonManifoldEdges == 0 && flippedEdges == 0 && degenerateFacets == 0);
+}
+
+void MeshValidation::finishParts(const int &maxProblems)
+{
+  for(auto it = partEdges.constBegin(); it != partEdges.constEnd(); ++it) {
+    int forward = it.value() >> 4;
+    int uses = forward + (it.value() & 0x0f);
+    MeshProblem problem;
+    if(uses == 1) {
+      problem.type = MeshProblem::OpenEdge;
+      openEdges++;
+    } else if(uses > 2) {
+      problem.type = MeshProblem::NonManifoldEdge;
+      nonManifoldEdges++;
+    } else {
+      problem.type = MeshProblem::FlippedEdge;
+      flippedEdges++;
+    }
+    if(problemCount(problems, problem.type) < maxProblems) {
+      float corners[6];
+      memcpy(corners, it.key().constData(), sizeof(corners));
+      problem.position = QVector3D((corners[0] + corners[3]) / 2.0, (corners[1] + corners[4]) / 2.0,
+                                   (corners[2] + corners[5]) / 2.0);
+      problems.append(problem);
+    }
+  }
+  partEdges.clear();
+}
+
+bool MeshValidation::isValid() const
+{
+  return openEdges == 0 && nonManifoldEdges == 0 && flippedEdges == 0 && degenerateFacets == 0;
+}
+
+QString MeshValidation::summary() const
+{
+  if(isValid()) {
+    return QString::number(facets) + " facets, no problems found";
+  }
+  QStringList counts;
+  if(openEdges > 0) {
+    counts.append(QString::number(openEdges) + " open edges");
+  }
+  if(nonManifoldEdges > 0) {
+    counts.append(QString::number(nonManifoldEdges) + " edges shared by more than two facets");
+  }
+  if(flippedEdges > 0) {
+    counts.append(QString::number(flippedEdges) + " edges with inconsistent winding");
+  }
+  if(degenerateFacets > 0) {
+    counts.append(QString::number(degenerateFacets) + " degenerate facets");
+  }
+  return counts.join(", ");
+}
+
+QStringList MeshValidation::details() const
+{
+  QStringList lines;
+  for(const auto &problem: problems) {
+    QString type;
+    switch(problem.type) {
+    case MeshProblem::OpenEdge:
+      type = "Open edge";
+      break;
+    case MeshProblem::NonManifoldEdge:
+      type = "Non-manifold edge";
+      break;
+    case MeshProblem::FlippedEdge:
+      type = "Flipped edge";
+      break;
+    case MeshProblem::DegenerateFacet:
+      type = "Degenerate facet";
+      break;
+    }
+    lines.append(QString("%1 at %2, %3, %4 mm").arg(type)
+                 .arg(problem.position.x(), 0, 'f', 3)
+                 .arg(problem.position.y(), 0, 'f', 3)
+                 .arg(problem.position.z(), 0, 'f', 3));
+  }
+  return lines;
+}
+
+QString MeshValidation::report() const
+{
+  if(problems.isEmpty()) {
+    return summary();
+  }
+  return summary() + " (" + details().join("; ") + ")";
+}
@@ -0,0 +1,99 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            meshvalidation.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+
+#ifndef __MESHVALIDATION_H__
+#define __MESHVALIDATION_H__
+
+#include <vector>
+#include <QHash>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector3D>
+
+#include "mesh.h"
+
+struct MeshProblem
+{
+  enum Type {
+    OpenEdge,
+    NonManifoldEdge,
+    FlippedEdge,
+    DegenerateFacet
+  };
+  Type type;
+  // Edge midpoint or facet centroid in mm
+  QVector3D position;
+};
+
+// Checks that a mesh is a closed, consistently wound surface without
+// degenerate facets, so it can go straight to the printer. Vertices are
+// compared by position, meshes with unshared vertices are checked the same
+// way as welded ones. Edges are spread over buckets in one parallel pass and
+// each bucket is then counted in its own small hash table, so no locking is
+// needed and the tables stay in the cache.
+class MeshValidation
+{
+public:
+  static MeshValidation check(const Mesh &mesh, const int &maxProblems = 10);
+  // Checks a mesh handed over in parts, such as the bands of a banded
+  // render, without holding more than one part at a time. Edges a part
+  // leaves open are kept until a later part closes them, all other problems
+  // are counted right away. Returns false once there is a problem no later
+  // part can fix. finishParts() counts the edges left over.
+  bool addPart(const Mesh &part, const int &maxProblems = 10);
+  void finishParts(const int &maxProblems = 10);
+  bool isValid() const;
+  QString summary() const;
+  QStringList details() const;
+  // Summary and details on a single line
+  QString report() const;
+
+  qint64 facets = 0;
+  // Edges used by a single facet
+  qint64 openEdges = 0;
+  // Edges shared by more than two facets
+  qint64 nonManifoldEdges = 0;
+  // Edges shared by two facets running in the same direction, ie. one of
+  // the facets is flipped
+  qint64 flippedEdges = 0;
+  // Facets with repeated corners or no area
+  qint64 degenerateFacets = 0;
+  // The first few problems of each kind, ordered by vertex or facet index
+  QList<MeshProblem> problems;
+  qint64 msecs = 0;
+
+private:
+  static MeshValidation check(const Mesh &mesh, const int &maxProblems, std::vector<quint64> *openEdges);
+
+  // Edges left open by the parts added so far, by the positions of their
+  // vertices, with the uses in each direction
+  QHash<QByteArray, int> partEdges;
+};
+
+#endif // __MESHVALIDATION_H__
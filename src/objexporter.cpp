@@ -0,0 +1,96 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            objexporter.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <QFile>
+
+#include "objexporter.h"
+#include "memorystats.h"
+
+// Lines per block written to disk
+constexpr int blockSize = 65536;
+
+QString ObjExporter::name() const
+{
+  return "OBJ";
+}
+
+QString ObjExporter::suffix() const
+{
+  return "obj";
+}
+
+qint64 ObjExporter::estimateSize(const qint64 &facets, const qint64 &vertices) const
+{
+  // Coordinates and indices take about seven characters each
+  return 64 + (vertices * 26) + (facets * 26);
+}
+
+bool ObjExporter::indexed() const
+{
+  return true;
+}
+
+bool ObjExporter::exportMesh(const Mesh &mesh, const QString &filename)
+{
+  Mesh model = mesh.welded();
+  // Only a copy if the mesh wasn't welded up front
+  TrackedBuffer modelBuffer(MemoryStats::Export, mesh.isWelded?0:model.memory());
+
+  QFile objFile(filename);
+  if(!objFile.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  bool success = (objFile.write("# LithoMaker " VERSION "\no lithophane\n") > 0);
+
+  QByteArray block;
+  for(int first = 0; success && first < model.vertices.length(); first += blockSize) {
+    int last = qMin(first + blockSize, model.vertices.length());
+    block.clear();
+    for(int a = first; a < last; ++a) {
+      const QVector3D &vertex = model.vertices.at(a);
+      block.append("v " + QByteArray::number(vertex.x(), 'g') + " " +
+                   QByteArray::number(vertex.y(), 'g') + " " +
+                   QByteArray::number(vertex.z(), 'g') + "\n");
+    }
+    success = (objFile.write(block) == block.size());
+  }
+  // Face indices are one based
+  for(int first = 0; success && first < model.facetCount(); first += blockSize) {
+    int last = qMin(first + blockSize, model.facetCount());
+    block.clear();
+    for(int a = first; a < last; ++a) {
+      block.append("f " + QByteArray::number(model.indices.at(a * 3) + 1) + " " +
+                   QByteArray::number(model.indices.at(a * 3 + 1) + 1) + " " +
+                   QByteArray::number(model.indices.at(a * 3 + 2) + 1) + "\n");
+    }
+    success = (objFile.write(block) == block.size());
+  }
+  // Closing doesn't report a failed flush of the buffered tail
+  success = success && objFile.flush();
+  objFile.close();
+
+  return success;
+}
@@ -0,0 +1,118 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            plyexporter.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <string.h>
+#include <QFile>
+#include <QtEndian>
+
+#include "plyexporter.h"
+#include "memorystats.h"
+
+// Faces per block written to disk
+constexpr int blockSize = 65536;
+// One count byte followed by three 32 bit indices
+constexpr int faceSize = 13;
+
+QString PlyExporter::name() const
+{
+  return "PLY";
+}
+
+QString PlyExporter::suffix() const
+{
+  return "ply";
+}
+
+qint64 PlyExporter::estimateSize(const qint64 &facets, const qint64 &vertices) const
+{
+  return 256 + (vertices * 12) + (facets * 13);
+}
+
+bool PlyExporter::indexed() const
+{
+  return true;
+}
+
+bool PlyExporter::exportMesh(const Mesh &mesh, const QString &filename)
+{
+  Mesh model = mesh.welded();
+  // Only a copy if the mesh wasn't welded up front
+  TrackedBuffer modelBuffer(MemoryStats::Export, mesh.isWelded?0:model.memory());
+
+  QFile plyFile(filename);
+  if(!plyFile.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  QByteArray header = "ply\n"
+    "format binary_little_endian 1.0\n"
+    "comment LithoMaker " VERSION "\n"
+    "element vertex " + QByteArray::number(model.vertices.length()) + "\n"
+    "property float x\n"
+    "property float y\n"
+    "property float z\n"
+    "element face " + QByteArray::number(model.facetCount()) + "\n"
+    "property list uchar int vertex_indices\n"
+    "end_header\n";
+  bool success = (plyFile.write(header) == header.size());
+
+  // QVector3D is three packed floats, so on little endian machines the
+  // vertex table is written as is
+  static_assert(sizeof(QVector3D) == 3 * sizeof(float), "QVector3D is expected to be packed");
+  if(success) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    qint64 size = model.vertices.length() * sizeof(QVector3D);
+    success = (plyFile.write((const char *)model.vertices.constData(), size) == size);
+#else
+    QByteArray block(model.vertices.length() * sizeof(QVector3D), 0);
+    for(int a = 0; a < model.vertices.length(); ++a) {
+      qToLittleEndian<float>(model.vertices.at(a).x(), (uchar *)block.data() + a * 12);
+      qToLittleEndian<float>(model.vertices.at(a).y(), (uchar *)block.data() + a * 12 + 4);
+      qToLittleEndian<float>(model.vertices.at(a).z(), (uchar *)block.data() + a * 12 + 8);
+    }
+    success = (plyFile.write(block) == block.size());
+#endif
+  }
+
+  QByteArray block;
+  for(int first = 0; success && first < model.facetCount(); first += blockSize) {
+    int count = qMin(blockSize, model.facetCount() - first);
+    block.resize(count * faceSize);
+    uchar *face = (uchar *)block.data();
+    for(int a = 0; a < count; ++a) {
+      face[0] = 3;
+      for(int b = 0; b < 3; ++b) {
+        qToLittleEndian<qint32>(model.indices.at((first + a) * 3 + b), face + 1 + b * 4);
+      }
+      face += faceSize;
+    }
+    success = (plyFile.write(block) == block.size());
+  }
+  // Closing doesn't report a failed flush of the buffered tail
+  success = success && plyFile.flush();
+  plyFile.close();
+
+  return success;
+}
@@ -0,0 +1,274 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            pngreader.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+
+#include <thread>
+#include <QFile>
+#include <QImage>
+#include <QSemaphore>
+#include <QVector>
+
+#include "pngreader.h"
+#include "memorystats.h"
+#include "trace.h"
+
+// Pixels per strip, small enough for a strip to stay in cache while it is
+// converted
+constexpr int stripPixels = 1024 * 1024;
+
+namespace {
+void pngError(png_structp png, png_const_charp message)
+{
+  // Keeps the message and jumps back to the call that failed
+  *(QString *)png_get_error_ptr(png) = QString(message);
+  png_longjmp(png, 1);
+}
+
+void pngWarning(png_structp, png_const_charp)
+{
+  // Warnings such as unknown chunks don't matter for the heights
+}
+
+// libpng reports errors by jumping back to these, so they hold nothing that
+// needs destructing
+bool readInfo(png_structp png, png_infop info)
+{
+  if(setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+  png_read_info(png, info);
+  return true;
+}
+
+bool updateInfo(png_structp png, png_infop info)
+{
+  if(setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+  png_read_update_info(png, info);
+  return true;
+}
+
+bool readRows(png_structp png, quint8 *strip, const int &stride, const int &rows)
+{
+  if(setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+  for(int y = 0; y < rows; ++y) {
+    png_read_row(png, strip + ((qint64)y * stride), nullptr);
+  }
+  return true;
+}
+}
+
+PngReader::PngReader(const QString &filename) : filename(filename)
+{
+}
+
+PngReader::~PngReader()
+{
+  if(png != nullptr) {
+    png_destroy_read_struct(&png, (info != nullptr?&info:nullptr), nullptr);
+  }
+  if(file != nullptr) {
+    fclose(file);
+  }
+}
+
+bool PngReader::open()
+{
+  file = fopen(QFile::encodeName(filename).constData(), "rb");
+  if(file == nullptr) {
+    error = "File could not be opened.";
+    return false;
+  }
+  png_byte signature[8];
+  if(fread(signature, 1, sizeof(signature), file) != sizeof(signature) ||
+     png_sig_cmp(signature, 0, sizeof(signature)) != 0) {
+    error = "Not a PNG file.";
+    return false;
+  }
+  png = png_create_read_struct(PNG_LIBPNG_VER_STRING, &error, pngError, pngWarning);
+  if(png == nullptr) {
+    error = "PNG decoder could not be created.";
+    return false;
+  }
+  info = png_create_info_struct(png);
+  if(info == nullptr) {
+    error = "PNG decoder could not be created.";
+    return false;
+  }
+  png_init_io(png, file);
+  png_set_sig_bytes(png, sizeof(signature));
+  if(!readInfo(png, info)) {
+    return false;
+  }
+
+  png_uint_32 pngWidth = 0;
+  png_uint_32 pngHeight = 0;
+  int bitDepth = 0;
+  int colorType = 0;
+  int interlace = 0;
+  png_get_IHDR(png, info, &pngWidth, &pngHeight, &bitDepth, &colorType, &interlace, nullptr, nullptr);
+  grayscale = (colorType == PNG_COLOR_TYPE_GRAY);
+  alpha = (colorType == PNG_COLOR_TYPE_RGB_ALPHA);
+  // QImage reads color images with a profile or gamma into its own color
+  // space, and other kinds of PNG to formats converting differently.
+  // Interlaced rows can't be used until the last pass.
+  bool supported = false;
+  if(grayscale) {
+    supported = (bitDepth == 8 || bitDepth == 16);
+  } else if(colorType == PNG_COLOR_TYPE_RGB || colorType == PNG_COLOR_TYPE_RGB_ALPHA) {
+    supported = (bitDepth == 8 && !png_get_valid(png, info, PNG_INFO_iCCP) &&
+                 !png_get_valid(png, info, PNG_INFO_gAMA) && !png_get_valid(png, info, PNG_INFO_cHRM));
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    supported = false;
+#endif
+  }
+  if(!supported || interlace != PNG_INTERLACE_NONE || png_get_valid(png, info, PNG_INFO_tRNS) ||
+     (qint64)pngWidth * pngHeight > 0x7fffffff) {
+    error = "PNG image of a kind that is left to QImage.";
+    return false;
+  }
+  imageWidth = pngWidth;
+  imageHeight = pngHeight;
+
+  // 16 bit grayscale rows are kept as they are, big endian, and rounded to
+  // 8 bit when converted. Color rows are laid out as QImage::Format_RGB32
+  // and Format_ARGB32.
+  wide = (bitDepth == 16);
+  if(!grayscale) {
+    png_set_bgr(png);
+    if(!alpha) {
+      png_set_filler(png, 0xff, PNG_FILLER_AFTER);
+    }
+  }
+
+  return updateInfo(png, info);
+}
+
+int PngReader::width() const
+{
+  return imageWidth;
+}
+
+int PngReader::height() const
+{
+  return imageHeight;
+}
+
+bool PngReader::isGrayscale() const
+{
+  return grayscale;
+}
+
+QString PngReader::errorString() const
+{
+  return error;
+}
+
+bool PngReader::read(quint8 *heights)
+{
+  // Inflating and unfiltering is serial, so a single converter thread
+  // converts the strip decoded last while the next one is decoded into the
+  // other buffer. The two buffers are handed back and forth with a pair of
+  // semaphores, and a strip of no rows stops the converter.
+  TRACE_SCOPE("decode png");
+  int stripRows = qMax(1, stripPixels / qMax(imageWidth, 1));
+  int stride = imageWidth * (grayscale?(wide?2:1):4);
+  QVector<quint8> strips[2];
+  strips[0].resize(stripRows * stride);
+  strips[1].resize(stripRows * stride);
+  TrackedBuffer stripBuffer(MemoryStats::Image, (qint64)stripRows * stride * 2);
+  int firstRows[2] = {0, 0};
+  int rows[2] = {0, 0};
+  QSemaphore freeStrips(2);
+  QSemaphore decodedStrips(0);
+  auto convertStrips = [&]() {
+    for(int strip = 0; ; ++strip) {
+      decodedStrips.acquire();
+      int slot = strip % 2;
+      if(rows[slot] == 0) {
+        break;
+      }
+      convert(strips[slot].constData(), firstRows[slot], rows[slot], heights);
+      freeStrips.release();
+    }
+  };
+  std::thread converter(convertStrips);
+
+  bool success = true;
+  int strip = 0;
+  for(int y = 0; y < imageHeight; y += stripRows, ++strip) {
+    int slot = strip % 2;
+    freeStrips.acquire();
+    firstRows[slot] = y;
+    rows[slot] = qMin(stripRows, imageHeight - y);
+    if(!readRows(png, strips[slot].data(), stride, rows[slot])) {
+      success = false;
+      break;
+    }
+    decodedStrips.release();
+  }
+  // A failed strip already holds its buffer
+  if(success) {
+    freeStrips.acquire();
+  }
+  rows[strip % 2] = 0;
+  decodedStrips.release();
+  converter.join();
+
+  return success;
+}
+
+void PngReader::convert(const quint8 *strip, const int &y, const int &rows, quint8 *heights) const
+{
+  // QImage converts pixel by pixel, so converting a strip gives the same
+  // grayscale as converting the whole image
+  TRACE_SCOPE("grayscale strip");
+  QImage gray;
+  if(!grayscale) {
+    gray = QImage(strip, imageWidth, rows, imageWidth * 4, (alpha?QImage::Format_ARGB32:QImage::Format_RGB32))
+      .convertToFormat(QImage::Format_Grayscale8);
+  }
+  for(int a = 0; a < rows; ++a) {
+    quint8 *row = heights + ((qint64)(imageHeight - 1 - (y + a)) * imageWidth);
+    if(wide) {
+      // Rounds the inverted value the way QColor does for QImage's
+      // Format_Grayscale16
+      const quint8 *source = strip + ((qint64)a * imageWidth * 2);
+      for(int x = 0; x < imageWidth; ++x) {
+        int value = 65535 - ((source[x * 2] << 8) | source[(x * 2) + 1]);
+        row[x] = (value - (value >> 8) + 0x80) >> 8;
+      }
+      continue;
+    }
+    const quint8 *source = (grayscale?strip + ((qint64)a * imageWidth):gray.constScanLine(a));
+    for(int x = 0; x < imageWidth; ++x) {
+      row[x] = 255 - source[x];
+    }
+  }
+}
@@ -0,0 +1,74 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            pngreader.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+
+#ifndef __PNGREADER_H__
+#define __PNGREADER_H__
+
+#include <stdio.h>
+#include <png.h>
+#include <QString>
+
+// Decodes PNG images with libpng a strip of rows at a time, straight to the
+// inverted 8 bit grayscale heights Lithophane renders from, without holding
+// the whole image in 32 bit color first as QImage does. Each strip is
+// converted on a thread of its own while the next one is decoded. Only the
+// kinds of PNG it reads to exactly the same heights as QImage are taken,
+// that is 8 and 16 bit grayscale and 8 bit RGB(A) without a color profile,
+// all without transparency or interlacing. Anything else is left to QImage.
+class PngReader
+{
+public:
+  PngReader(const QString &filename);
+  ~PngReader();
+  PngReader(const PngReader &) = delete;
+  PngReader &operator=(const PngReader &) = delete;
+  // Reads the header and returns whether the image can be read
+  bool open();
+  int width() const;
+  int height() const;
+  bool isGrayscale() const;
+  // Writes the heights of all rows, bottom row first as Lithophane stores
+  // them, to a buffer of width * height bytes
+  bool read(quint8 *heights);
+  QString errorString() const;
+
+private:
+  void convert(const quint8 *strip, const int &y, const int &rows, quint8 *heights) const;
+
+  QString filename;
+  FILE *file = nullptr;
+  png_structp png = nullptr;
+  png_infop info = nullptr;
+  int imageWidth = 0;
+  int imageHeight = 0;
+  bool grayscale = true;
+  bool wide = false;
+  bool alpha = false;
+  QString error;
+};
+
+#endif // __PNGREADER_H__
@@ -0,0 +1,197 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            printerprofile.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <algorithm>
+#include <QFile>
+#include <QRegularExpression>
+
+#include "printerprofile.h"
+
+static QString firstValue(const QHash<QString, QString> &values, const QString &key)
+{
+  // Multi extruder printers list one value per extruder, the first is used
+  return values.value(key).split(",").first().trimmed();
+}
+
+static float parseFloat(const QHash<QString, QString> &values, const QString &key,
+                        const float &defaultValue)
+{
+  bool ok = false;
+  float value = firstValue(values, key).toFloat(&ok);
+  return (ok?value:defaultValue);
+}
+
+static float parseRelative(const QHash<QString, QString> &values, const QString &key,
+                           const float &base, const float &defaultValue)
+{
+  // Values such as '50%' are relative to another value, zero means automatic
+  QString value = firstValue(values, key);
+  bool ok = false;
+  float result = 0.0;
+  if(value.endsWith("%")) {
+    value.chop(1);
+    result = base * value.toFloat(&ok) / 100.0;
+  } else {
+    result = value.toFloat(&ok);
+  }
+  return (ok && result > 0.0?result:defaultValue);
+}
+
+PrinterProfile PrinterProfile::fromFile(const QString &filename, bool *ok)
+{
+  PrinterProfile profile;
+  if(ok != nullptr) {
+    *ok = true;
+  }
+  if(filename.isEmpty()) {
+    return profile;
+  }
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if(ok != nullptr) {
+      *ok = false;
+    }
+    return profile;
+  }
+  // Section headers of config bundles are ignored, later keys win
+  while(!file.atEnd()) {
+    QString line = QString::fromUtf8(file.readLine()).trimmed();
+    int equals = line.indexOf("=");
+    if(line.startsWith("#") || line.startsWith(";") || line.startsWith("[") || equals < 1) {
+      continue;
+    }
+    QString value = line.mid(equals + 1).trimmed();
+    value.replace("\\n", "\n");
+    profile.values.insert(line.left(equals).trimmed(), value);
+  }
+  const QHash<QString, QString> &values = profile.values;
+
+  if(values.contains("bed_shape")) {
+    QList<float> xs;
+    QList<float> ys;
+    for(const auto &point: values.value("bed_shape").split(",")) {
+      QStringList coordinates = point.trimmed().split("x");
+      if(coordinates.length() == 2) {
+        xs.append(coordinates.at(0).toFloat());
+        ys.append(coordinates.at(1).toFloat());
+      }
+    }
+    if(xs.length() >= 3) {
+      profile.bedMinX = *std::min_element(xs.begin(), xs.end());
+      profile.bedMaxX = *std::max_element(xs.begin(), xs.end());
+      profile.bedMinY = *std::min_element(ys.begin(), ys.end());
+      profile.bedMaxY = *std::max_element(ys.begin(), ys.end());
+    }
+  }
+  profile.maxPrintHeight = parseFloat(values, "max_print_height", profile.maxPrintHeight);
+  profile.nozzleDiameter = parseFloat(values, "nozzle_diameter", profile.nozzleDiameter);
+  profile.filamentDiameter = parseFloat(values, "filament_diameter", profile.filamentDiameter);
+  profile.extrusionMultiplier = parseFloat(values, "extrusion_multiplier", profile.extrusionMultiplier);
+  profile.layerHeight = parseFloat(values, "layer_height", profile.layerHeight);
+  profile.firstLayerHeight = parseRelative(values, "first_layer_height", profile.layerHeight, profile.layerHeight);
+  // Extrusion widths in percent are relative to the layer height
+  float extrusionWidth = parseRelative(values, "extrusion_width", profile.layerHeight,
+                                       profile.nozzleDiameter * 1.125);
+  profile.extrusionWidth = parseRelative(values, "perimeter_extrusion_width", profile.layerHeight, extrusionWidth);
+  profile.perimeters = (int)parseFloat(values, "perimeters", profile.perimeters);
+  // Fill density is a plain fraction or a percentage
+  QString density = firstValue(values, "fill_density");
+  bool densityOk = false;
+  float fillDensity = (density.endsWith("%")?density.left(density.length() - 1).toFloat(&densityOk) / 100.0:
+                       density.toFloat(&densityOk));
+  if(densityOk) {
+    profile.infillDensity = qBound(0.0f, fillDensity, 1.0f);
+  }
+  profile.perimeterSpeed = parseFloat(values, "perimeter_speed", profile.perimeterSpeed);
+  profile.infillSpeed = parseFloat(values, "infill_speed", profile.infillSpeed);
+  profile.firstLayerSpeed = parseRelative(values, "first_layer_speed", profile.perimeterSpeed, profile.firstLayerSpeed);
+  profile.travelSpeed = parseFloat(values, "travel_speed", profile.travelSpeed);
+  profile.retractLength = parseFloat(values, "retract_length", profile.retractLength);
+  profile.retractSpeed = parseFloat(values, "retract_speed", profile.retractSpeed);
+  profile.retractLift = parseFloat(values, "retract_lift", profile.retractLift);
+  profile.retractBeforeTravel = parseFloat(values, "retract_before_travel", profile.retractBeforeTravel);
+  profile.temperature = parseFloat(values, "temperature", profile.temperature);
+  profile.firstLayerTemperature = parseFloat(values, "first_layer_temperature", profile.temperature);
+  profile.bedTemperature = parseFloat(values, "bed_temperature", profile.bedTemperature);
+  profile.firstLayerBedTemperature = parseFloat(values, "first_layer_bed_temperature", profile.bedTemperature);
+  profile.fanSpeed = parseFloat(values, "min_fan_speed", profile.fanSpeed);
+  profile.disableFanFirstLayers = parseFloat(values, "disable_fan_first_layers", profile.disableFanFirstLayers);
+  if(values.contains("start_gcode")) {
+    profile.startGcode = values.value("start_gcode");
+  }
+  if(values.contains("end_gcode")) {
+    profile.endGcode = values.value("end_gcode");
+  }
+
+  return profile;
+}
+
+QJsonObject PrinterProfile::toJson() const
+{
+  // Used as part of the render cache key, so any change to the profile
+  // file gives new G-code
+  QJsonObject json;
+  for(auto value = values.constBegin(); value != values.constEnd(); ++value) {
+    json.insert(value.key(), value.value());
+  }
+
+  return json;
+}
+
+QString PrinterProfile::expandPlaceholders(const QString &gcode) const
+{
+  QHash<QString, QString> known = {
+    {"temperature", QString::number(temperature)},
+    {"first_layer_temperature", QString::number(firstLayerTemperature)},
+    {"bed_temperature", QString::number(bedTemperature)},
+    {"first_layer_bed_temperature", QString::number(firstLayerBedTemperature)},
+    {"layer_height", QString::number(layerHeight)},
+    {"first_layer_height", QString::number(firstLayerHeight)},
+    {"nozzle_diameter", QString::number(nozzleDiameter)},
+    {"filament_diameter", QString::number(filamentDiameter)}
+  };
+  // Placeholders that aren't known are left as they are
+  QRegularExpression placeholder("\\[(\\w+)\\]|\\{(\\w+)(?:\\[\\d+\\])?\\}");
+  QString expanded;
+  int last = 0;
+  QRegularExpressionMatchIterator matches = placeholder.globalMatch(gcode);
+  while(matches.hasNext()) {
+    QRegularExpressionMatch match = matches.next();
+    QString key = (match.captured(1).isEmpty()?match.captured(2):match.captured(1));
+    expanded.append(gcode.mid(last, match.capturedStart() - last));
+    if(known.contains(key)) {
+      expanded.append(known.value(key));
+    } else if(values.contains(key)) {
+      expanded.append(firstValue(values, key));
+    } else {
+      expanded.append(match.captured(0));
+    }
+    last = match.capturedEnd();
+  }
+  expanded.append(gcode.mid(last));
+
+  return expanded;
+}
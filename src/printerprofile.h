@@ -0,0 +1,93 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            printerprofile.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __PRINTERPROFILE_H__
+#define __PRINTERPROFILE_H__
+
+#include <QString>
+#include <QHash>
+#include <QJsonObject>
+
+// Printer, filament and print settings for the G-code exporter. Read from a
+// PrusaSlicer style 'key = value' config file, eg. an exported config
+// bundle, so existing slicer profiles can be used as is. Keys missing from
+// the file keep the defaults below, which suit a generic 0.4 mm nozzle PLA
+// printer.
+class PrinterProfile
+{
+public:
+  // An empty filename gives the defaults
+  static PrinterProfile fromFile(const QString &filename, bool *ok = nullptr);
+  QJsonObject toJson() const;
+  // Replaces '[key]' and '{key}' placeholders with their values
+  QString expandPlaceholders(const QString &gcode) const;
+
+  float bedMinX = 0.0;
+  float bedMinY = 0.0;
+  float bedMaxX = 220.0;
+  float bedMaxY = 220.0;
+  float maxPrintHeight = 200.0;
+  float nozzleDiameter = 0.4;
+  float filamentDiameter = 1.75;
+  float extrusionMultiplier = 1.0;
+  float extrusionWidth = 0.45;
+  float layerHeight = 0.2;
+  float firstLayerHeight = 0.2;
+  int perimeters = 2;
+  float infillDensity = 1.0;
+  float perimeterSpeed = 40.0;
+  float infillSpeed = 60.0;
+  float firstLayerSpeed = 20.0;
+  float travelSpeed = 130.0;
+  float retractLength = 0.8;
+  float retractSpeed = 35.0;
+  float retractLift = 0.0;
+  float retractBeforeTravel = 2.0;
+  int temperature = 210;
+  int firstLayerTemperature = 210;
+  int bedTemperature = 60;
+  int firstLayerBedTemperature = 60;
+  int fanSpeed = 35;
+  int disableFanFirstLayers = 3;
+  QString startGcode = "M140 S[first_layer_bed_temperature]\n"
+                       "M104 S[first_layer_temperature]\n"
+                       "G28\n"
+                       "M190 S[first_layer_bed_temperature]\n"
+                       "M109 S[first_layer_temperature]\n";
+  QString endGcode = "M104 S0\n"
+                     "M140 S0\n"
+                     "M107\n"
+                     "G91\n"
+                     "G1 Z10 F600\n"
+                     "G90\n"
+                     "M84\n";
+
+private:
+  // All values as read from the file
+  QHash<QString, QString> values;
+};
+
+#endif // __PRINTERPROFILE_H__
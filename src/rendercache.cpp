@@ -0,0 +1,163 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            rendercache.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <utime.h>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QHash>
+#include <QWeakPointer>
+
+#include "rendercache.h"
+
+namespace {
+// The caches in use, by their absolute directory
+QMutex cachesMutex;
+QHash<QString, QWeakPointer<RenderCache> > caches;
+}
+
+RenderCache::RenderCache(const QString &directory, const qint64 &maxSize)
+  : directory(directory), maxSize(maxSize)
+{
+  QDir().mkpath(directory);
+}
+
+RenderCache::~RenderCache()
+{
+}
+
+QSharedPointer<RenderCache> RenderCache::shared(const QString &directory, const qint64 &maxSize)
+{
+  QMutexLocker locker(&cachesMutex);
+  QString path = QDir(directory).absolutePath();
+  QSharedPointer<RenderCache> cache = caches.value(path).toStrongRef();
+  if(cache.isNull()) {
+    cache = QSharedPointer<RenderCache>(new RenderCache(path, maxSize));
+    caches.insert(path, cache);
+    return cache;
+  }
+  QMutexLocker cacheLocker(&cache->mutex);
+  cache->maxSize = maxSize;
+  return cache;
+}
+
+QSharedPointer<RenderCache> RenderCache::fromConfig(const QSettings &config)
+{
+  if(!config.value("export/renderCache", false).toBool()) {
+    return QSharedPointer<RenderCache>();
+  }
+  return shared(config.value("export/renderCacheDir", defaultDirectory()).toString(),
+                config.value("export/renderCacheSize", "2048").toLongLong() * 1024 * 1024);
+}
+
+QString RenderCache::defaultDirectory()
+{
+  return QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)).filePath("lithomaker");
+}
+
+QString RenderCache::key(const Lithophane &lithophane, const RenderSettings &renderSettings,
+                         const QString &exportFormat, const QJsonObject &exportSettings) const
+{
+  // The version is part of the key, since mesh changes between versions
+  // would otherwise keep serving stale geometry
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  hash.addData(QByteArray(VERSION));
+  hash.addData(lithophane.contentHash());
+  hash.addData(QJsonDocument(renderSettings.toJson()).toJson(QJsonDocument::Compact));
+  hash.addData(exportFormat.toUtf8());
+  if(!exportSettings.isEmpty()) {
+    hash.addData(QJsonDocument(exportSettings).toJson(QJsonDocument::Compact));
+  }
+  return hash.result().toHex();
+}
+
+QString RenderCache::entryFilename(const QString &key) const
+{
+  return QDir(directory).filePath(key);
+}
+
+bool RenderCache::linkOrCopy(const QString &source, const QString &destination) const
+{
+  QFile::remove(destination);
+  if(::link(QFile::encodeName(source).constData(), QFile::encodeName(destination).constData()) == 0) {
+    return true;
+  }
+  // Hard links fail across filesystems
+  return QFile::copy(source, destination);
+}
+
+bool RenderCache::contains(const QString &key) const
+{
+  return QFileInfo::exists(entryFilename(key));
+}
+
+bool RenderCache::fetch(const QString &key, const QString &outputFile)
+{
+  QMutexLocker locker(&mutex);
+  QString entry = entryFilename(key);
+  if(!QFileInfo::exists(entry) || !linkOrCopy(entry, outputFile)) {
+    return false;
+  }
+  // Touch the entry so eviction sees it as recently used
+  ::utime(QFile::encodeName(entry).constData(), nullptr);
+  return true;
+}
+
+void RenderCache::store(const QString &key, const QString &outputFile)
+{
+  QMutexLocker locker(&mutex);
+  QString entry = entryFilename(key);
+  QString partEntry = entry + ".part";
+  if(linkOrCopy(outputFile, partEntry)) {
+    QFile::remove(entry);
+    QFile::rename(partEntry, entry);
+  } else {
+    QFile::remove(partEntry);
+  }
+  evict();
+}
+
+void RenderCache::evict()
+{
+  // Newest first, so everything after the size limit is the least recently
+  // used. Entries still being stored are left alone.
+  qint64 total = 0;
+  for(const auto &entryInfo: QDir(directory).entryInfoList(QDir::Files, QDir::Time)) {
+    if(entryInfo.fileName().endsWith(".part")) {
+      continue;
+    }
+    total += entryInfo.size();
+    if(total > maxSize) {
+      printf("Evicting '%s' from render cache.\n", entryInfo.fileName().toStdString().c_str());
+      QFile::remove(entryInfo.absoluteFilePath());
+    }
+  }
+}
@@ -0,0 +1,73 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            rendercache.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __RENDERCACHE_H__
+#define __RENDERCACHE_H__
+
+#include <QString>
+#include <QMutex>
+#include <QSettings>
+#include <QSharedPointer>
+#include <QJsonObject>
+
+#include "lithophane.h"
+#include "rendersettings.h"
+
+// On-disk cache of exported files, keyed by a hash of the prepared image
+// content and all render and export parameters. Hits are served by hard
+// linking the stored file to the output, falling back to a copy. The least
+// recently used entries are evicted when the cache grows beyond its size.
+// Every job using the same directory shares one cache, so their stores and
+// evictions are serialized.
+class RenderCache
+{
+public:
+  ~RenderCache();
+  // Returns the cache of the directory, creating it if no one else holds it.
+  // The size given last applies.
+  static QSharedPointer<RenderCache> shared(const QString &directory, const qint64 &maxSize);
+  static QSharedPointer<RenderCache> fromConfig(const QSettings &config);
+  static QString defaultDirectory();
+  // Export settings are only given for formats that depend on more than
+  // the mesh, such as the printer profile for G-code
+  QString key(const Lithophane &lithophane, const RenderSettings &renderSettings,
+              const QString &exportFormat, const QJsonObject &exportSettings = QJsonObject()) const;
+  bool contains(const QString &key) const;
+  bool fetch(const QString &key, const QString &outputFile);
+  void store(const QString &key, const QString &outputFile);
+
+private:
+  RenderCache(const QString &directory, const qint64 &maxSize);
+  QString entryFilename(const QString &key) const;
+  bool linkOrCopy(const QString &source, const QString &destination) const;
+  void evict();
+
+  QString directory;
+  qint64 maxSize;
+  QMutex mutex;
+};
+
+#endif // __RENDERCACHE_H__
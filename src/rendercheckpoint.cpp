@@ -0,0 +1,286 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            rendercheckpoint.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QCryptographicHash>
+
+#include "rendercheckpoint.h"
+#include "meshfile.h"
+
+constexpr int manifestVersion = 1;
+static const char *manifestName = "checkpoint.json";
+
+RenderCheckpoint::RenderCheckpoint(const QString &directory) : directory(directory)
+{
+}
+
+RenderCheckpoint::~RenderCheckpoint()
+{
+}
+
+QString RenderCheckpoint::key(const Lithophane &lithophane, const RenderSettings &renderSettings)
+{
+  // Parts rendered by another version may not match the ones rendered now
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  hash.addData(QByteArray(VERSION));
+  hash.addData(lithophane.contentHash());
+  hash.addData(QJsonDocument(renderSettings.toJson()).toJson(QJsonDocument::Compact));
+  return hash.result().toHex();
+}
+
+int RenderCheckpoint::open(const QString &key, const int &rows, const int &bandRows,
+                           const int &firstRow, const int &stopRow)
+{
+  int rangeEnd = (stopRow < 0?rows:qMin(stopRow, rows));
+  RenderCheckpoint earlier(directory);
+  parts.clear();
+  if(earlier.read() && earlier.checkpointKey == key && earlier.rows == rows &&
+     earlier.bandRows == bandRows && earlier.rangeStart == firstRow && earlier.rangeEnd == rangeEnd) {
+    // The backside and frame are always rendered again, since renderBands()
+    // ends with them even when resuming
+    for(const auto &part: earlier.parts) {
+      if(part.first >= rows) {
+        break;
+      }
+      parts.append(part);
+    }
+  }
+  checkpointKey = key;
+  this->rows = rows;
+  this->bandRows = bandRows;
+  this->rangeStart = firstRow;
+  this->rangeEnd = rangeEnd;
+  error.clear();
+
+  // Anything else is from another job or a part that was being written
+  QDir dir(directory);
+  if(!dir.mkpath(".")) {
+    error = "Checkpoint directory '" + directory + "' could not be created.";
+    return -1;
+  }
+  QStringList kept;
+  for(const auto &part: parts) {
+    kept.append(part.file);
+  }
+  for(const auto &file: dir.entryList(QDir::Files)) {
+    if(file != manifestName && !kept.contains(file)) {
+      dir.remove(file);
+    }
+  }
+  if(!writeManifest()) {
+    return -1;
+  }
+
+  return (parts.isEmpty()?rangeStart:parts.last().last);
+}
+
+bool RenderCheckpoint::read()
+{
+  parts.clear();
+  QDir dir(directory);
+  QFile manifestFile(dir.filePath(manifestName));
+  if(!manifestFile.open(QIODevice::ReadOnly)) {
+    error = "Checkpoint manifest in '" + directory + "' could not be read.";
+    return false;
+  }
+  QJsonObject manifest = QJsonDocument::fromJson(manifestFile.readAll()).object();
+  manifestFile.close();
+  if(manifest.value("version").toInt() != manifestVersion) {
+    error = "Checkpoint manifest in '" + directory + "' is invalid or from another version.";
+    return false;
+  }
+  checkpointKey = manifest.value("key").toString();
+  rows = manifest.value("rows").toInt();
+  bandRows = manifest.value("bandRows").toInt();
+  rangeStart = manifest.value("firstRow").toInt();
+  rangeEnd = manifest.value("stopRow").toInt();
+  for(const auto &value: manifest.value("parts").toArray()) {
+    QJsonObject object = value.toObject();
+    Part part;
+    part.file = object.value("file").toString();
+    part.first = object.value("first").toInt();
+    part.last = object.value("last").toInt();
+    part.facets = object.value("facets").toInt();
+    part.bytes = (qint64)object.value("bytes").toDouble();
+    // Parts must follow on from each other within the range and be written
+    // in full. Only a range ending at the last row has the backside and
+    // frame part after its bands.
+    int first = (parts.isEmpty()?rangeStart:parts.last().last);
+    bool band = (part.first < rangeEnd && part.last == qMin(first + bandRows, rows));
+    bool frame = (part.first == rows && part.last == rows && rangeEnd == rows);
+    if(part.first != first || (!band && !frame) || part.file.isEmpty() ||
+       QFileInfo(dir.filePath(part.file)).size() != part.bytes) {
+      break;
+    }
+    parts.append(part);
+    if(frame) {
+      break;
+    }
+  }
+
+  return true;
+}
+
+bool RenderCheckpoint::addPart(const Mesh &part)
+{
+  if(isComplete()) {
+    error = "Checkpoint already holds all parts.";
+    return false;
+  }
+  Part written;
+  written.first = (parts.isEmpty()?rangeStart:parts.last().last);
+  written.last = qMin(written.first + bandRows, rows);
+  written.file = (written.first < rows?QString("band%1.lmesh").arg(written.first, 6, 10, QChar('0')):
+                  QString("frame.lmesh"));
+  written.facets = part.facetCount();
+
+  // The part is only listed in the manifest once it has been written in
+  // full and renamed into place, so an interrupted write is never resumed
+  QString file = QDir(directory).filePath(written.file);
+  if(!MeshFile::write(part, file + ".part")) {
+    QFile::remove(file + ".part");
+    error = "Checkpoint part '" + file + "' could not be written.";
+    return false;
+  }
+  QFile::remove(file);
+  if(!QFile::rename(file + ".part", file)) {
+    error = "Checkpoint part '" + file + "' could not be written.";
+    return false;
+  }
+  written.bytes = QFileInfo(file).size();
+  parts.append(written);
+
+  return writeManifest();
+}
+
+bool RenderCheckpoint::isComplete() const
+{
+  if(parts.isEmpty()) {
+    return false;
+  }
+  return (rangeEnd < rows?parts.last().last >= rangeEnd:parts.last().first >= rows);
+}
+
+QString RenderCheckpoint::jobKey() const
+{
+  return checkpointKey;
+}
+
+int RenderCheckpoint::firstRow() const
+{
+  return rangeStart;
+}
+
+int RenderCheckpoint::stopRow() const
+{
+  return rangeEnd;
+}
+
+bool RenderCheckpoint::isLast() const
+{
+  return (rangeEnd == rows);
+}
+
+bool RenderCheckpoint::readParts(const std::function<bool(const Mesh &)> &sink)
+{
+  for(const auto &part: parts) {
+    MeshFile meshFile(QDir(directory).filePath(part.file));
+    if(!meshFile.open()) {
+      error = "Checkpoint part '" + part.file + "' could not be read: " + meshFile.errorString();
+      return false;
+    }
+    Mesh mesh = meshFile.mesh();
+    if(mesh.facetCount() != part.facets) {
+      error = "Checkpoint part '" + part.file + "' is corrupt.";
+      return false;
+    }
+    if(!sink(mesh)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int RenderCheckpoint::facets() const
+{
+  int facets = 0;
+  for(const auto &part: parts) {
+    facets += part.facets;
+  }
+
+  return facets;
+}
+
+void RenderCheckpoint::remove()
+{
+  QDir(directory).removeRecursively();
+  parts.clear();
+}
+
+QString RenderCheckpoint::errorString() const
+{
+  return error;
+}
+
+bool RenderCheckpoint::writeManifest()
+{
+  QJsonArray partList;
+  for(const auto &part: parts) {
+    QJsonObject object;
+    object.insert("file", part.file);
+    object.insert("first", part.first);
+    object.insert("last", part.last);
+    object.insert("facets", part.facets);
+    object.insert("bytes", part.bytes);
+    partList.append(object);
+  }
+  QJsonObject manifest;
+  manifest.insert("version", manifestVersion);
+  manifest.insert("key", checkpointKey);
+  manifest.insert("rows", rows);
+  manifest.insert("bandRows", bandRows);
+  manifest.insert("firstRow", rangeStart);
+  manifest.insert("stopRow", rangeEnd);
+  manifest.insert("parts", partList);
+
+  // Committed by renaming, so a manifest is never half written
+  QSaveFile file(QDir(directory).filePath(manifestName));
+  if(!file.open(QIODevice::WriteOnly) ||
+     file.write(QJsonDocument(manifest).toJson()) == -1 || !file.commit()) {
+    error = "Checkpoint manifest in '" + directory + "' could not be written.";
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,103 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            rendercheckpoint.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+
+#ifndef __RENDERCHECKPOINT_H__
+#define __RENDERCHECKPOINT_H__
+
+#include <functional>
+#include <QString>
+#include <QList>
+
+#include "lithophane.h"
+#include "rendersettings.h"
+#include "mesh.h"
+
+// Checkpoint of a render made in bands, so a job that is interrupted can
+// resume from its last completed band instead of starting over. Each band
+// is written to the checkpoint directory as a LithoMaker mesh (.lmesh)
+// part, followed by a part with the backside and frame. A manifest holds
+// the key of the job and the rows of each part written so far. The outputs
+// are stitched together from the parts once they are all written. A
+// checkpoint can also hold a range of rows, the share of the bands one of
+// several processes renders.
+class RenderCheckpoint
+{
+public:
+  RenderCheckpoint(const QString &directory);
+  ~RenderCheckpoint();
+  // Identifies the prepared image and render settings of a job
+  static QString key(const Lithophane &lithophane, const RenderSettings &renderSettings);
+  // Keeps the parts written earlier by a job with the same key, rows, band
+  // rows and range and returns the row to resume from. Anything else in the
+  // directory is removed. Returns -1 if the directory can't be written. The
+  // range ends at the stop row, or includes the backside and frame if it
+  // ends at the last row, as with Lithophane::renderBands().
+  int open(const QString &key, const int &rows, const int &bandRows,
+           const int &firstRow = 0, const int &stopRow = -1);
+  // Reads the manifest of a checkpoint written by another process without
+  // changing anything
+  bool read();
+  // Writes the next band, or the backside and frame after the last band.
+  // Usable as the sink of Lithophane::renderBands().
+  bool addPart(const Mesh &part);
+  // Whether all parts of the range are written
+  bool isComplete() const;
+  QString jobKey() const;
+  int firstRow() const;
+  int stopRow() const;
+  // Whether the range runs to the last row and ends with the backside and
+  // frame
+  bool isLast() const;
+  // Hands the parts to the sink in the order they were written
+  bool readParts(const std::function<bool(const Mesh &)> &sink);
+  int facets() const;
+  void remove();
+  QString errorString() const;
+
+private:
+  struct Part
+  {
+    QString file;
+    int first = 0;
+    int last = 0;
+    int facets = 0;
+    qint64 bytes = 0;
+  };
+
+  bool writeManifest();
+
+  QString directory;
+  QString checkpointKey;
+  int rows = 0;
+  int bandRows = 0;
+  int rangeStart = 0;
+  int rangeEnd = 0;
+  QList<Part> parts;
+  QString error;
+};
+
+#endif // __RENDERCHECKPOINT_H__
@@ -0,0 +1,261 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderestimate.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <QFile>
+#include <QImageReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSharedPointer>
+
+#include "renderestimate.h"
+#include "lithophane.h"
+#include "exporter.h"
+
+namespace {
+double defaultExportRate(const QString &format)
+{
+  // Bytes per second. The text formats are bound by number formatting, 3MF
+  // by compression.
+  if(format == "binary") {
+    return 400000000.0;
+  } else if(format == "ascii") {
+    return 60000000.0;
+  } else if(format == "3mf") {
+    return 15000000.0;
+  } else if(format == "ply") {
+    return 300000000.0;
+  } else if(format == "obj") {
+    return 40000000.0;
+  } else if(format == "lmesh") {
+    return 800000000.0;
+  }
+
+  return 50000000.0;
+}
+
+QString megabytes(const qint64 &bytes)
+{
+  return QString::number(bytes / 1048576.0, 'f', 1) + " MB";
+}
+}
+
+double RenderCalibration::exportRate(const QString &format) const
+{
+  return exportRates.value(format, defaultExportRate(format));
+}
+
+RenderCalibration RenderCalibration::fromBenchmarks(const QString &file, bool *ok)
+{
+  RenderCalibration calibration;
+  if(ok != nullptr) {
+    *ok = false;
+  }
+  QFile jsonFile(file);
+  if(!jsonFile.open(QIODevice::ReadOnly)) {
+    return calibration;
+  }
+  QJsonArray results = QJsonDocument::fromJson(jsonFile.readAll()).object().value("results").toArray();
+  if(results.isEmpty()) {
+    return calibration;
+  }
+  // The export stages are measured by facets, the others by pixels
+  QHash<QString, double> largest;
+  for(const auto &value: results) {
+    QJsonObject result = value.toObject();
+    QString stage = result.value("stage").toString();
+    bool exportStage = stage.startsWith("export-");
+    double amount = result.value(exportStage?"facets":"pixels").toDouble();
+    double seconds = result.value("milliseconds").toDouble() / 1000.0;
+    if(amount <= 0.0 || seconds <= 0.0 || amount <= largest.value(stage, 0.0)) {
+      continue;
+    }
+    largest.insert(stage, amount);
+    if(stage == "load") {
+      calibration.decodeRate = amount / seconds;
+    } else if(stage == "prepare") {
+      calibration.prepareRate = amount / seconds;
+    } else if(stage == "mesh") {
+      calibration.meshRate = amount / seconds;
+    } else if(exportStage) {
+      QString format = stage.mid(7);
+      double bytes = result.value("bytes").toDouble();
+      calibration.exportRates.insert(format, bytes / seconds);
+      calibration.bytesPerFacet.insert(format, bytes / amount);
+    }
+  }
+  calibration.file = file;
+  if(ok != nullptr) {
+    *ok = true;
+  }
+
+  return calibration;
+}
+
+RenderCalibration RenderCalibration::fromConfig(const QSettings &config)
+{
+  QString file = config.value("main/calibrationFile", "").toString();
+  if(file.isEmpty()) {
+    return RenderCalibration();
+  }
+
+  return fromBenchmarks(file);
+}
+
+RenderEstimate RenderEstimate::forJob(const RenderJob &job, const RenderCalibration &calibration)
+{
+  RenderEstimate estimate;
+  estimate.calibrationFile = calibration.file;
+  QSize decodedSize = QImageReader(job.inputFile).size();
+  if(decodedSize.isEmpty()) {
+    estimate.errorString = "Input image size could not be read.";
+    return estimate;
+  }
+
+  // Every tile decodes the whole image and renders its own part of it
+  QList<RenderJob> tiles = job.tiles();
+  estimate.tiles = tiles.length();
+  double decodeSeconds = ((double)decodedSize.width() * decodedSize.height()) / calibration.decodeRate;
+  for(const auto &tile: tiles) {
+    QSize renderSize = decodedSize;
+    if(tile.maxSize > 0 && (renderSize.width() > tile.maxSize || renderSize.height() > tile.maxSize)) {
+      renderSize.scale(tile.maxSize, tile.maxSize, Qt::KeepAspectRatio);
+    }
+    if(tile.renderSettings.isTiled()) {
+      renderSize = RenderJob::tileRect(renderSize, tile.renderSettings).size();
+    }
+    RenderPlan plan = RenderJob::plan(decodedSize, renderSize, tile.isStreamable(), tile.isIndexed(),
+                                      tile.maxMemory);
+    if(!plan.isValid()) {
+      estimate.errorString = "Input image can't be rendered within the memory limit of " +
+        QString::number(tile.maxMemory / (1024 * 1024)) + " MB.";
+      return estimate;
+    }
+    estimate.width = plan.size.width();
+    estimate.height = plan.size.height();
+    estimate.memory = qMax(estimate.memory, plan.memory);
+    estimate.strategy = plan.name();
+
+    // A closed mesh has about half as many vertices as facets once welded
+    qint64 facets = Lithophane::estimateFacets(plan.size.width(), plan.size.height(), tile.renderSettings);
+    qint64 vertices = (facets / 2) + 2;
+    estimate.facets += facets;
+    double exportSeconds = 0.0;
+    for(const auto &output: tile.outputs) {
+      qint64 size = -1;
+      if(calibration.bytesPerFacet.contains(output.format)) {
+        size = qRound64(facets * calibration.bytesPerFacet.value(output.format));
+      } else {
+        QSharedPointer<Exporter> exporter(Exporter::create(output.format, tile.printerProfile));
+        if(!exporter.isNull()) {
+          size = exporter->estimateSize(facets, vertices);
+        }
+      }
+      estimate.outputFiles.append(output.file);
+      estimate.fileSizes.append(size);
+      // The outputs are written concurrently, so the slowest one counts
+      if(size > 0) {
+        exportSeconds = qMax(exportSeconds, size / calibration.exportRate(output.format));
+      }
+    }
+    double pixels = (double)plan.size.width() * plan.size.height();
+    estimate.seconds += decodeSeconds + (pixels / calibration.prepareRate) +
+      (pixels / calibration.meshRate) + exportSeconds;
+  }
+  estimate.valid = true;
+
+  return estimate;
+}
+
+qint64 RenderEstimate::totalSize() const
+{
+  qint64 total = 0;
+  for(const auto &size: fileSizes) {
+    total += qMax(size, (qint64)0);
+  }
+
+  return total;
+}
+
+QJsonObject RenderEstimate::toJson() const
+{
+  QJsonObject json;
+  json.insert("valid", valid);
+  if(!valid) {
+    json.insert("error", errorString);
+    return json;
+  }
+  json.insert("width", width);
+  json.insert("height", height);
+  json.insert("tiles", tiles);
+  json.insert("strategy", strategy);
+  json.insert("facets", facets);
+  QJsonArray outputs;
+  for(int a = 0; a < outputFiles.length(); ++a) {
+    QJsonObject output;
+    output.insert("file", outputFiles.at(a));
+    output.insert("bytes", fileSizes.at(a));
+    outputs.append(output);
+  }
+  json.insert("outputs", outputs);
+  json.insert("peakMemoryBytes", memory);
+  json.insert("seconds", seconds);
+  json.insert("calibrationFile", calibrationFile);
+
+  return json;
+}
+
+QString RenderEstimate::summary() const
+{
+  if(!valid) {
+    return errorString;
+  }
+  return QString("Estimate: %1 x %2 pixels%3, %4 facets, %5 written, peak memory %6, about %7 s%8")
+    .arg(width).arg(height).arg(tiles > 1?QString(" in %1 tiles").arg(tiles):QString())
+    .arg(facets).arg(megabytes(totalSize())).arg(megabytes(memory))
+    .arg(seconds, 0, 'f', 1).arg(calibrationFile.isEmpty()?QString(" (uncalibrated)"):QString());
+}
+
+QString RenderEstimate::report() const
+{
+  if(!valid) {
+    return errorString;
+  }
+  QStringList lines;
+  lines.append(QString("Size: %1 x %2 pixels").arg(width).arg(height) +
+               (tiles > 1?QString(" per tile, %1 tiles").arg(tiles):QString()));
+  lines.append("Strategy: " + strategy);
+  lines.append(QString("Facets: %1").arg(facets));
+  for(int a = 0; a < outputFiles.length(); ++a) {
+    lines.append("Output '" + outputFiles.at(a) + "': " +
+                 (fileSizes.at(a) < 0?QString("unknown size"):megabytes(fileSizes.at(a))));
+  }
+  lines.append("Peak memory: " + megabytes(memory));
+  lines.append(QString("Time: about %1 s").arg(seconds, 0, 'f', 1) +
+               (calibrationFile.isEmpty()?QString(" (uncalibrated, see 'benchmarks --json')"):
+                " (calibrated with '" + calibrationFile + "')"));
+
+  return lines.join("\n");
+}
@@ -0,0 +1,97 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderestimate.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __RENDERESTIMATE_H__
+#define __RENDERESTIMATE_H__
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QJsonObject>
+#include <QSettings>
+
+#include "renderjob.h"
+
+// How fast each stage of a render runs on this machine. Without benchmark
+// results the rates are rough figures for an average desktop machine.
+struct RenderCalibration
+{
+  // Pixels per second
+  double decodeRate = 30000000.0;
+  double prepareRate = 50000000.0;
+  double meshRate = 150000000.0;
+  // Measured bytes per second and bytes per facet by export format
+  QHash<QString, double> exportRates;
+  QHash<QString, double> bytesPerFacet;
+  // The benchmark results the rates were read from, empty for the defaults
+  QString file;
+
+  double exportRate(const QString &format) const;
+  // Reads the results written by 'benchmarks --json'. The largest input of
+  // each stage is used, as it is the least affected by fixed overhead.
+  static RenderCalibration fromBenchmarks(const QString &file, bool *ok = nullptr);
+  // Uses the benchmark results set in the 'main/calibrationFile' key, if any
+  static RenderCalibration fromConfig(const QSettings &config);
+};
+
+// What a render job will produce and cost, worked out from the image
+// dimensions and render settings without decoding the image. Facet counts
+// are exact for regular meshes, file sizes of the text and compressed
+// formats are approximate.
+struct RenderEstimate
+{
+  // False if the size of the input image couldn't be read
+  bool valid = false;
+  // Size the image is rendered at, per tile when tiled
+  int width = 0;
+  int height = 0;
+  int tiles = 1;
+  // Over all tiles
+  qint64 facets = 0;
+  // Per output file, -1 if the format can't be estimated
+  QStringList outputFiles;
+  QList<qint64> fileSizes;
+  // Peak memory of a single job, see RenderPlan
+  qint64 memory = 0;
+  QString strategy;
+  // Over all tiles, as if run one after the other
+  double seconds = 0.0;
+  // The benchmark results the time is calibrated with, empty if it isn't
+  QString calibrationFile;
+  QString errorString;
+
+  // Estimates the job, or all of its tiles if it is tiled
+  static RenderEstimate forJob(const RenderJob &job,
+                               const RenderCalibration &calibration = RenderCalibration());
+  qint64 totalSize() const;
+  QJsonObject toJson() const;
+  // One line for the main window
+  QString summary() const;
+  // One line per value, for the command line
+  QString report() const;
+};
+
+#endif // __RENDERESTIMATE_H__
@@ -0,0 +1,796 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderjob.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <thread>
+#include <vector>
+#include <omp.h>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QImage>
+#include <QImageReader>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "renderjob.h"
+#include "rendercheckpoint.h"
+#include "trace.h"
+
+// Welding for the indexed formats holds a second copy of the vertices and
+// facets, and a hash entry for every vertex while doing it
+constexpr qint64 weldBytesPerPixel = 12 + 24 + 40;
+
+// Pixels per band of a checkpointed render, the most work an interrupted
+// render loses
+constexpr qint64 checkpointBandPixels = 16 * 1024 * 1024;
+
+bool RenderPlan::isValid() const
+{
+  return !size.isEmpty();
+}
+
+QString RenderPlan::name() const
+{
+  return (strategy == Banded?"banded":(strategy == Downscaled?"downscaled":"in-memory"));
+}
+
+void RenderJob::addOutputs(const QString &outputFile, const QString &format,
+                           const QStringList &additionalFormats)
+{
+  outputs.append({outputFile, format});
+  QFileInfo outputInfo(outputFile);
+  for(const auto &additionalFormat: additionalFormats) {
+    if(additionalFormat == format) {
+      continue;
+    }
+    QString file = QDir(outputInfo.path()).filePath(outputInfo.completeBaseName() + "." +
+                                                    Exporter::suffix(additionalFormat));
+    // Formats sharing a suffix, such as binary and ascii STL, get the format
+    // added to the name
+    if(outputFiles().contains(file)) {
+      file = QDir(outputInfo.path()).filePath(outputInfo.completeBaseName() + "_" + additionalFormat +
+                                              "." + Exporter::suffix(additionalFormat));
+    }
+    outputs.append({file, additionalFormat});
+  }
+}
+
+QStringList RenderJob::outputFiles() const
+{
+  QStringList files;
+  for(const auto &output: outputs) {
+    files.append(output.file);
+  }
+
+  return files;
+}
+
+QList<RenderJob> RenderJob::tiles() const
+{
+  QList<RenderJob> jobs;
+  if(!renderSettings.isTiled()) {
+    jobs.append(*this);
+    return jobs;
+  }
+
+  for(int row = 0; row < renderSettings.tileRows; ++row) {
+    for(int column = 0; column < renderSettings.tileColumns; ++column) {
+      RenderJob job = *this;
+      job.renderSettings.tileColumn = column;
+      job.renderSettings.tileRow = row;
+      for(auto &output: job.outputs) {
+        QFileInfo outputInfo(output.file);
+        QString file = outputInfo.completeBaseName() + QString("_r%1c%2").arg(row + 1).arg(column + 1);
+        if(!outputInfo.suffix().isEmpty()) {
+          file.append("." + outputInfo.suffix());
+        }
+        output.file = QDir(outputInfo.path()).filePath(file);
+      }
+      jobs.append(job);
+    }
+  }
+
+  return jobs;
+}
+
+QRect RenderJob::tileRect(const QSize &imageSize, const RenderSettings &renderSettings)
+{
+  // The few pixels left over at the right and bottom edges are dropped
+  int tileWidth = imageSize.width() / renderSettings.tileColumns;
+  int tileHeight = imageSize.height() / renderSettings.tileRows;
+
+  return QRect(renderSettings.tileColumn * tileWidth, renderSettings.tileRow * tileHeight,
+               tileWidth, tileHeight);
+}
+
+RenderPlan RenderJob::plan(const QSize &decodedSize, const QSize &renderSize,
+                           const bool &streamable, const bool &indexed,
+                           const qint64 &maxMemory)
+{
+  // A decoded image larger than the one rendered is held while scaling it
+  qint64 decoded = 0;
+  if(!decodedSize.isEmpty() && decodedSize != renderSize) {
+    decoded = (qint64)decodedSize.width() * decodedSize.height() * 4;
+  }
+  auto inMemory = [&decoded, &indexed](const QSize &size) {
+    qint64 pixels = (qint64)size.width() * size.height();
+    return decoded + Lithophane::estimateMemory(size.width(), size.height()) +
+      (indexed?pixels * weldBytesPerPixel:0);
+  };
+
+  RenderPlan plan;
+  plan.size = renderSize;
+  plan.memory = inMemory(renderSize);
+  if(maxMemory <= 0 || plan.memory <= maxMemory) {
+    return plan;
+  }
+
+  // Banding gives the same mesh, so it is preferred over scaling down. The
+  // bands are made as tall as the budget allows.
+  if(streamable && renderSize.height() > 1) {
+    qint64 bandless = decoded + Lithophane::estimateBandMemory(renderSize.width(), renderSize.height(), 0);
+    qint64 rowBytes = Lithophane::estimateBandMemory(renderSize.width(), renderSize.height(), 1) -
+      Lithophane::estimateBandMemory(renderSize.width(), renderSize.height(), 0);
+    if(bandless + rowBytes <= maxMemory) {
+      plan.strategy = RenderPlan::Banded;
+      plan.bandRows = (int)qMin((maxMemory - bandless) / rowBytes, (qint64)renderSize.height() - 1);
+      plan.memory = bandless + (plan.bandRows * rowBytes);
+      return plan;
+    }
+  }
+
+  // Scaling down needs the full image decoded first, so an image that is
+  // already prepared can't be scaled down here
+  if(!decodedSize.isEmpty()) {
+    decoded = (qint64)decodedSize.width() * decodedSize.height() * 4;
+    for(double scale = 0.9; ; scale *= 0.9) {
+      QSize size(qRound(renderSize.width() * scale), qRound(renderSize.height() * scale));
+      if(size.width() < 2 || size.height() < 2) {
+        break;
+      }
+      if(inMemory(size) <= maxMemory) {
+        plan.strategy = RenderPlan::Downscaled;
+        plan.size = size;
+        plan.memory = inMemory(size);
+        return plan;
+      }
+    }
+  }
+  plan.size = QSize();
+
+  return plan;
+}
+
+bool RenderJob::isStreamable() const
+{
+  if(renderSettings.solid) {
+    return false;
+  }
+  for(const auto &output: outputs) {
+    QSharedPointer<Exporter> exporter(Exporter::create(output.format, printerProfile));
+    if(exporter.isNull() || !exporter->canStream()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool RenderJob::isIndexed() const
+{
+  for(const auto &output: outputs) {
+    QSharedPointer<Exporter> exporter(Exporter::create(output.format, printerProfile));
+    if(!exporter.isNull() && exporter->indexed()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+RenderJob::Status RenderJob::run(Lithophane &lithophane)
+{
+  TRACE_SCOPE("render job");
+  QElapsedTimer timer;
+  timer.start();
+  qint64 cpuTime = RenderStats::processCpuTime();
+  stats = RenderStats();
+  stats.inputFile = inputFile;
+  stats.outputFiles = outputFiles();
+  // The thread count is kept per thread by OpenMP, so it only applies to
+  // the thread running the job
+  if(threads > 0) {
+    omp_set_num_threads(threads);
+  }
+  stats.threads = (threads > 0?threads:QThread::idealThreadCount());
+  MemoryStats::resetPeaks();
+  MemoryUsage memory = MemoryStats::heap();
+
+  Status status = render(lithophane);
+
+  stats.status = (status == Finished?(cached?"cached":"finished"):(status == Cancelled?"cancelled":"failed"));
+  stats.strategy = (bands > 1?"split":renderPlan.name());
+  stats.facets = facets;
+  stats.totalTime = timer.nsecsElapsed();
+  stats.cpuTime = RenderStats::processCpuTime() - cpuTime;
+  stats.peakRss = RenderStats::processPeakRss();
+  MemoryUsage heap = MemoryStats::heap();
+  stats.allocations = heap.allocations - memory.allocations;
+  stats.allocatedBytes = heap.allocatedBytes - memory.allocatedBytes;
+  if(statsLog != nullptr) {
+    statsLog->add(stats);
+  }
+
+  return status;
+}
+
+RenderJob::Status RenderJob::render(Lithophane &lithophane)
+{
+  QElapsedTimer phaseTimer;
+  phaseTimer.start();
+  MemoryUsage phaseStart = MemoryStats::heap();
+  auto endPhase = [this, &phaseTimer, &phaseStart](const QString &name) {
+    MemoryUsage heap = MemoryStats::heap();
+    MemoryUsage memory;
+    memory.allocations = heap.allocations - phaseStart.allocations;
+    memory.allocatedBytes = heap.allocatedBytes - phaseStart.allocatedBytes;
+    memory.liveBytes = heap.liveBytes;
+    memory.peakBytes = heap.peakBytes;
+    stats.addPhase(name, phaseTimer.nsecsElapsed(), memory);
+    for(int a = 0; a < MemoryStats::BufferCount; ++a) {
+      stats.bufferPeaks[a] = qMax(stats.bufferPeaks[a], MemoryStats::buffer((MemoryStats::Buffer)a).peakBytes);
+    }
+    // Each phase gets a peak of its own
+    MemoryStats::resetPeaks();
+    phaseStart = heap;
+    phaseTimer.start();
+  };
+
+  if(lithophane.isCancelled()) {
+    return Cancelled;
+  }
+
+  if(outputs.isEmpty()) {
+    errorString = "No output file given.";
+    return Failed;
+  }
+  for(const auto &output: outputs) {
+    if(!Exporter::formats().contains(output.format)) {
+      errorString = "Unknown export format '" + output.format + "'.";
+      return Failed;
+    }
+  }
+
+  // Solid meshes can't be rendered in bands
+  if(bands > 1 && renderSettings.solid) {
+    errorString = "Solid meshes can't be split into bands.";
+    return Failed;
+  }
+  if(checkpoint && renderSettings.solid) {
+    errorString = "Solid meshes can't be checkpointed.";
+    return Failed;
+  }
+  if(merge && bands < 2) {
+    errorString = "Only split renders can be merged.";
+    return Failed;
+  }
+  bool checkpointed = (checkpoint || bands > 1);
+
+  // The budget is planned for from the size of the image before decoding it
+  renderPlan = RenderPlan();
+  if(maxMemory > 0) {
+    QSize decodedSize;
+    QSize renderSize(lithophane.width(), lithophane.height());
+    if(lithophane.isNull()) {
+      decodedSize = QImageReader(inputFile).size();
+      renderSize = decodedSize;
+      if(maxSize > 0 && (renderSize.width() > maxSize || renderSize.height() > maxSize)) {
+        renderSize.scale(maxSize, maxSize, Qt::KeepAspectRatio);
+      }
+      if(renderSettings.isTiled()) {
+        renderSize = tileRect(renderSize, renderSettings).size();
+      }
+    }
+    // Sizes that can't be read without decoding are left to the decoder
+    if(!renderSize.isEmpty()) {
+      renderPlan = plan(decodedSize, renderSize, isStreamable(), isIndexed(), maxMemory);
+      if(!renderPlan.isValid()) {
+        errorString = "Input image can't be rendered within the memory limit of " +
+          QString::number(maxMemory / (1024 * 1024)) + " MB.";
+        return Failed;
+      }
+    }
+  }
+
+  // The image is only loaded if the lithophane doesn't already hold one.
+  // PNG images used as they are skip QImage and decode straight to heights.
+  // Meshing waits for the whole image, since PNG rows are decoded top down
+  // and the mesh is built bottom up.
+  // Bands build their part of the topology as they go.
+  bool topology = (renderPlan.strategy != RenderPlan::Banded && !checkpointed);
+  bool loaded = false;
+  if(lithophane.isNull() && !renderSettings.isTiled() && renderPlan.strategy != RenderPlan::Downscaled) {
+    QSize fileSize = QImageReader(inputFile).size();
+    if(maxSize <= 0 || (fileSize.isValid() && fileSize.width() <= maxSize && fileSize.height() <= maxSize)) {
+      TRACE_SCOPE("decode");
+      loaded = lithophane.loadPng(inputFile, topology);
+    }
+  }
+  if(loaded) {
+    endPhase("decode");
+  } else if(lithophane.isNull()) {
+    QImage image;
+    TrackedBuffer imageBuffer(MemoryStats::Image);
+    {
+      TRACE_SCOPE("decode");
+      image.load(inputFile);
+    }
+    imageBuffer.resize(image.sizeInBytes());
+    endPhase("decode");
+    if(image.isNull()) {
+      errorString = "Input file could not be loaded.";
+      return Failed;
+    }
+    if(maxSize > 0 && (image.width() > maxSize || image.height() > maxSize)) {
+      TRACE_SCOPE("scale");
+      if(image.width() > image.height()) {
+        image = image.scaledToWidth(maxSize);
+      } else {
+        image = image.scaledToHeight(maxSize);
+      }
+      imageBuffer.resize(image.sizeInBytes());
+    }
+    if(renderSettings.isTiled()) {
+      QRect tile = tileRect(image.size(), renderSettings);
+      if(tile.width() < 2 || tile.height() < 2) {
+        errorString = "Input image is too small to be split into " + QString::number(renderSettings.tileColumns) +
+          " x " + QString::number(renderSettings.tileRows) + " tiles.";
+        return Failed;
+      }
+      image = image.copy(tile);
+      imageBuffer.resize(image.sizeInBytes());
+    }
+    if(renderPlan.strategy == RenderPlan::Downscaled) {
+      image = image.scaled(renderPlan.size);
+      imageBuffer.resize(image.sizeInBytes());
+    }
+    endPhase("scale");
+    lithophane.setImage(image, topology);
+    endPhase("prepare");
+  } else if(renderSettings.isTiled()) {
+    // The tile is cut from the image while loading it
+    errorString = "Tiled jobs need to load the input image themselves.";
+    return Failed;
+  }
+
+  // Merging only reads the bands rendered by the other processes. The image
+  // is still loaded, so bands rendered from another image or with other
+  // settings are caught.
+  if(merge) {
+    QVector<bool> written(outputs.length(), false);
+    Status status = mergeBands(lithophane, written, endPhase);
+    for(int a = 0; a < outputs.length(); ++a) {
+      if(written.at(a)) {
+        stats.bytesWritten += QFileInfo(outputs.at(a).file).size();
+      }
+    }
+    return (status == Finished && !errorString.isEmpty()?Failed:status);
+  }
+
+  // Outputs found in the render cache don't need the mesh. The bands of a
+  // split render are never whole outputs, so they aren't cached.
+  bool useCache = (renderCache != nullptr && bands < 2);
+  QStringList cacheKeys;
+  QList<int> pending;
+  for(int a = 0; a < outputs.length(); ++a) {
+    if(useCache) {
+      cacheKeys.append(renderCache->key(lithophane, renderSettings, outputs.at(a).format,
+                                        (outputs.at(a).format == "gcode"?printerProfile.toJson():QJsonObject())));
+      if(renderCache->fetch(cacheKeys.last(), outputs.at(a).file)) {
+        continue;
+      }
+    }
+    pending.append(a);
+  }
+  stats.width = lithophane.width();
+  stats.height = lithophane.height();
+  if(useCache) {
+    endPhase("cache");
+  }
+  if(pending.isEmpty()) {
+    cached = true;
+    return Finished;
+  }
+
+  QList<RenderOutput> pendingOutputs;
+  for(const auto &a: pending) {
+    pendingOutputs.append(outputs.at(a));
+  }
+  QVector<bool> written(pendingOutputs.length(), false);
+  if(checkpointed) {
+    Status status = renderCheckpointed(lithophane, pendingOutputs, written, endPhase);
+    if(status != Finished) {
+      return status;
+    }
+  } else if(renderPlan.strategy == RenderPlan::Banded) {
+    // Each band is validated and written to all outputs as soon as it is
+    // rendered, so the mesh is never held as a whole
+    {
+      TRACE_SCOPE("mesh");
+      auto producer = [this, &lithophane](const std::function<bool(const Mesh &)> &sink) {
+        return lithophane.renderBands(renderSettings, renderPlan.bandRows, sink);
+      };
+      written = streamOutputs(pendingOutputs, lithophane, producer);
+    }
+    endPhase("mesh");
+    if(lithophane.isCancelled()) {
+      return Cancelled;
+    }
+  } else {
+    Mesh mesh;
+    {
+      TRACE_SCOPE("mesh");
+      mesh = lithophane.render(renderSettings);
+    }
+    TrackedBuffer meshBuffer(MemoryStats::Mesh, mesh.memory());
+    endPhase("mesh");
+    if(lithophane.isCancelled()) {
+      return Cancelled;
+    }
+    Status status = writeMesh(mesh, pendingOutputs, written, endPhase);
+    if(status != Finished) {
+      return status;
+    }
+  }
+  for(int a = 0; a < pending.length(); ++a) {
+    if(!written.at(a)) {
+      continue;
+    }
+    stats.bytesWritten += QFileInfo(outputs.at(pending.at(a)).file).size();
+    if(useCache) {
+      renderCache->store(cacheKeys.at(pending.at(a)), outputs.at(pending.at(a)).file);
+    }
+  }
+
+  return (errorString.isEmpty()?Finished:Failed);
+}
+
+RenderJob::Status RenderJob::renderCheckpointed(Lithophane &lithophane, const QList<RenderOutput> &outputs,
+                                                QVector<bool> &written,
+                                                const std::function<void(const QString &)> &endPhase)
+{
+  // Bands are kept small, so an interrupted render loses little work, and
+  // within the memory budget if there is one
+  int bandRows = qMax(1, (int)(checkpointBandPixels / lithophane.width()));
+  if(renderPlan.strategy == RenderPlan::Banded) {
+    bandRows = qMin(bandRows, renderPlan.bandRows);
+  }
+  int rows = (lithophane.width() < 2?0:lithophane.height() - 1);
+
+  // A split render gives each process an equal share of the bands, the last
+  // one also rendering the backside and frame
+  int firstRow = 0;
+  int stopRow = -1;
+  if(bands > 1) {
+    bandRows = qMin(bandRows, qMax(1, rows / bands));
+    int bandCount = (rows + bandRows - 1) / bandRows;
+    if(bandCount < bands) {
+      errorString = "Input image is too small to be split into " + QString::number(bands) + " bands.";
+      return Failed;
+    }
+    firstRow = (bandCount * band / bands) * bandRows;
+    if(band < bands - 1) {
+      stopRow = (bandCount * (band + 1) / bands) * bandRows;
+    }
+  }
+  RenderCheckpoint renderCheckpoint(checkpointDirectory(band));
+  int resumeRow = renderCheckpoint.open(RenderCheckpoint::key(lithophane, renderSettings), rows, bandRows,
+                                        firstRow, stopRow);
+  if(resumeRow < 0) {
+    errorString = renderCheckpoint.errorString();
+    return Failed;
+  }
+  stats.resumedRows = resumeRow - firstRow;
+  endPhase("checkpoint");
+
+  // A cancelled render keeps its checkpoint, so it resumes where it stopped
+  {
+    TRACE_SCOPE("mesh");
+    auto sink = [&renderCheckpoint](const Mesh &part) {
+      return renderCheckpoint.addPart(part);
+    };
+    if(!lithophane.renderBands(renderSettings, bandRows, sink, resumeRow, stopRow)) {
+      if(lithophane.isCancelled()) {
+        return Cancelled;
+      }
+      errorString = renderCheckpoint.errorString();
+      return Failed;
+    }
+  }
+  endPhase("mesh");
+  facets = renderCheckpoint.facets();
+  // The bands of a split render are merged once all processes are done
+  if(bands > 1) {
+    return Finished;
+  }
+
+  // The checkpoint is kept until all outputs are written
+  auto producer = [this, &renderCheckpoint](const std::function<bool(const Mesh &)> &sink) {
+    if(!renderCheckpoint.readParts(sink)) {
+      if(errorString.isEmpty()) {
+        errorString = renderCheckpoint.errorString();
+      }
+      return false;
+    }
+    return true;
+  };
+  // A checkpoint failing validation is kept, since rendering it again gives
+  // the same mesh. The error names the problems to look into.
+  Status status = writeParts(lithophane, outputs, producer, written, endPhase);
+  if(status == Finished && errorString.isEmpty() && !written.contains(false)) {
+    renderCheckpoint.remove();
+  }
+
+  return status;
+}
+
+RenderJob::Status RenderJob::mergeBands(Lithophane &lithophane, QVector<bool> &written,
+                                        const std::function<void(const QString &)> &endPhase)
+{
+  // The bands must all be finished, follow on from each other and come
+  // from the image and settings of this job
+  QString key = RenderCheckpoint::key(lithophane, renderSettings);
+  QList<RenderCheckpoint> checkpoints;
+  for(int a = 0; a < bands; ++a) {
+    checkpoints.append(RenderCheckpoint(checkpointDirectory(a)));
+    RenderCheckpoint &bandCheckpoint = checkpoints.last();
+    QString name = "Band " + QString::number(a + 1) + " of " + QString::number(bands);
+    if(!bandCheckpoint.read() || !bandCheckpoint.isComplete()) {
+      errorString = name + " is not finished.";
+      return Failed;
+    }
+    if(bandCheckpoint.jobKey() != key ||
+       bandCheckpoint.firstRow() != (a == 0?0:checkpoints.at(a - 1).stopRow()) ||
+       bandCheckpoint.isLast() != (a == bands - 1)) {
+      errorString = name + " was rendered from another image, with other settings or split differently.";
+      return Failed;
+    }
+  }
+  endPhase("checkpoint");
+
+  auto producer = [this, &checkpoints](const std::function<bool(const Mesh &)> &sink) {
+    for(auto &bandCheckpoint: checkpoints) {
+      if(!bandCheckpoint.readParts(sink)) {
+        if(errorString.isEmpty()) {
+          errorString = bandCheckpoint.errorString();
+        }
+        return false;
+      }
+    }
+    return true;
+  };
+  Status status = writeParts(lithophane, outputs, producer, written, endPhase);
+  if(status == Finished && errorString.isEmpty() && !written.contains(false)) {
+    QDir(outputs.first().file + ".bands").removeRecursively();
+  }
+
+  return status;
+}
+
+RenderJob::Status RenderJob::writeParts(Lithophane &lithophane, const QList<RenderOutput> &outputs,
+                                        const std::function<bool(const std::function<bool(const Mesh &)> &)> &producer,
+                                        QVector<bool> &written,
+                                        const std::function<void(const QString &)> &endPhase)
+{
+  // STL outputs are validated and written one part at a time, for the
+  // indexed formats the parts are joined into the whole mesh first, which is
+  // validated as a whole and welded when exported
+  if(isStreamable()) {
+    {
+      TRACE_SCOPE("export");
+      written = streamOutputs(outputs, lithophane, producer);
+    }
+    endPhase("export");
+    return (lithophane.isCancelled()?Cancelled:Finished);
+  }
+
+  Mesh mesh;
+  auto join = [&mesh](const Mesh &part) {
+    mesh.append(part);
+    return true;
+  };
+  if(!producer(join)) {
+    return Failed;
+  }
+  TrackedBuffer meshBuffer(MemoryStats::Mesh, mesh.memory());
+  endPhase("stitch");
+
+  return writeMesh(mesh, outputs, written, endPhase);
+}
+
+QString RenderJob::checkpointDirectory(const int &band) const
+{
+  if(bands > 1) {
+    return QDir(outputs.first().file + ".bands").filePath("band" + QString::number(band + 1));
+  }
+  return outputs.first().file + ".checkpoint";
+}
+
+QVector<bool> RenderJob::streamOutputs(const QList<RenderOutput> &outputs, const Lithophane &lithophane,
+                                       const std::function<bool(const std::function<bool(const Mesh &)> &)> &producer)
+{
+  QVector<bool> written(outputs.length(), false);
+  QList<QSharedPointer<Exporter> > exporters;
+  for(const auto &output: outputs) {
+    exporters.append(QSharedPointer<Exporter>(Exporter::create(output.format, printerProfile)));
+    if(!exporters.last()->beginStream(output.file + ".part")) {
+      exporters.removeLast();
+      errorString = "Output file '" + output.file + "' could not be opened for writing.";
+      break;
+    }
+  }
+  // Each part is validated before it is written, carrying the edges it
+  // leaves open over to the parts that follow, so the mesh is validated
+  // without ever being held as a whole
+  facets = 0;
+  validation = MeshValidation();
+  if(errorString.isEmpty()) {
+    auto sink = [this, &exporters](const Mesh &part) {
+      facets += part.facetCount();
+      if(validate) {
+        TRACE_SCOPE("validate");
+        if(!validation.addPart(part)) {
+          errorString = "Mesh validation failed: " + validation.report();
+          return false;
+        }
+      }
+      for(const auto &exporter: exporters) {
+        if(!exporter->streamMesh(part)) {
+          return false;
+        }
+      }
+      return true;
+    };
+    if(!producer(sink)) {
+      if(!lithophane.isCancelled() && errorString.isEmpty()) {
+        errorString = "Output files could not be written.";
+      }
+    } else if(validate) {
+      validation.finishParts();
+      if(!validation.isValid()) {
+        errorString = "Mesh validation failed: " + validation.report();
+      }
+    }
+  }
+  for(int a = 0; a < exporters.length(); ++a) {
+    QString partFile = outputs.at(a).file + ".part";
+    if(exporters.at(a)->endStream() && errorString.isEmpty() && !lithophane.isCancelled()) {
+      QFile::remove(outputs.at(a).file);
+      written[a] = QFile::rename(partFile, outputs.at(a).file);
+    }
+    if(!written.at(a)) {
+      QFile::remove(partFile);
+    }
+  }
+  if(errorString.isEmpty() && written.contains(false) && !lithophane.isCancelled()) {
+    errorString = "Output files could not be written.";
+  }
+
+  return written;
+}
+
+RenderJob::Status RenderJob::writeMesh(const Mesh &mesh, const QList<RenderOutput> &outputs,
+                                       QVector<bool> &written,
+                                       const std::function<void(const QString &)> &endPhase)
+{
+  facets = mesh.facetCount();
+  if(validate) {
+    TRACE_SCOPE("validate");
+    validation = MeshValidation::check(mesh);
+    endPhase("validate");
+    if(!validation.isValid()) {
+      errorString = "Mesh validation failed: " + validation.report();
+      return Failed;
+    }
+  }
+  written = writeOutputs(mesh, outputs, errorString, printerProfile);
+  endPhase("export");
+
+  return Finished;
+}
+
+QVector<bool> RenderJob::writeOutputs(Mesh mesh, const QList<RenderOutput> &outputs,
+                                      QString &errorString, const PrinterProfile &printerProfile)
+{
+  QVector<bool> written(outputs.length(), false);
+  QList<QSharedPointer<Exporter> > exporters;
+  int indexed = 0;
+  for(const auto &output: outputs) {
+    exporters.append(QSharedPointer<Exporter>(Exporter::create(output.format, printerProfile)));
+    if(exporters.last().isNull()) {
+      errorString = "Unknown export format '" + output.format + "'.";
+      return written;
+    }
+    if(exporters.last()->indexed()) {
+      indexed++;
+    }
+  }
+  if(outputs.isEmpty()) {
+    return written;
+  }
+
+  // The indexed formats each weld the mesh. If several of them are
+  // requested it is welded once up front instead.
+  TrackedBuffer weldedBuffer(MemoryStats::Mesh);
+  if(indexed > 1) {
+    TRACE_SCOPE("weld");
+    mesh = mesh.welded();
+    weldedBuffer.resize(mesh.memory());
+  }
+
+  // All outputs are written concurrently from the same mesh, the first one
+  // on this thread
+  std::vector<char> results(outputs.length(), 0);
+  std::vector<std::thread> writers;
+  for(int a = 1; a < outputs.length(); ++a) {
+    writers.emplace_back([&, a]() {
+        results[a] = exportMesh(mesh, outputs.at(a).file, exporters.at(a).data());
+      });
+  }
+  results[0] = exportMesh(mesh, outputs.at(0).file, exporters.at(0).data());
+  for(auto &writer: writers) {
+    writer.join();
+  }
+
+  for(int a = 0; a < outputs.length(); ++a) {
+    written[a] = results[a];
+    if(!results[a]) {
+      errorString = "Output file '" + outputs.at(a).file + "' could not be opened for writing.";
+    }
+  }
+
+  return written;
+}
+
+bool RenderJob::exportMesh(const Mesh &mesh, const QString &outputFile, Exporter *exporter)
+{
+  // Export to a temporary file and rename it into place. An interrupted
+  // export then never leaves a partial output behind, and an output that is
+  // hard linked to a render cache entry is replaced instead of overwritten.
+  TRACE_SCOPE("export");
+  QString partFile = outputFile + ".part";
+  bool success = exporter->exportMesh(mesh, partFile);
+  if(success) {
+    QFile::remove(outputFile);
+    success = QFile::rename(partFile, outputFile);
+  }
+  if(!success) {
+    QFile::remove(partFile);
+  }
+
+  return success;
+}
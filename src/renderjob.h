@@ -0,0 +1,179 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderjob.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __RENDERJOB_H__
+#define __RENDERJOB_H__
+
+#include <functional>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QRect>
+#include <QSize>
+
+#include "rendersettings.h"
+#include "rendercache.h"
+#include "lithophane.h"
+#include "exporter.h"
+#include "meshvalidation.h"
+#include "printerprofile.h"
+#include "renderstats.h"
+
+struct RenderOutput
+{
+  QString file;
+  QString format;
+};
+
+// How a job renders its image within a memory budget
+struct RenderPlan
+{
+  enum Strategy {
+    // The whole mesh is rendered and then exported
+    InMemory,
+    // The mesh is rendered in bands of rows and streamed to the outputs
+    Banded,
+    // The image is scaled down until the whole mesh fits
+    Downscaled
+  };
+
+  Strategy strategy = InMemory;
+  // The size the image is rendered at. Empty if not even decoding the image
+  // fits the budget.
+  QSize size;
+  int bandRows = 0;
+  // Estimated peak memory use
+  qint64 memory = 0;
+
+  bool isValid() const;
+  QString name() const;
+};
+
+// A snapshot of everything needed to render one image into one or more
+// output files, so the job can run in the background while the settings
+// change. The mesh is rendered once and written to all outputs.
+class RenderJob
+{
+public:
+  enum Status {
+    Finished,
+    Cancelled,
+    Failed
+  };
+
+  // Adds the output and one output per additional format next to it, named
+  // after the output with the suffix of the format
+  void addOutputs(const QString &outputFile, const QString &format,
+                  const QStringList &additionalFormats = QStringList());
+  QStringList outputFiles() const;
+  // Splits a tiled job into one job per tile, row by row from the top, with
+  // the outputs named after the tile. Untiled jobs are returned as is.
+  QList<RenderJob> tiles() const;
+  // The part of the image a tile covers. All tiles get the same number of
+  // pixels, so they share the same scale when rendered at the same width.
+  static QRect tileRect(const QSize &imageSize, const RenderSettings &renderSettings);
+  // Picks how to render an image within the memory budget. The decoded size
+  // is the size of the image as loaded, or empty if it is already prepared,
+  // the render size its size after scaling and tiling. Tiling is never
+  // picked, since it changes the printed result.
+  static RenderPlan plan(const QSize &decodedSize, const QSize &renderSize,
+                         const bool &streamable, const bool &indexed,
+                         const qint64 &maxMemory);
+  // Whether all outputs can be written in bands and the settings allow it
+  bool isStreamable() const;
+  bool isIndexed() const;
+  Status run(Lithophane &lithophane);
+  // Writes an already rendered mesh to all outputs concurrently and returns
+  // which of them were written
+  static QVector<bool> writeOutputs(Mesh mesh, const QList<RenderOutput> &outputs,
+                                    QString &errorString,
+                                    const PrinterProfile &printerProfile = PrinterProfile());
+
+  QString inputFile;
+  QList<RenderOutput> outputs;
+  RenderSettings renderSettings;
+  int maxSize = 0;
+  // Peak memory the job may use in bytes, 0 for no limit. Images that don't
+  // fit are rendered in bands or scaled down.
+  qint64 maxMemory = 0;
+  // Renders in bands checkpointed to a directory next to the first output,
+  // so running the job again after it was interrupted resumes from the last
+  // band written. Solid meshes can't be checkpointed and fail the job.
+  bool checkpoint = false;
+  // Splits the render into this many equal shares of bands for separate
+  // processes, local or on other hosts sharing the output directory. The
+  // job then only renders its own share, counted from 0, checkpointed to a
+  // directory next to the first output. A job with merge set writes the
+  // outputs from the shares once they are all rendered.
+  int bands = 1;
+  int band = 0;
+  bool merge = false;
+  RenderCache *renderCache = nullptr;
+  // Only used by the G-code format
+  PrinterProfile printerProfile;
+  // Meshes failing validation are never exported. Always on in the batch
+  // modes, optional in the ui.
+  bool validate = true;
+  // Receives the statistics of the job when it ends, if set
+  StatsLog *statsLog = nullptr;
+  // Threads of the parallel loops of the job, 0 for one per core. Modes
+  // running several jobs at once give each its share of the cores.
+  int threads = 0;
+
+  // Results
+  QString errorString;
+  int facets = 0;
+  bool cached = false;
+  MeshValidation validation;
+  RenderStats stats;
+  RenderPlan renderPlan;
+
+private:
+  Status render(Lithophane &lithophane);
+  Status renderCheckpointed(Lithophane &lithophane, const QList<RenderOutput> &outputs,
+                            QVector<bool> &written,
+                            const std::function<void(const QString &)> &endPhase);
+  Status mergeBands(Lithophane &lithophane, QVector<bool> &written,
+                    const std::function<void(const QString &)> &endPhase);
+  // Writes the parts the producer hands to its sink to the outputs, either
+  // as they come or joined into one mesh
+  Status writeParts(Lithophane &lithophane, const QList<RenderOutput> &outputs,
+                    const std::function<bool(const std::function<bool(const Mesh &)> &)> &producer,
+                    QVector<bool> &written,
+                    const std::function<void(const QString &)> &endPhase);
+  QString checkpointDirectory(const int &band = 0) const;
+  // Writes the parts the producer hands to its sink to all outputs as they
+  // come and counts their facets
+  QVector<bool> streamOutputs(const QList<RenderOutput> &outputs, const Lithophane &lithophane,
+                              const std::function<bool(const std::function<bool(const Mesh &)> &)> &producer);
+  // Validates the mesh, if enabled, and writes it to all outputs
+  Status writeMesh(const Mesh &mesh, const QList<RenderOutput> &outputs, QVector<bool> &written,
+                   const std::function<void(const QString &)> &endPhase);
+  static bool exportMesh(const Mesh &mesh, const QString &outputFile, Exporter *exporter);
+};
+
+#endif // __RENDERJOB_H__
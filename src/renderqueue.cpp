@@ -0,0 +1,253 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderqueue.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <QtWidgets>
+#include <QRunnable>
+#include <QThread>
+
+#include "renderqueue.h"
+
+class QueueTask : public QRunnable
+{
+public:
+  QueueTask(QObject *queue, const int &jobId, Lithophane *lithophane, const RenderJob &job)
+    : queue(queue), jobId(jobId), lithophane(lithophane), job(job)
+  {
+    // The queue deletes the task once it has handled the result
+    setAutoDelete(false);
+  }
+
+  const RenderStats &stats() const
+  {
+    return job.stats;
+  }
+
+  void run() override
+  {
+    RenderJob::Status status = job.run(*lithophane);
+    QMetaObject::invokeMethod(queue, "jobFinished", Qt::QueuedConnection,
+                              Q_ARG(int, jobId), Q_ARG(int, (int)status),
+                              Q_ARG(QString, job.errorString), Q_ARG(bool, job.cached));
+  }
+
+private:
+  QObject *queue;
+  int jobId;
+  Lithophane *lithophane;
+  RenderJob job;
+};
+
+RenderQueue::RenderQueue(QWidget *parent) : QWidget(parent)
+{
+  pool.setMaxThreadCount(QThread::idealThreadCount());
+
+  jobsTree = new QTreeWidget();
+  jobsTree->setRootIsDecorated(false);
+  jobsTree->setHeaderLabels(QStringList({tr("Input"), tr("Output"), tr("Progress"), QString()}));
+  jobsTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  jobsTree->header()->setStretchLastSection(false);
+  jobsTree->header()->setSectionResizeMode(2, QHeaderView::Stretch);
+
+  QPushButton *clearButton = new QPushButton(tr("Clear finished"));
+  connect(clearButton, &QPushButton::clicked, this, &RenderQueue::clearFinished);
+
+  QHBoxLayout *buttonLayout = new QHBoxLayout();
+  buttonLayout->addStretch();
+  buttonLayout->addWidget(clearButton);
+
+  QVBoxLayout *layout = new QVBoxLayout();
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->addWidget(new QLabel(tr("Render queue:")));
+  layout->addWidget(jobsTree);
+  layout->addLayout(buttonLayout);
+  setLayout(layout);
+}
+
+RenderQueue::~RenderQueue()
+{
+  pool.clear();
+  for(auto &entry: entries) {
+    if(entry.lithophane != nullptr) {
+      entry.lithophane->cancel();
+    }
+  }
+  pool.waitForDone();
+  for(auto &entry: entries) {
+    delete entry.task;
+    delete entry.lithophane;
+  }
+}
+
+// The job's render cache, if any, is kept until the job finishes
+void RenderQueue::addJob(const RenderJob &job, const QSharedPointer<RenderCache> &renderCache)
+{
+  int jobId = nextJobId++;
+
+  QueueEntry entry;
+  entry.lithophane = new Lithophane();
+  entry.renderCache = renderCache;
+  connect(entry.lithophane, &Lithophane::progress, this, [this, jobId](int value, int maximum) {
+      QMetaObject::invokeMethod(this, "jobProgress", Qt::QueuedConnection,
+                                Q_ARG(int, jobId), Q_ARG(int, value), Q_ARG(int, maximum));
+    }, Qt::DirectConnection);
+  RenderJob queuedJob = job;
+  queuedJob.renderCache = renderCache.data();
+  queuedJob.statsLog = &statsLog;
+  entry.task = new QueueTask(this, jobId, entry.lithophane, queuedJob);
+  entry.outputFiles = job.outputFiles();
+
+  QStringList outputNames;
+  for(const auto &outputFile: entry.outputFiles) {
+    outputNames.append(QFileInfo(outputFile).fileName());
+  }
+  entry.item = new QTreeWidgetItem(QStringList({QFileInfo(job.inputFile).fileName(),
+                                                outputNames.join(", ")}));
+  entry.item->setToolTip(0, job.inputFile);
+  entry.item->setToolTip(1, entry.outputFiles.join("\n"));
+  jobsTree->addTopLevelItem(entry.item);
+
+  entry.progressBar = new QProgressBar();
+  entry.progressBar->setMinimum(0);
+  entry.progressBar->setFormat(tr("Queued"));
+  jobsTree->setItemWidget(entry.item, 2, entry.progressBar);
+
+  entry.cancelButton = new QPushButton(tr("Cancel"));
+  connect(entry.cancelButton, &QPushButton::clicked, this, [this, jobId]() {
+      cancelJob(jobId);
+    });
+  jobsTree->setItemWidget(entry.item, 3, entry.cancelButton);
+  jobsTree->scrollToItem(entry.item);
+
+  entries.insert(jobId, entry);
+  printf("Queued '%s' for rendering to '%s'\n", job.inputFile.toStdString().c_str(),
+         entry.outputFiles.join("', '").toStdString().c_str());
+  pool.start(entry.task);
+}
+
+void RenderQueue::setStatsFile(const QString &statsFile)
+{
+  statsLog.setJsonFile(statsFile);
+}
+
+bool RenderQueue::isActive(const QStringList &outputFiles) const
+{
+  for(const auto &entry: entries) {
+    if(entry.task == nullptr) {
+      continue;
+    }
+    for(const auto &entryFile: entry.outputFiles) {
+      for(const auto &outputFile: outputFiles) {
+        if(QFileInfo(entryFile).absoluteFilePath() == QFileInfo(outputFile).absoluteFilePath()) {
+          return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+void RenderQueue::cancelJob(const int &jobId)
+{
+  if(!entries.contains(jobId) || entries.value(jobId).task == nullptr) {
+    return;
+  }
+  QueueEntry &entry = entries[jobId];
+  entry.cancelButton->setEnabled(false);
+  if(pool.tryTake(entry.task)) {
+    // Still queued, so it can be dropped right away
+    jobFinished(jobId, RenderJob::Cancelled, QString(), false);
+  } else {
+    entry.progressBar->setFormat(tr("Cancelling..."));
+    entry.lithophane->cancel();
+  }
+}
+
+void RenderQueue::jobProgress(const int &jobId, const int &value, const int &maximum)
+{
+  if(!entries.contains(jobId) || entries.value(jobId).task == nullptr) {
+    return;
+  }
+  QueueEntry &entry = entries[jobId];
+  if(entry.lithophane->isCancelled()) {
+    return;
+  }
+  entry.progressBar->setMaximum(maximum);
+  entry.progressBar->setValue(value);
+  entry.progressBar->setFormat(tr("Rendering %p%"));
+}
+
+void RenderQueue::jobFinished(const int &jobId, const int &status, const QString &errorString,
+                              const bool &cached)
+{
+  if(!entries.contains(jobId) || entries.value(jobId).task == nullptr) {
+    return;
+  }
+  QueueEntry &entry = entries[jobId];
+  QString outputFile = entry.outputFiles.join("', '");
+  if(entry.progressBar->maximum() == 0) {
+    entry.progressBar->setMaximum(1);
+  }
+  if(status == RenderJob::Finished) {
+    entry.progressBar->setValue(entry.progressBar->maximum());
+    entry.progressBar->setFormat(cached?tr("Ready! (from render cache)"):tr("Ready!"));
+    const RenderStats &stats = entry.task->stats();
+    entry.progressBar->setToolTip(stats.report());
+    entry.item->setToolTip(2, stats.report());
+    printf("Exported '%s': %s\n", outputFile.toStdString().c_str(), stats.summary().toStdString().c_str());
+    emit jobMessage(tr("Exported '%1' (%2). You can now import it in your preferred 3D printing slicer.").arg(outputFile, stats.summary()));
+  } else if(status == RenderJob::Cancelled) {
+    entry.progressBar->setFormat(tr("Cancelled"));
+    printf("Cancelled '%s'\n", outputFile.toStdString().c_str());
+  } else {
+    entry.progressBar->setFormat(tr("Failed"));
+    entry.progressBar->setToolTip(errorString);
+    printf("Failed '%s': %s\n", outputFile.toStdString().c_str(), errorString.toStdString().c_str());
+    emit jobMessage(tr("Export of '%1' failed: %2").arg(outputFile, errorString));
+  }
+  entry.cancelButton->setEnabled(false);
+
+  // Release the decoded image and mesh topology right away, the entry itself
+  // stays listed until it is cleared
+  delete entry.task;
+  delete entry.lithophane;
+  entry.task = nullptr;
+  entry.lithophane = nullptr;
+  entry.renderCache.reset();
+}
+
+void RenderQueue::clearFinished()
+{
+  for(auto it = entries.begin(); it != entries.end();) {
+    if(it.value().task == nullptr) {
+      delete it.value().item;
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
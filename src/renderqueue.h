@@ -0,0 +1,89 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderqueue.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __RENDERQUEUE_H__
+#define __RENDERQUEUE_H__
+
+#include <QWidget>
+#include <QTreeWidget>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QThreadPool>
+#include <QHash>
+#include <QSharedPointer>
+
+#include "renderjob.h"
+#include "lithophane.h"
+#include "rendercache.h"
+#include "renderstats.h"
+
+class QueueTask;
+
+struct QueueEntry
+{
+  Lithophane *lithophane = nullptr;
+  QSharedPointer<RenderCache> renderCache;
+  QueueTask *task = nullptr;
+  QStringList outputFiles;
+  QTreeWidgetItem *item = nullptr;
+  QProgressBar *progressBar = nullptr;
+  QPushButton *cancelButton = nullptr;
+};
+
+class RenderQueue : public QWidget
+{
+  Q_OBJECT
+
+public:
+  RenderQueue(QWidget *parent = nullptr);
+  ~RenderQueue();
+  void addJob(const RenderJob &job,
+              const QSharedPointer<RenderCache> &renderCache = QSharedPointer<RenderCache>());
+  bool isActive(const QStringList &outputFiles) const;
+  // Appends the statistics of every job to this file, if not empty
+  void setStatsFile(const QString &statsFile);
+
+public slots:
+  void clearFinished();
+
+signals:
+  void jobMessage(const QString &message);
+
+private slots:
+  void cancelJob(const int &jobId);
+  void jobProgress(const int &jobId, const int &value, const int &maximum);
+  void jobFinished(const int &jobId, const int &status, const QString &errorString,
+                   const bool &cached);
+
+private:
+  QThreadPool pool;
+  QTreeWidget *jobsTree;
+  QHash<int, QueueEntry> entries;
+  int nextJobId = 0;
+  StatsLog statsLog;
+};
+
+#endif // __RENDERQUEUE_H__
@@ -0,0 +1,404 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderserver.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QRunnable>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QtEndian>
+
+#include "renderserver.h"
+#include "renderjob.h"
+#include "exporter.h"
+
+constexpr quint32 maxMessageSize = 1024 * 1024;
+// Each job runs its loops on all of its cores, so a few jobs at once are
+// enough to keep them busy between the serial phases
+constexpr int defaultJobs = 2;
+
+class ServerTask : public QRunnable
+{
+public:
+  ServerTask(QObject *server, const QString &key, Lithophane *lithophane, const RenderJob &job)
+    : server(server), key(key), lithophane(lithophane), job(job)
+  {
+    // The server deletes the task once it has handled the result
+    setAutoDelete(false);
+  }
+
+  void run() override
+  {
+    RenderJob::Status status = job.run(*lithophane);
+    if(status == RenderJob::Cancelled) {
+      finish("cancelled");
+    } else if(status == RenderJob::Failed) {
+      finish("error", job.errorString);
+    } else {
+      // Outputs served from the render cache have no facet count
+      finish("finished", QString(), job.cached?-1:job.facets);
+    }
+  }
+
+private:
+  void finish(const QString &status, const QString &message = QString(), const int &facets = 0)
+  {
+    // An image scaled down to fit the memory limit must not be served to
+    // later jobs for the same input, which may render it at full size
+    bool cacheImage = (job.renderPlan.strategy != RenderPlan::Downscaled);
+    QMetaObject::invokeMethod(server, "jobFinished", Qt::QueuedConnection,
+                              Q_ARG(QString, key), Q_ARG(QString, status),
+                              Q_ARG(QString, message), Q_ARG(int, facets),
+                              Q_ARG(bool, cacheImage));
+  }
+
+  QObject *server;
+  QString key;
+  Lithophane *lithophane;
+  RenderJob job;
+};
+
+RenderServer::RenderServer(const QString &socketName, const RenderSettings &renderSettings,
+                           const QString &stlFormat)
+  : socketName(socketName), renderSettings(renderSettings), stlFormat(stlFormat)
+{
+  pool.setMaxThreadCount(qMin(defaultJobs, QThread::idealThreadCount()));
+  imageCache.setMaxCost(512);
+  connect(&server, &QLocalServer::newConnection, this, &RenderServer::newConnection);
+}
+
+RenderServer::~RenderServer()
+{
+  for(auto &job: jobs) {
+    job.lithophane->cancel();
+  }
+  pool.waitForDone();
+  for(auto &job: jobs) {
+    delete job.task;
+    delete job.lithophane;
+  }
+}
+
+void RenderServer::setMaxJobs(const int &maxJobs)
+{
+  if(maxJobs > 0) {
+    pool.setMaxThreadCount(maxJobs);
+  }
+}
+
+void RenderServer::setCacheSize(const int &megabytes)
+{
+  imageCache.setMaxCost(megabytes);
+}
+
+void RenderServer::setMaxSize(const int &maxSize)
+{
+  this->maxSize = maxSize;
+}
+
+void RenderServer::setMaxMemory(const qint64 &maxMemory)
+{
+  this->maxMemory = maxMemory;
+}
+
+void RenderServer::setRenderCache(RenderCache *renderCache)
+{
+  this->renderCache = renderCache;
+}
+
+void RenderServer::setPrinterProfile(const PrinterProfile &printerProfile)
+{
+  this->printerProfile = printerProfile;
+}
+
+void RenderServer::setStatsLog(StatsLog *statsLog)
+{
+  this->statsLog = statsLog;
+}
+
+bool RenderServer::start()
+{
+  // Remove a stale socket left behind by a server that didn't shut down cleanly
+  QLocalServer::removeServer(socketName);
+  server.setSocketOptions(QLocalServer::UserAccessOption);
+  if(!server.listen(socketName)) {
+    printf("Could not listen on '%s': %s\n", socketName.toStdString().c_str(),
+           server.errorString().toStdString().c_str());
+    return false;
+  }
+  printf("Listening on '%s' with %d render threads.\n", server.fullServerName().toStdString().c_str(),
+         pool.maxThreadCount());
+
+  return true;
+}
+
+void RenderServer::newConnection()
+{
+  while(QLocalSocket *client = server.nextPendingConnection()) {
+    buffers.insert(client, QByteArray());
+    clientIds.insert(client, nextClientId++);
+    connect(client, &QLocalSocket::readyRead, this, [this, client]() {
+        readClient(client);
+      });
+    connect(client, &QLocalSocket::disconnected, this, [this, client]() {
+        clientDisconnected(client);
+      });
+  }
+}
+
+void RenderServer::readClient(QLocalSocket *client)
+{
+  QByteArray &buffer = buffers[client];
+  buffer.append(client->readAll());
+  while(buffer.size() >= 4) {
+    quint32 length = qFromBigEndian<quint32>((const uchar *)buffer.constData());
+    if(length > maxMessageSize) {
+      sendError(client, QString(), "Message too large.");
+      client->disconnectFromServer();
+      return;
+    }
+    if((quint32)buffer.size() < 4 + length) {
+      break;
+    }
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(buffer.mid(4, length), &parseError);
+    buffer.remove(0, 4 + length);
+    if(parseError.error != QJsonParseError::NoError || !document.isObject()) {
+      sendError(client, QString(), "Message is not a JSON object.");
+      continue;
+    }
+    handleMessage(client, document.object());
+  }
+}
+
+void RenderServer::clientDisconnected(QLocalSocket *client)
+{
+  // Queued jobs are dropped right away. Running jobs are cancelled and
+  // cleaned up once they report back.
+  QStringList keys;
+  for(auto it = jobs.begin(); it != jobs.end(); ++it) {
+    if(it.value().client == client) {
+      it.value().client = nullptr;
+      keys.append(it.key());
+    }
+  }
+  for(const auto &key: keys) {
+    if(pool.tryTake(jobs.value(key).task)) {
+      jobFinished(key, "cancelled", QString(), 0);
+    } else {
+      jobs.value(key).lithophane->cancel();
+    }
+  }
+  buffers.remove(client);
+  clientIds.remove(client);
+  client->deleteLater();
+}
+
+void RenderServer::handleMessage(QLocalSocket *client, const QJsonObject &message)
+{
+  QString type = message.value("type").toString();
+  if(type == "render") {
+    startJob(client, message);
+  } else if(type == "cancel") {
+    cancelJob(client, message.value("id").toString());
+  } else {
+    sendError(client, message.value("id").toString(), "Unknown message type '" + type + "'.");
+  }
+}
+
+void RenderServer::startJob(QLocalSocket *client, const QJsonObject &message)
+{
+  QString id = message.value("id").toString();
+  QString key = jobKey(client, id);
+  if(id.isEmpty() || jobs.contains(key)) {
+    sendError(client, id, "Job id is missing or already in use.");
+    return;
+  }
+  QString inputFile = message.value("input").toString();
+  QString outputFile = message.value("output").toString();
+  if(!QFileInfo::exists(inputFile) || outputFile.isEmpty()) {
+    sendError(client, id, "Input file doesn't exist or output file is missing.");
+    return;
+  }
+  RenderSettings jobSettings = RenderSettings::fromJson(message.value("settings").toObject(), renderSettings);
+  // Additional outputs are rendered once together with the main output
+  RenderJob renderJob;
+  renderJob.addOutputs(outputFile, message.value("stlFormat").toString(stlFormat));
+  for(const auto &value: message.value("outputs").toArray()) {
+    QJsonObject output = value.toObject();
+    renderJob.outputs.append({output.value("output").toString(), output.value("stlFormat").toString(stlFormat)});
+  }
+  for(const auto &output: renderJob.outputs) {
+    if(output.file.isEmpty() || !Exporter::formats().contains(output.format)) {
+      sendError(client, id, "Output file is missing or export format '" + output.format + "' is unknown.");
+      return;
+    }
+    if(renderJob.outputFiles().count(output.file) > 1) {
+      sendError(client, id, "Output file '" + output.file + "' is given more than once.");
+      return;
+    }
+  }
+  if(jobSettings.frameBorder * 2 > jobSettings.width) {
+    sendError(client, id, "The frame border exceeds the lithophane width.");
+    return;
+  }
+  int jobMaxSize = message.value("maxSize").toInt(maxSize);
+
+  ServerJob job;
+  job.client = client;
+  job.id = id;
+  job.outputFiles = renderJob.outputFiles();
+  job.imageKey = imageKey(inputFile, jobMaxSize);
+  job.lithophane = new Lithophane();
+  if(imageCache.contains(job.imageKey)) {
+    job.lithophane->shareImage(*imageCache.object(job.imageKey));
+  }
+  // Progress is emitted from the worker thread. Only forward whole percent
+  // steps to keep the socket traffic down.
+  int lastPercent = -1;
+  connect(job.lithophane, &Lithophane::progress, this, [this, key, lastPercent](int value, int maximum) mutable {
+      int percent = (maximum > 0?(value * 100) / maximum:0);
+      if(percent != lastPercent) {
+        lastPercent = percent;
+        QMetaObject::invokeMethod(this, "jobProgress", Qt::QueuedConnection,
+                                  Q_ARG(QString, key), Q_ARG(int, value), Q_ARG(int, maximum));
+      }
+    }, Qt::DirectConnection);
+  renderJob.inputFile = inputFile;
+  renderJob.renderSettings = jobSettings;
+  renderJob.maxSize = jobMaxSize;
+  renderJob.maxMemory = maxMemory;
+  renderJob.renderCache = renderCache;
+  renderJob.printerProfile = printerProfile;
+  renderJob.statsLog = statsLog;
+  renderJob.threads = qMax(1, QThread::idealThreadCount() / pool.maxThreadCount());
+  job.task = new ServerTask(this, key, job.lithophane, renderJob);
+  jobs.insert(key, job);
+
+  QJsonObject accepted;
+  accepted.insert("type", "accepted");
+  accepted.insert("id", id);
+  send(client, accepted);
+
+  pool.start(job.task);
+}
+
+void RenderServer::cancelJob(QLocalSocket *client, const QString &id)
+{
+  QString key = jobKey(client, id);
+  if(!jobs.contains(key)) {
+    sendError(client, id, "No such job.");
+    return;
+  }
+  ServerJob &job = jobs[key];
+  if(pool.tryTake(job.task)) {
+    // Still queued, so it can be dropped right away
+    jobFinished(key, "cancelled", QString(), 0);
+  } else {
+    job.lithophane->cancel();
+  }
+}
+
+void RenderServer::jobProgress(const QString &key, const int &value, const int &maximum)
+{
+  if(!jobs.contains(key) || jobs.value(key).client == nullptr) {
+    return;
+  }
+  QJsonObject progress;
+  progress.insert("type", "progress");
+  progress.insert("id", jobs.value(key).id);
+  progress.insert("value", value);
+  progress.insert("maximum", maximum);
+  send(jobs.value(key).client, progress);
+}
+
+void RenderServer::jobFinished(const QString &key, const QString &status, const QString &message,
+                               const int &facets, const bool &cacheImage)
+{
+  if(!jobs.contains(key)) {
+    return;
+  }
+  ServerJob job = jobs.take(key);
+  if(cacheImage && !job.lithophane->isNull() && !imageCache.contains(job.imageKey)) {
+    Lithophane *cached = new Lithophane();
+    cached->shareImage(*job.lithophane);
+    imageCache.insert(job.imageKey, cached, qMax<qint64>(1, cached->imageMemory() / (1024 * 1024)));
+  }
+  if(job.client != nullptr) {
+    if(status == "error") {
+      sendError(job.client, job.id, message);
+    } else {
+      QJsonObject event;
+      event.insert("type", status);
+      event.insert("id", job.id);
+      if(status == "finished") {
+        event.insert("output", job.outputFiles.first());
+        event.insert("outputs", QJsonArray::fromStringList(job.outputFiles));
+        // Outputs served from the render cache have no facet count
+        event.insert("cached", facets < 0);
+        if(facets >= 0) {
+          event.insert("facets", facets);
+        }
+      }
+      send(job.client, event);
+    }
+  }
+  delete job.task;
+  delete job.lithophane;
+}
+
+void RenderServer::send(QLocalSocket *client, const QJsonObject &message)
+{
+  QByteArray payload = QJsonDocument(message).toJson(QJsonDocument::Compact);
+  uchar header[4];
+  qToBigEndian<quint32>(payload.size(), header);
+  client->write((const char *)header, 4);
+  client->write(payload);
+}
+
+void RenderServer::sendError(QLocalSocket *client, const QString &id, const QString &errorMessage)
+{
+  QJsonObject error;
+  error.insert("type", "error");
+  error.insert("id", id);
+  error.insert("message", errorMessage);
+  send(client, error);
+}
+
+QString RenderServer::jobKey(QLocalSocket *client, const QString &id) const
+{
+  return QString::number(clientIds.value(client)) + ":" + id;
+}
+
+QString RenderServer::imageKey(const QString &inputFile, const int &maxSize) const
+{
+  QFileInfo inputInfo(inputFile);
+  return inputInfo.absoluteFilePath() + ":" +
+    QString::number(inputInfo.lastModified().toMSecsSinceEpoch()) + ":" +
+    QString::number(inputInfo.size()) + ":" + QString::number(maxSize);
+}
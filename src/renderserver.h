@@ -0,0 +1,129 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderserver.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __RENDERSERVER_H__
+#define __RENDERSERVER_H__
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThreadPool>
+#include <QCache>
+#include <QHash>
+#include <QJsonObject>
+#include <QStringList>
+
+#include "rendersettings.h"
+#include "lithophane.h"
+#include "rendercache.h"
+#include "printerprofile.h"
+#include "renderstats.h"
+
+class ServerTask;
+
+struct ServerJob
+{
+  QLocalSocket *client = nullptr;
+  QString id;
+  QStringList outputFiles;
+  QString imageKey;
+  Lithophane *lithophane = nullptr;
+  ServerTask *task = nullptr;
+};
+
+// Accepts render jobs over a local socket and keeps the engine warm between
+// them. Messages in both directions are a 32 bit big endian byte count
+// followed by a compact JSON object.
+//
+// Client messages:
+//   {"type": "render", "id": "...", "input": "...", "output": "...",
+//    "settings": {"totalThickness": 4.0, ...}, "stlFormat": "binary",
+//    "maxSize": 2000, "outputs": [{"output": "...", "stlFormat": "3mf"}]}
+//   {"type": "cancel", "id": "..."}
+// Server events:
+//   {"type": "accepted", "id": "..."}
+//   {"type": "progress", "id": "...", "value": 10, "maximum": 100}
+//   {"type": "finished", "id": "...", "output": "...", "outputs": ["...", ...],
+//    "facets": 123}
+//   {"type": "cancelled", "id": "..."}
+//   {"type": "error", "id": "...", "message": "..."}
+class RenderServer : public QObject
+{
+  Q_OBJECT
+
+public:
+  RenderServer(const QString &socketName, const RenderSettings &renderSettings,
+               const QString &stlFormat);
+  ~RenderServer();
+  void setMaxJobs(const int &maxJobs);
+  void setCacheSize(const int &megabytes);
+  void setMaxSize(const int &maxSize);
+  void setMaxMemory(const qint64 &maxMemory);
+  void setRenderCache(RenderCache *renderCache);
+  void setPrinterProfile(const PrinterProfile &printerProfile);
+  void setStatsLog(StatsLog *statsLog);
+  bool start();
+
+private slots:
+  void newConnection();
+  void jobProgress(const QString &key, const int &value, const int &maximum);
+  void jobFinished(const QString &key, const QString &status, const QString &message,
+                   const int &facets, const bool &cacheImage = true);
+
+private:
+  void readClient(QLocalSocket *client);
+  void clientDisconnected(QLocalSocket *client);
+  void handleMessage(QLocalSocket *client, const QJsonObject &message);
+  void startJob(QLocalSocket *client, const QJsonObject &message);
+  void cancelJob(QLocalSocket *client, const QString &id);
+  void send(QLocalSocket *client, const QJsonObject &message);
+  void sendError(QLocalSocket *client, const QString &id, const QString &errorMessage);
+  QString jobKey(QLocalSocket *client, const QString &id) const;
+  QString imageKey(const QString &inputFile, const int &maxSize) const;
+
+  QString socketName;
+  RenderSettings renderSettings;
+  QString stlFormat = "binary";
+  int maxSize = 0;
+  qint64 maxMemory = 0;
+  RenderCache *renderCache = nullptr;
+  PrinterProfile printerProfile;
+  StatsLog *statsLog = nullptr;
+
+  QLocalServer server;
+  QThreadPool pool;
+  // Prepared images and their grid topology, shared with jobs rendering the
+  // same unchanged input file
+  QCache<QString, Lithophane> imageCache;
+  QHash<QLocalSocket *, QByteArray> buffers;
+  // Clients are numbered, since a new socket may reuse the address of one
+  // that disconnected while its jobs were still running
+  QHash<QLocalSocket *, quint64> clientIds;
+  quint64 nextClientId = 0;
+  QHash<QString, ServerJob> jobs;
+};
+
+#endif // __RENDERSERVER_H__
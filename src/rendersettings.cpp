@@ -0,0 +1,115 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            rendersettings.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "rendersettings.h"
+
+extern QSettings *settings;
+
+RenderSettings RenderSettings::fromConfig()
+{
+  return fromConfig(*settings);
+}
+
+RenderSettings RenderSettings::fromConfig(const QSettings &config)
+{
+  RenderSettings renderSettings;
+  renderSettings.minThickness = config.value("render/minThickness", "0.8").toFloat();
+  renderSettings.totalThickness = config.value("render/totalThickness", "4").toFloat();
+  renderSettings.frameBorder = config.value("render/frameBorder", "3").toFloat();
+  renderSettings.width = config.value("render/width", "200").toFloat();
+  renderSettings.frameSlopeFactor = config.value("render/frameSlopeFactor", "0.75").toFloat();
+  renderSettings.enableStabilizers = config.value("render/enableStabilizers", true).toBool();
+  renderSettings.permanentStabilizers = config.value("render/permanentStabilizers", false).toBool();
+  renderSettings.stabilizerThreshold = config.value("render/stabilizerThreshold", 60.0).toDouble();
+  renderSettings.stabilizerHeightFactor = config.value("render/stabilizerHeightFactor", 0.15).toDouble();
+  renderSettings.enableHangers = config.value("render/enableHangers", true).toBool();
+  renderSettings.hangers = config.value("render/hangers", "2").toInt();
+  renderSettings.solid = config.value("render/solid", false).toBool();
+  renderSettings.layerHeight = config.value("render/layerHeight", "0").toFloat();
+  renderSettings.ditherLayers = config.value("render/ditherLayers", false).toBool();
+  renderSettings.tileColumns = qMax(1, config.value("render/tileColumns", "1").toInt());
+  renderSettings.tileRows = qMax(1, config.value("render/tileRows", "1").toInt());
+  renderSettings.alignmentLips = config.value("render/alignmentLips", false).toBool();
+
+  return renderSettings;
+}
+
+RenderSettings RenderSettings::fromJson(const QJsonObject &json, const RenderSettings &defaults)
+{
+  // Uses the config key names without the 'render/' group. Missing keys keep
+  // their default value. Tiling is left as given by the defaults, since a
+  // tiled job is split into several jobs before it is rendered.
+  RenderSettings renderSettings = defaults;
+  renderSettings.minThickness = json.value("minThickness").toDouble(defaults.minThickness);
+  renderSettings.totalThickness = json.value("totalThickness").toDouble(defaults.totalThickness);
+  renderSettings.frameBorder = json.value("frameBorder").toDouble(defaults.frameBorder);
+  renderSettings.width = json.value("width").toDouble(defaults.width);
+  renderSettings.frameSlopeFactor = json.value("frameSlopeFactor").toDouble(defaults.frameSlopeFactor);
+  renderSettings.enableStabilizers = json.value("enableStabilizers").toBool(defaults.enableStabilizers);
+  renderSettings.permanentStabilizers = json.value("permanentStabilizers").toBool(defaults.permanentStabilizers);
+  renderSettings.stabilizerThreshold = json.value("stabilizerThreshold").toDouble(defaults.stabilizerThreshold);
+  renderSettings.stabilizerHeightFactor = json.value("stabilizerHeightFactor").toDouble(defaults.stabilizerHeightFactor);
+  renderSettings.enableHangers = json.value("enableHangers").toBool(defaults.enableHangers);
+  renderSettings.hangers = json.value("hangers").toInt(defaults.hangers);
+  renderSettings.solid = json.value("solid").toBool(defaults.solid);
+  renderSettings.layerHeight = json.value("layerHeight").toDouble(defaults.layerHeight);
+  renderSettings.ditherLayers = json.value("ditherLayers").toBool(defaults.ditherLayers);
+
+  return renderSettings;
+}
+
+QJsonObject RenderSettings::toJson() const
+{
+  QJsonObject json;
+  json.insert("minThickness", minThickness);
+  json.insert("totalThickness", totalThickness);
+  json.insert("frameBorder", frameBorder);
+  json.insert("width", width);
+  json.insert("frameSlopeFactor", frameSlopeFactor);
+  json.insert("enableStabilizers", enableStabilizers);
+  json.insert("permanentStabilizers", permanentStabilizers);
+  json.insert("stabilizerThreshold", stabilizerThreshold);
+  json.insert("stabilizerHeightFactor", stabilizerHeightFactor);
+  json.insert("enableHangers", enableHangers);
+  json.insert("hangers", hangers);
+  json.insert("solid", solid);
+  json.insert("layerHeight", layerHeight);
+  json.insert("ditherLayers", ditherLayers);
+  if(isTiled()) {
+    json.insert("tileColumns", tileColumns);
+    json.insert("tileRows", tileRows);
+    json.insert("alignmentLips", alignmentLips);
+    json.insert("tileColumn", tileColumn);
+    json.insert("tileRow", tileRow);
+  }
+
+  return json;
+}
+
+bool RenderSettings::isTiled() const
+{
+  return tileColumns * tileRows > 1;
+}
@@ -0,0 +1,69 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            rendersettings.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __RENDERSETTINGS_H__
+#define __RENDERSETTINGS_H__
+
+#include <QSettings>
+#include <QJsonObject>
+
+// A snapshot of all 'render/*' config values needed to mesh a lithophane.
+// Taking a snapshot allows the mesh code to run without touching the config
+// and makes it possible to render several variants of the same image.
+class RenderSettings
+{
+public:
+  static RenderSettings fromConfig();
+  static RenderSettings fromConfig(const QSettings &config);
+  static RenderSettings fromJson(const QJsonObject &json, const RenderSettings &defaults);
+  QJsonObject toJson() const;
+  bool isTiled() const;
+
+  float minThickness = 0.8;
+  float totalThickness = 4.0;
+  float frameBorder = 3.0;
+  float width = 200.0;
+  float frameSlopeFactor = 0.75;
+  bool enableStabilizers = true;
+  bool permanentStabilizers = false;
+  double stabilizerThreshold = 60.0;
+  double stabilizerHeightFactor = 0.15;
+  bool enableHangers = true;
+  int hangers = 2;
+  bool solid = false;
+  float layerHeight = 0.0;
+  bool ditherLayers = false;
+  // Tiling splits the image into a grid of panels, each rendered as its own
+  // lithophane with its own frame at the full width. The position of the
+  // tile is set per job, counting rows from the top of the image.
+  int tileColumns = 1;
+  int tileRows = 1;
+  bool alignmentLips = false;
+  int tileColumn = 0;
+  int tileRow = 0;
+};
+
+#endif // __RENDERSETTINGS_H__
@@ -0,0 +1,275 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderstats.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <sys/resource.h>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QDateTime>
+
+#include "renderstats.h"
+
+void RenderStats::addPhase(const QString &name, const qint64 &nanoseconds,
+                           const MemoryUsage &memory)
+{
+  RenderPhase phase;
+  phase.name = name;
+  phase.nanoseconds = nanoseconds;
+  phase.allocations = memory.allocations;
+  phase.allocatedBytes = memory.allocatedBytes;
+  phase.peakBytes = memory.peakBytes;
+  phases.append(phase);
+  peakHeap = qMax(peakHeap, memory.peakBytes);
+}
+
+double RenderStats::threadUtilization() const
+{
+  if(totalTime <= 0 || threads < 1) {
+    return 0.0;
+  }
+
+  return qMin(1.0, (double)cpuTime / ((double)totalTime * threads));
+}
+
+QJsonObject RenderStats::toJson() const
+{
+  QJsonObject json;
+  json.insert("time", QDateTime::currentDateTime().toString(Qt::ISODate));
+  json.insert("input", inputFile);
+  json.insert("outputs", QJsonArray::fromStringList(outputFiles));
+  json.insert("status", status);
+  json.insert("strategy", strategy);
+  json.insert("width", width);
+  json.insert("height", height);
+  json.insert("facets", facets);
+  json.insert("resumedRows", resumedRows);
+  json.insert("bytesWritten", bytesWritten);
+  QJsonObject phaseTimes;
+  QJsonObject phaseAllocations;
+  QJsonObject phaseAllocatedBytes;
+  QJsonObject phasePeaks;
+  for(const auto &phase: phases) {
+    phaseTimes.insert(phase.name, phase.nanoseconds / 1000000.0);
+    phaseAllocations.insert(phase.name, phase.allocations);
+    phaseAllocatedBytes.insert(phase.name, phase.allocatedBytes);
+    phasePeaks.insert(phase.name, phase.peakBytes);
+  }
+  json.insert("phaseMilliseconds", phaseTimes);
+  json.insert("totalMilliseconds", totalTime / 1000000.0);
+  json.insert("cpuMilliseconds", cpuTime / 1000000.0);
+  json.insert("peakRssBytes", peakRss);
+  if(MemoryStats::isCountingHeap()) {
+    json.insert("phaseAllocations", phaseAllocations);
+    json.insert("phaseAllocatedBytes", phaseAllocatedBytes);
+    json.insert("phasePeakHeapBytes", phasePeaks);
+    json.insert("allocations", allocations);
+    json.insert("allocatedBytes", allocatedBytes);
+    json.insert("peakHeapBytes", peakHeap);
+  }
+  QJsonObject buffers;
+  for(int a = 0; a < MemoryStats::BufferCount; ++a) {
+    buffers.insert(MemoryStats::name((MemoryStats::Buffer)a), bufferPeaks[a]);
+  }
+  json.insert("bufferPeakBytes", buffers);
+  json.insert("threads", threads);
+  json.insert("threadUtilization", threadUtilization());
+
+  return json;
+}
+
+QString RenderStats::summary() const
+{
+  return QString("%1 x %2 pixels, %3 facets, %4 MB written in %5 s, peak memory %6 MB")
+    .arg(width).arg(height).arg(facets).arg(bytesWritten / 1048576.0, 0, 'f', 1)
+    .arg(totalTime / 1000000000.0, 0, 'f', 2).arg(peakRss / 1048576.0, 0, 'f', 0);
+}
+
+QString RenderStats::report() const
+{
+  QStringList lines;
+  lines.append(QString("Input: %1 x %2 pixels").arg(width).arg(height));
+  lines.append("Strategy: " + strategy);
+  lines.append(QString("Facets: %1").arg(facets));
+  if(resumedRows > 0) {
+    lines.append(QString("Resumed from row %1").arg(resumedRows));
+  }
+  lines.append(QString("Written: %1 MB").arg(bytesWritten / 1048576.0, 0, 'f', 1));
+  for(const auto &phase: phases) {
+    if(MemoryStats::isCountingHeap()) {
+      lines.append(QString("%1: %2 ms, %3 allocations of %4 MB, peak heap %5 MB").arg(phase.name)
+                   .arg(phase.nanoseconds / 1000000.0, 0, 'f', 1).arg(phase.allocations)
+                   .arg(phase.allocatedBytes / 1048576.0, 0, 'f', 1).arg(phase.peakBytes / 1048576.0, 0, 'f', 1));
+    } else {
+      lines.append(QString("%1: %2 ms").arg(phase.name).arg(phase.nanoseconds / 1000000.0, 0, 'f', 1));
+    }
+  }
+  lines.append(QString("Total: %1 ms").arg(totalTime / 1000000.0, 0, 'f', 1));
+  lines.append(QString("Peak memory: %1 MB").arg(peakRss / 1048576.0, 0, 'f', 0));
+  QStringList buffers;
+  for(int a = 0; a < MemoryStats::BufferCount; ++a) {
+    buffers.append(QString("%1 %2 MB").arg(MemoryStats::name((MemoryStats::Buffer)a))
+                   .arg(bufferPeaks[a] / 1048576.0, 0, 'f', 1));
+  }
+  lines.append("Peak buffers: " + buffers.join(", "));
+  lines.append(QString("Thread utilization: %1% of %2 threads").arg(threadUtilization() * 100.0, 0, 'f', 0).arg(threads));
+
+  return lines.join("\n");
+}
+
+qint64 RenderStats::processCpuTime()
+{
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+
+  return (((qint64)usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000) +
+    (((qint64)usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000);
+}
+
+qint64 RenderStats::processPeakRss()
+{
+  // Linux reports the peak in kilobytes
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+
+  return (qint64)usage.ru_maxrss * 1024;
+}
+
+void StatsLog::setJsonFile(const QString &jsonFile)
+{
+  QMutexLocker locker(&mutex);
+  this->jsonFile = jsonFile;
+}
+
+void StatsLog::setMetricsFile(const QString &metricsFile)
+{
+  QMutexLocker locker(&mutex);
+  this->metricsFile = metricsFile;
+}
+
+bool StatsLog::isEnabled()
+{
+  QMutexLocker locker(&mutex);
+  return !jsonFile.isEmpty() || !metricsFile.isEmpty();
+}
+
+void StatsLog::add(const RenderStats &stats)
+{
+  QMutexLocker locker(&mutex);
+  if(!jsonFile.isEmpty()) {
+    QFile file(jsonFile);
+    if(file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+      file.write(QJsonDocument(stats.toJson()).toJson(QJsonDocument::Compact) + "\n");
+    } else {
+      printf("Statistics file '%s' could not be opened for writing.\n", jsonFile.toStdString().c_str());
+    }
+  }
+
+  jobs[stats.status]++;
+  for(const auto &phase: stats.phases) {
+    if(!phaseTimes.contains(phase.name)) {
+      phaseOrder.append(phase.name);
+    }
+    phaseTimes[phase.name] += phase.nanoseconds;
+    phaseAllocations[phase.name] += phase.allocations;
+    phaseAllocatedBytes[phase.name] += phase.allocatedBytes;
+    phasePeaks[phase.name] = qMax(phasePeaks.value(phase.name), phase.peakBytes);
+  }
+  for(int a = 0; a < MemoryStats::BufferCount; ++a) {
+    bufferPeaks[a] = qMax(bufferPeaks[a], stats.bufferPeaks[a]);
+  }
+  facets += stats.facets;
+  bytesWritten += stats.bytesWritten;
+  pixels += (qint64)stats.width * stats.height;
+  totalTime += stats.totalTime;
+  peakRss = qMax(peakRss, stats.peakRss);
+  last = stats;
+  if(!metricsFile.isEmpty()) {
+    writeMetrics();
+  }
+}
+
+void StatsLog::writeMetrics()
+{
+  QString metrics;
+  auto addMetric = [&metrics](const QString &name, const QString &type, const QString &help) {
+    metrics.append("# HELP " + name + " " + help + "\n");
+    metrics.append("# TYPE " + name + " " + type + "\n");
+  };
+  addMetric("lithomaker_jobs_total", "counter", "Render jobs by result.");
+  for(const auto &status: QStringList({"finished", "cached", "cancelled", "failed"})) {
+    metrics.append(QString("lithomaker_jobs_total{status=\"%1\"} %2\n").arg(status).arg(jobs.value(status)));
+  }
+  addMetric("lithomaker_pixels_total", "counter", "Input pixels rendered.");
+  metrics.append(QString("lithomaker_pixels_total %1\n").arg(pixels));
+  addMetric("lithomaker_facets_total", "counter", "Facets rendered.");
+  metrics.append(QString("lithomaker_facets_total %1\n").arg(facets));
+  addMetric("lithomaker_written_bytes_total", "counter", "Bytes written to output files.");
+  metrics.append(QString("lithomaker_written_bytes_total %1\n").arg(bytesWritten));
+  addMetric("lithomaker_job_seconds_total", "counter", "Wall time spent in render jobs.");
+  metrics.append(QString("lithomaker_job_seconds_total %1\n").arg(totalTime / 1000000000.0, 0, 'f', 6));
+  addMetric("lithomaker_phase_seconds_total", "counter", "Wall time spent in each phase of the render jobs.");
+  for(const auto &phase: phaseOrder) {
+    metrics.append(QString("lithomaker_phase_seconds_total{phase=\"%1\"} %2\n").arg(phase)
+                   .arg(phaseTimes.value(phase) / 1000000000.0, 0, 'f', 6));
+  }
+  if(MemoryStats::isCountingHeap()) {
+    addMetric("lithomaker_phase_allocations_total", "counter", "Heap allocations made in each phase of the render jobs.");
+    for(const auto &phase: phaseOrder) {
+      metrics.append(QString("lithomaker_phase_allocations_total{phase=\"%1\"} %2\n").arg(phase).arg(phaseAllocations.value(phase)));
+    }
+    addMetric("lithomaker_phase_allocated_bytes_total", "counter", "Heap memory allocated in each phase of the render jobs.");
+    for(const auto &phase: phaseOrder) {
+      metrics.append(QString("lithomaker_phase_allocated_bytes_total{phase=\"%1\"} %2\n").arg(phase).arg(phaseAllocatedBytes.value(phase)));
+    }
+    addMetric("lithomaker_phase_peak_heap_bytes", "gauge", "Most heap memory in use at once during each phase of any render job.");
+    for(const auto &phase: phaseOrder) {
+      metrics.append(QString("lithomaker_phase_peak_heap_bytes{phase=\"%1\"} %2\n").arg(phase).arg(phasePeaks.value(phase)));
+    }
+  }
+  addMetric("lithomaker_buffer_peak_bytes", "gauge", "Most memory held at once by each kind of buffer during any render job.");
+  for(int a = 0; a < MemoryStats::BufferCount; ++a) {
+    metrics.append(QString("lithomaker_buffer_peak_bytes{buffer=\"%1\"} %2\n").arg(MemoryStats::name((MemoryStats::Buffer)a)).arg(bufferPeaks[a]));
+  }
+  addMetric("lithomaker_peak_rss_bytes", "gauge", "Peak resident set size of the process.");
+  metrics.append(QString("lithomaker_peak_rss_bytes %1\n").arg(peakRss));
+  addMetric("lithomaker_last_job_seconds", "gauge", "Wall time of the most recent job.");
+  metrics.append(QString("lithomaker_last_job_seconds %1\n").arg(last.totalTime / 1000000000.0, 0, 'f', 6));
+  addMetric("lithomaker_last_job_thread_utilization", "gauge", "CPU time per core of the most recent job, from 0 to 1.");
+  metrics.append(QString("lithomaker_last_job_thread_utilization %1\n").arg(last.threadUtilization(), 0, 'f', 3));
+
+  // Replaced in one go, so the collector never reads a partial file
+  QSaveFile file(metricsFile);
+  if(!file.open(QIODevice::WriteOnly) || file.write(metrics.toUtf8()) < 0 || !file.commit()) {
+    printf("Metrics file '%s' could not be written.\n", metricsFile.toStdString().c_str());
+  }
+}
@@ -0,0 +1,132 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            renderstats.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __RENDERSTATS_H__
+#define __RENDERSTATS_H__
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QJsonObject>
+
+#include "memorystats.h"
+
+struct RenderPhase
+{
+  QString name;
+  qint64 nanoseconds = 0;
+  // Heap allocations made during the phase, only counted with glibc
+  qint64 allocations = 0;
+  qint64 allocatedBytes = 0;
+  // Most heap memory in use at once during the phase
+  qint64 peakBytes = 0;
+};
+
+// What a single render job did and how long each phase of it took. Peak
+// RSS, the CPU time behind the thread utilization and the memory figures
+// are measured for the whole process, so with several jobs running at once
+// they include the other jobs as well.
+struct RenderStats
+{
+  QString inputFile;
+  QStringList outputFiles;
+  // 'finished', 'cached', 'cancelled' or 'failed'
+  QString status;
+  // 'in-memory', 'banded' or 'downscaled', see RenderPlan, or 'split' for
+  // the bands and merge of a render split between processes
+  QString strategy = "in-memory";
+  int width = 0;
+  int height = 0;
+  int facets = 0;
+  // Rows a checkpointed render took from the parts of an earlier run
+  int resumedRows = 0;
+  qint64 bytesWritten = 0;
+  // In the order they ran
+  QList<RenderPhase> phases;
+  qint64 totalTime = 0;
+  qint64 cpuTime = 0;
+  qint64 peakRss = 0;
+  int threads = 1;
+  qint64 allocations = 0;
+  qint64 allocatedBytes = 0;
+  // Most heap memory in use at once during any phase
+  qint64 peakHeap = 0;
+  // Most memory held at once by each kind of buffer, see MemoryStats::Buffer
+  qint64 bufferPeaks[MemoryStats::BufferCount] = {};
+
+  // Takes the allocations, allocated bytes and peak of the phase from memory
+  void addPhase(const QString &name, const qint64 &nanoseconds,
+                const MemoryUsage &memory = MemoryUsage());
+  // CPU time used per available core during the job, from 0 to 1
+  double threadUtilization() const;
+  QJsonObject toJson() const;
+  // One line for status messages
+  QString summary() const;
+  // One line per value, for tooltips
+  QString report() const;
+
+  // User and system CPU time of the process in nanoseconds
+  static qint64 processCpuTime();
+  // Peak resident set size of the process in bytes
+  static qint64 processPeakRss();
+};
+
+// Collects the statistics of all jobs of a session. Each job is appended to
+// a JSON lines file, and the totals are kept in a Prometheus text file for
+// the node exporter textfile collector. Safe to use from several jobs at
+// once.
+class StatsLog
+{
+public:
+  void setJsonFile(const QString &jsonFile);
+  void setMetricsFile(const QString &metricsFile);
+  bool isEnabled();
+  void add(const RenderStats &stats);
+
+private:
+  void writeMetrics();
+
+  QString jsonFile;
+  QString metricsFile;
+  QMutex mutex;
+  QHash<QString, qint64> jobs;
+  QHash<QString, qint64> phaseTimes;
+  QHash<QString, qint64> phaseAllocations;
+  QHash<QString, qint64> phaseAllocatedBytes;
+  QHash<QString, qint64> phasePeaks;
+  qint64 bufferPeaks[MemoryStats::BufferCount] = {};
+  QStringList phaseOrder;
+  qint64 facets = 0;
+  qint64 bytesWritten = 0;
+  qint64 pixels = 0;
+  qint64 totalTime = 0;
+  qint64 peakRss = 0;
+  RenderStats last;
+};
+
+#endif // __RENDERSTATS_H__
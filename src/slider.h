@@ -43,6 +43,9 @@ public:
 public slots:
   void resetToDefault();
 
+signals:
+  void valueChanged();
+
 protected:
   
 private slots:
@@ -0,0 +1,166 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            splitrender.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+
+#include <stdio.h>
+#include <QCoreApplication>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QSharedPointer>
+#include <QThread>
+
+#include "splitrender.h"
+#include "lithophane.h"
+
+SplitRender::SplitRender(const QString &inputFile, const QString &outputFile,
+                         const RenderSettings &renderSettings, const int &bands)
+  : inputFile(inputFile), outputFile(outputFile), renderSettings(renderSettings), bands(bands)
+{
+}
+
+SplitRender::~SplitRender()
+{
+}
+
+void SplitRender::setMaxSize(const int &maxSize)
+{
+  this->maxSize = maxSize;
+}
+
+void SplitRender::setMaxMemory(const qint64 &maxMemory)
+{
+  this->maxMemory = maxMemory;
+}
+
+void SplitRender::setStlFormat(const QString &stlFormat)
+{
+  this->stlFormat = stlFormat;
+}
+
+void SplitRender::setAdditionalFormats(const QStringList &additionalFormats)
+{
+  this->additionalFormats = additionalFormats;
+}
+
+void SplitRender::setPrinterProfile(const PrinterProfile &printerProfile)
+{
+  this->printerProfile = printerProfile;
+}
+
+void SplitRender::setStatsLog(StatsLog *statsLog)
+{
+  this->statsLog = statsLog;
+}
+
+RenderJob SplitRender::job() const
+{
+  // Every process must render the same image with the same settings, or
+  // the bands won't match up when merged
+  RenderJob job;
+  job.inputFile = inputFile;
+  job.addOutputs(outputFile, stlFormat, additionalFormats);
+  job.renderSettings = renderSettings;
+  job.maxSize = maxSize;
+  job.maxMemory = maxMemory;
+  job.printerProfile = printerProfile;
+  job.statsLog = statsLog;
+  job.bands = bands;
+
+  return job;
+}
+
+int SplitRender::renderBand(const int &band)
+{
+  // Each line is printed whole, since several processes share the terminal
+  Lithophane lithophane;
+  RenderJob bandJob = job();
+  bandJob.band = band;
+  if(bandJob.run(lithophane) != RenderJob::Finished) {
+    printf("Band %d of %d failed: %s\n", band + 1, bands, bandJob.errorString.toStdString().c_str());
+    return 1;
+  }
+  if(bandJob.stats.resumedRows > 0) {
+    printf("Band %d of %d rendered, %d facets, resumed from row %d.\n", band + 1, bands,
+           bandJob.facets, bandJob.stats.resumedRows);
+  } else {
+    printf("Band %d of %d rendered, %d facets.\n", band + 1, bands, bandJob.facets);
+  }
+
+  return 0;
+}
+
+int SplitRender::merge()
+{
+  Lithophane lithophane;
+  RenderJob mergeJob = job();
+  mergeJob.merge = true;
+  if(mergeJob.run(lithophane) != RenderJob::Finished) {
+    printf("Merging %d bands failed: %s\n", bands, mergeJob.errorString.toStdString().c_str());
+    return 1;
+  }
+  printf("Merged %d bands, wrote %d facets to '%s'\n", bands, mergeJob.facets,
+         mergeJob.outputFiles().join("', '").toStdString().c_str());
+
+  return 0;
+}
+
+int SplitRender::run(const QStringList &arguments)
+{
+  // The cores are shared between the band processes, each running its
+  // OpenMP loops on its own share. With more bands than cores, only as many
+  // processes as there are cores run at once.
+  int cores = qMax(1, QThread::idealThreadCount());
+  int running = qMin(bands, cores);
+  QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+  environment.insert("OMP_NUM_THREADS", QString::number(qMax(1, cores / running)));
+  auto finished = [](const QSharedPointer<QProcess> &process) {
+    return (process->waitForFinished(-1) && process->exitStatus() == QProcess::NormalExit &&
+            process->exitCode() == 0);
+  };
+  QList<QSharedPointer<QProcess> > processes;
+  int failed = 0;
+  for(int band = 0; band < bands; ++band) {
+    // Bands take about as long each, so the oldest is waited for first
+    if(processes.length() == running) {
+      failed += (finished(processes.takeFirst())?0:1);
+    }
+    QSharedPointer<QProcess> process(new QProcess);
+    process->setProcessChannelMode(QProcess::ForwardedChannels);
+    process->setProcessEnvironment(environment);
+    process->start(QCoreApplication::applicationFilePath(),
+                   arguments.mid(1) << "--band" << QString::number(band + 1));
+    processes.append(process);
+  }
+  for(const auto &process: processes) {
+    failed += (finished(process)?0:1);
+  }
+  if(failed > 0) {
+    printf("%d of %d bands failed, run the same command again to resume them.\n", failed, bands);
+    return 1;
+  }
+
+  return merge();
+}
@@ -0,0 +1,78 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            splitrender.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+
+#ifndef __SPLITRENDER_H__
+#define __SPLITRENDER_H__
+
+#include <QString>
+#include <QStringList>
+
+#include "rendersettings.h"
+#include "renderjob.h"
+#include "printerprofile.h"
+#include "renderstats.h"
+
+// Renders one image split into bands of rows by separate processes, which
+// can run on other hosts as long as they share the output directory. Each
+// process renders its band into a '.bands' directory next to the output,
+// and the bands are then merged into the output files. Interrupted bands
+// resume from their checkpoint when run again.
+class SplitRender
+{
+public:
+  SplitRender(const QString &inputFile, const QString &outputFile,
+              const RenderSettings &renderSettings, const int &bands);
+  ~SplitRender();
+  void setMaxSize(const int &maxSize);
+  void setMaxMemory(const qint64 &maxMemory);
+  void setStlFormat(const QString &stlFormat);
+  void setAdditionalFormats(const QStringList &additionalFormats);
+  void setPrinterProfile(const PrinterProfile &printerProfile);
+  void setStatsLog(StatsLog *statsLog);
+  // Renders one band, counted from 0
+  int renderBand(const int &band);
+  int merge();
+  // Renders all bands in local processes started with the given command
+  // line arguments plus the band, then merges them
+  int run(const QStringList &arguments);
+
+private:
+  RenderJob job() const;
+
+  QString inputFile;
+  QString outputFile;
+  RenderSettings renderSettings;
+  int bands = 2;
+  int maxSize = 0;
+  qint64 maxMemory = 0;
+  QString stlFormat = "binary";
+  QStringList additionalFormats;
+  PrinterProfile printerProfile;
+  StatsLog *statsLog = nullptr;
+};
+
+#endif // __SPLITRENDER_H__
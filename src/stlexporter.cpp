@@ -0,0 +1,162 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            stlexporter.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <string.h>
+#include <fstream>
+#include <QFile>
+
+#include "stlexporter.h"
+
+StlExporter::StlExporter(const bool &binary) : binary(binary)
+{
+}
+
+QString StlExporter::name() const
+{
+  return (binary?"Binary STL":"Ascii STL");
+}
+
+QString StlExporter::suffix() const
+{
+  return "stl";
+}
+
+qint64 StlExporter::estimateSize(const qint64 &facets, const qint64 &) const
+{
+  // Ascii vertex coordinates take about seven characters each
+  if(binary) {
+    return 84 + (facets * 50);
+  }
+  return 26 + (facets * 154);
+}
+
+bool StlExporter::exportMesh(const Mesh &mesh, const QString &filename)
+{
+  return beginStream(filename) && streamMesh(mesh) && endStream();
+}
+
+bool StlExporter::canStream() const
+{
+  // Facets are written one by one without shared vertices, so the parts
+  // simply follow each other
+  return true;
+}
+
+bool StlExporter::beginStream(const QString &filename)
+{
+  polCount = 0;
+  if(!binary) {
+    asciiFile.setFileName(filename);
+    asciiFailed = false;
+    if(!asciiFile.open(QIODevice::WriteOnly)) {
+      return false;
+    }
+    writeText("solid lithophane\n");
+    return !asciiFailed;
+  }
+  binaryFile.open(filename.toStdString(), std::ios::binary);
+  if(!binaryFile.good()) {
+    return false;
+  }
+  char title[80];
+  memset(title, 0, 80);
+  strcpy(title, "lithophane");
+  binaryFile.write((char *)&title, 80);
+  // The facet count is filled in when the stream ends
+  binaryFile.write((char *)&polCount, sizeof(quint32));
+
+  return true;
+}
+
+bool StlExporter::streamMesh(const Mesh &part)
+{
+  polCount += part.facetCount();
+  if(binary) {
+    writeBinary(part);
+    return binaryFile.good();
+  }
+  writeAscii(part);
+  return !asciiFailed;
+}
+
+bool StlExporter::endStream()
+{
+  if(!binary) {
+    writeText("endsolid\n");
+    if(!asciiFile.flush()) {
+      asciiFailed = true;
+    }
+    asciiFile.close();
+    return !asciiFailed;
+  }
+  binaryFile.seekp(80);
+  binaryFile.write((char *)&polCount, sizeof(quint32));
+  binaryFile.close();
+
+  return !binaryFile.fail();
+}
+
+void StlExporter::writeBinary(const Mesh &mesh)
+{
+  quint16 attrByteCount = 0;
+  for(int a = 0; a < mesh.indices.length(); a += 3) {
+    float normal = 0.0;
+    binaryFile.write((char *)&normal, sizeof(float));
+    binaryFile.write((char *)&normal, sizeof(float));
+    binaryFile.write((char *)&normal, sizeof(float));
+    for(int b = 0; b < 3; ++b) {
+      QVector3D vertex = mesh.vertex(a + b);
+      float x = vertex.x();
+      float y = vertex.y();
+      float z = vertex.z();
+      binaryFile.write((char *)&x, sizeof(float));
+      binaryFile.write((char *)&y, sizeof(float));
+      binaryFile.write((char *)&z, sizeof(float));
+    }
+    binaryFile.write((char *)&attrByteCount, sizeof(quint16));
+  }
+}
+
+void StlExporter::writeAscii(const Mesh &mesh)
+{
+  for(int a = 0; a < mesh.indices.length(); a += 3) {
+    writeText("facet normal 0.0 0.0 0.0\n");
+    writeText("\touter loop\n");
+    for(int b = 0; b < 3; ++b) {
+      QVector3D vertex = mesh.vertex(a + b);
+      writeText("\t\tvertex " + QByteArray::number(vertex.x(), 'g') + " " + QByteArray::number(vertex.y(), 'g') + " " + QByteArray::number(vertex.z(), 'g') + "\n");
+    }
+    writeText("\tendloop\n");
+    writeText("endfacet\n");
+  }
+}
+
+void StlExporter::writeText(const QByteArray &text)
+{
+  if(asciiFile.write(text) != text.size()) {
+    asciiFailed = true;
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef __STLEXPORTER_H__
+#define __STLEXPORTER_H__
+
+#include <fstream>
+#include <QString>
+#include <QFile>
+
+#include "exporter.h"
+
+class StlExporter : public Exporter
+{
+public:
+  StlExporter(const bool &binary);
+  QString name() const override;
+  QString suffix() const override;
+  bool exportMesh(const Mesh &mesh, const QString &filename) override;
+  qint64 estimateSize(const qint64 &facets, const qint64 &vertices) const override;
+  bool canStream() const override;
+  bool beginStream(const QString &filename) override;
+  bool streamMesh(const Mesh &part) override;
+  bool endStream() override;
+
+private:
+  void writeBinary(const Mesh &mesh);
+  void writeAscii(const Mesh &mesh);
+  // Writes to the ascii file and remembers a failed write, much like the
+  // state of binaryFile
+  void writeText(const QByteArray &text);
+
+  bool binary;
+  std::ofstream binaryFile;
+  QFile asciiFile;
+  bool asciiFailed = false;
+  quint32 polCount = 0;
+};
+
+#endif // __STLEXPORTER_H__
@@ -0,0 +1,217 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            sweep.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <QImage>
+#include <QImageReader>
+#include <QFileInfo>
+#include <QDir>
+
+#include "sweep.h"
+#include "lithophane.h"
+#include "renderjob.h"
+
+Sweep::Sweep(const QString &inputFile, const QString &outputFile,
+             const RenderSettings &baseSettings)
+  : inputFile(inputFile), outputFile(outputFile), baseSettings(baseSettings)
+{
+  totalThicknesses.append(baseSettings.totalThickness);
+  minThicknesses.append(baseSettings.minThickness);
+  frameBorders.append(baseSettings.frameBorder);
+}
+
+Sweep::~Sweep()
+{
+}
+
+void Sweep::setTotalThicknesses(const QList<float> &values)
+{
+  if(!values.isEmpty()) {
+    totalThicknesses = values;
+  }
+}
+
+void Sweep::setMinThicknesses(const QList<float> &values)
+{
+  if(!values.isEmpty()) {
+    minThicknesses = values;
+  }
+}
+
+void Sweep::setFrameBorders(const QList<float> &values)
+{
+  if(!values.isEmpty()) {
+    frameBorders = values;
+  }
+}
+
+void Sweep::setMaxSize(const int &maxSize)
+{
+  this->maxSize = maxSize;
+}
+
+void Sweep::setMaxMemory(const qint64 &maxMemory)
+{
+  this->maxMemory = maxMemory;
+}
+
+void Sweep::setCheckpoint(const bool &checkpoint)
+{
+  this->checkpoint = checkpoint;
+}
+
+void Sweep::setStlFormat(const QString &stlFormat)
+{
+  this->stlFormat = stlFormat;
+}
+
+void Sweep::setAdditionalFormats(const QStringList &additionalFormats)
+{
+  this->additionalFormats = additionalFormats;
+}
+
+void Sweep::setRenderCache(RenderCache *renderCache)
+{
+  this->renderCache = renderCache;
+}
+
+void Sweep::setPrinterProfile(const PrinterProfile &printerProfile)
+{
+  this->printerProfile = printerProfile;
+}
+
+void Sweep::setStatsLog(StatsLog *statsLog)
+{
+  this->statsLog = statsLog;
+}
+
+QString Sweep::variantFilename(const RenderSettings &variant) const
+{
+  QFileInfo outputInfo(outputFile);
+  QString suffix = outputInfo.suffix().isEmpty()?"stl":outputInfo.suffix();
+  return QDir(outputInfo.path()).filePath(outputInfo.completeBaseName() +
+                                          "_t" + QString::number(variant.totalThickness) +
+                                          "_m" + QString::number(variant.minThickness) +
+                                          "_b" + QString::number(variant.frameBorder) +
+                                          "." + suffix);
+}
+
+int Sweep::run()
+{
+  // The variants only differ in thickness and border, so they all fit the
+  // memory budget the same way and share one plan made before decoding
+  RenderPlan plan;
+  QSize decodedSize = QImageReader(inputFile).size();
+  if(maxMemory > 0 && !decodedSize.isEmpty()) {
+    RenderJob job;
+    job.addOutputs(outputFile, stlFormat, additionalFormats);
+    job.renderSettings = baseSettings;
+    job.printerProfile = printerProfile;
+    QSize renderSize = decodedSize;
+    if(maxSize > 0 && (renderSize.width() > maxSize || renderSize.height() > maxSize)) {
+      renderSize.scale(maxSize, maxSize, Qt::KeepAspectRatio);
+    }
+    plan = RenderJob::plan(decodedSize, renderSize, job.isStreamable(), job.isIndexed(), maxMemory);
+    if(!plan.isValid()) {
+      printf("Input file '%s' can't be rendered within the memory limit of %lld MB.\n",
+             inputFile.toStdString().c_str(), maxMemory / (1024 * 1024));
+      return 1;
+    }
+  }
+
+  // Decode, prepare and triangulate once for all variants. PNG images used
+  // as they are skip QImage and decode straight to heights.
+  if(plan.strategy == RenderPlan::Banded) {
+    printf("Rendering in bands of %d rows to fit the memory limit.\n", plan.bandRows);
+  }
+  bool topology = (plan.strategy != RenderPlan::Banded && !checkpoint);
+  Lithophane lithophane;
+  if(plan.strategy != RenderPlan::Downscaled &&
+     (maxSize <= 0 || (decodedSize.isValid() && decodedSize.width() <= maxSize && decodedSize.height() <= maxSize))) {
+    lithophane.loadPng(inputFile, topology);
+  }
+  if(lithophane.isNull()) {
+    QImage image(inputFile);
+    if(image.isNull()) {
+      printf("Input file '%s' could not be loaded.\n", inputFile.toStdString().c_str());
+      return 1;
+    }
+    if(maxSize > 0 && (image.width() > maxSize || image.height() > maxSize)) {
+      if(image.width() > image.height()) {
+        image = image.scaledToWidth(maxSize);
+      } else {
+        image = image.scaledToHeight(maxSize);
+      }
+    }
+    if(plan.strategy == RenderPlan::Downscaled) {
+      printf("Scaling the image down to %d x %d pixels to fit the memory limit.\n",
+             plan.size.width(), plan.size.height());
+      image = image.scaled(plan.size);
+    }
+    lithophane.setImage(image, topology);
+  }
+
+  int variants = totalThicknesses.length() * minThicknesses.length() * frameBorders.length();
+  int failed = 0;
+  int current = 0;
+  for(const auto &totalThickness: totalThicknesses) {
+    for(const auto &minThickness: minThicknesses) {
+      for(const auto &frameBorder: frameBorders) {
+        current++;
+        RenderSettings variant = baseSettings;
+        variant.totalThickness = totalThickness;
+        variant.minThickness = minThickness;
+        variant.frameBorder = frameBorder;
+        QString filename = variantFilename(variant);
+        printf("Rendering variant %d of %d to '%s'... ", current, variants, filename.toStdString().c_str());
+        if(variant.frameBorder * 2 > variant.width) {
+          printf("Skipped, frame border exceeds width!\n");
+          failed++;
+          continue;
+        }
+        RenderJob job;
+        job.addOutputs(filename, stlFormat, additionalFormats);
+        job.renderSettings = variant;
+        job.maxMemory = maxMemory;
+        job.checkpoint = checkpoint;
+        job.renderCache = renderCache;
+        job.printerProfile = printerProfile;
+        job.statsLog = statsLog;
+        if(job.run(lithophane) == RenderJob::Finished) {
+          if(job.stats.resumedRows > 0) {
+            printf("Resumed from row %d, ", job.stats.resumedRows);
+          }
+          printf(job.cached?"Success, from render cache!\n":"Success!\n");
+        } else {
+          printf("Failed: %s\n", job.errorString.toStdString().c_str());
+          failed++;
+        }
+      }
+    }
+  }
+
+  return (failed == 0?0:1);
+}
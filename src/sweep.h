@@ -0,0 +1,80 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            sweep.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __SWEEP_H__
+#define __SWEEP_H__
+
+#include <QString>
+#include <QList>
+#include <QStringList>
+
+#include "rendersettings.h"
+#include "rendercache.h"
+#include "printerprofile.h"
+#include "renderstats.h"
+
+// Renders one image with every combination of a set of parameter values.
+// The image is decoded, prepared and triangulated only once. Each variant
+// then only recalculates vertex positions and frame geometry.
+class Sweep
+{
+public:
+  Sweep(const QString &inputFile, const QString &outputFile,
+        const RenderSettings &baseSettings);
+  ~Sweep();
+  void setTotalThicknesses(const QList<float> &values);
+  void setMinThicknesses(const QList<float> &values);
+  void setFrameBorders(const QList<float> &values);
+  void setMaxSize(const int &maxSize);
+  void setMaxMemory(const qint64 &maxMemory);
+  void setCheckpoint(const bool &checkpoint);
+  void setStlFormat(const QString &stlFormat);
+  void setAdditionalFormats(const QStringList &additionalFormats);
+  void setRenderCache(RenderCache *renderCache);
+  void setPrinterProfile(const PrinterProfile &printerProfile);
+  void setStatsLog(StatsLog *statsLog);
+  int run();
+
+private:
+  QString variantFilename(const RenderSettings &variant) const;
+
+  QString inputFile;
+  QString outputFile;
+  RenderSettings baseSettings;
+  QList<float> totalThicknesses;
+  QList<float> minThicknesses;
+  QList<float> frameBorders;
+  int maxSize = 0;
+  qint64 maxMemory = 0;
+  bool checkpoint = false;
+  QString stlFormat = "binary";
+  QStringList additionalFormats;
+  RenderCache *renderCache = nullptr;
+  PrinterProfile printerProfile;
+  StatsLog *statsLog = nullptr;
+};
+
+#endif // __SWEEP_H__
@@ -0,0 +1,154 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            threemfexporter.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include "threemfexporter.h"
+#include "zipwriter.h"
+#include "memorystats.h"
+
+// Vertices and triangles per compressed chunk of the model file
+constexpr int chunkSize = 65536;
+
+QString ThreeMfExporter::name() const
+{
+  return "3MF";
+}
+
+QString ThreeMfExporter::suffix() const
+{
+  return "3mf";
+}
+
+qint64 ThreeMfExporter::estimateSize(const qint64 &facets, const qint64 &vertices) const
+{
+  // About 50 characters of XML per vertex and 56 per triangle, which
+  // deflate to a little under a third
+  return 1024 + (((vertices * 50) + (facets * 56)) * 3 / 10);
+}
+
+bool ThreeMfExporter::indexed() const
+{
+  return true;
+}
+
+bool ThreeMfExporter::exportMesh(const Mesh &mesh, const QString &filename)
+{
+  Mesh model = mesh.welded();
+  // Only a copy if the mesh wasn't welded up front
+  TrackedBuffer modelBuffer(MemoryStats::Export, mesh.isWelded?0:model.memory());
+
+  // 3MF doesn't allow triangles that reference the same vertex twice
+  QVector<quint32> triangles;
+  triangles.reserve(model.indices.length());
+  for(int a = 0; a < model.indices.length(); a += 3) {
+    quint32 v1 = model.indices.at(a);
+    quint32 v2 = model.indices.at(a + 1);
+    quint32 v3 = model.indices.at(a + 2);
+    if(v1 != v2 && v2 != v3 && v1 != v3) {
+      triangles.append(v1);
+      triangles.append(v2);
+      triangles.append(v3);
+    }
+  }
+  TrackedBuffer trianglesBuffer(MemoryStats::Export, (qint64)triangles.capacity() * sizeof(quint32));
+
+  ZipWriter zip(filename);
+  if(!zip.open()) {
+    return false;
+  }
+  zip.addEntry("[Content_Types].xml",
+               "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">\n"
+               " <Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>\n"
+               " <Default Extension=\"model\" ContentType=\"application/vnd.ms-package.3dmanufacturing-3dmodel+xml\"/>\n"
+               "</Types>\n");
+  zip.addEntry("_rels/.rels",
+               "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">\n"
+               " <Relationship Target=\"/3D/3dmodel.model\" Id=\"rel0\" Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel\"/>\n"
+               "</Relationships>\n");
+
+  // The model is split into a header chunk, the vertex chunks, a chunk
+  // between vertices and triangles, the triangle chunks and a footer chunk
+  int vertexChunks = (model.vertices.length() + chunkSize - 1) / chunkSize;
+  int triangleCount = triangles.length() / 3;
+  int triangleChunks = (triangleCount + chunkSize - 1) / chunkSize;
+  auto generateChunk = [&](int chunk) -> QByteArray {
+    QByteArray data;
+    if(chunk == 0) {
+      data.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                  "<model unit=\"millimeter\" xml:lang=\"en-US\" xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\">\n"
+                  " <metadata name=\"Application\">LithoMaker " VERSION "</metadata>\n"
+                  " <resources>\n"
+                  "  <object id=\"1\" type=\"model\">\n"
+                  "   <mesh>\n"
+                  "    <vertices>\n");
+      return data;
+    }
+    chunk--;
+    if(chunk < vertexChunks) {
+      int first = chunk * chunkSize;
+      int last = qMin(first + chunkSize, model.vertices.length());
+      data.reserve((last - first) * 56);
+      for(int a = first; a < last; ++a) {
+        const QVector3D &vertex = model.vertices.at(a);
+        data.append("     <vertex x=\"" + QByteArray::number(vertex.x(), 'g') +
+                    "\" y=\"" + QByteArray::number(vertex.y(), 'g') +
+                    "\" z=\"" + QByteArray::number(vertex.z(), 'g') + "\"/>\n");
+      }
+      return data;
+    }
+    chunk -= vertexChunks;
+    if(chunk == 0) {
+      data.append("    </vertices>\n"
+                  "    <triangles>\n");
+      return data;
+    }
+    chunk--;
+    if(chunk < triangleChunks) {
+      int first = chunk * chunkSize;
+      int last = qMin(first + chunkSize, triangleCount);
+      data.reserve((last - first) * 56);
+      for(int a = first; a < last; ++a) {
+        data.append("     <triangle v1=\"" + QByteArray::number(triangles.at(a * 3)) +
+                    "\" v2=\"" + QByteArray::number(triangles.at(a * 3 + 1)) +
+                    "\" v3=\"" + QByteArray::number(triangles.at(a * 3 + 2)) + "\"/>\n");
+      }
+      return data;
+    }
+    data.append("    </triangles>\n"
+                "   </mesh>\n"
+                "  </object>\n"
+                " </resources>\n"
+                " <build>\n"
+                "  <item objectid=\"1\"/>\n"
+                " </build>\n"
+                "</model>\n");
+    return data;
+  };
+  zip.addChunkedEntry("3D/3dmodel.model", vertexChunks + triangleChunks + 3, generateChunk);
+
+  return zip.close();
+}
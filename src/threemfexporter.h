@@ -0,0 +1,46 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            threemfexporter.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __THREEMFEXPORTER_H__
+#define __THREEMFEXPORTER_H__
+
+#include <QString>
+
+#include "exporter.h"
+
+// Writes the mesh as a 3MF package, which stores each vertex once and
+// compresses the model, making it a fraction of the size of an STL
+class ThreeMfExporter : public Exporter
+{
+public:
+  QString name() const override;
+  QString suffix() const override;
+  bool indexed() const override;
+  bool exportMesh(const Mesh &mesh, const QString &filename) override;
+  qint64 estimateSize(const qint64 &facets, const qint64 &vertices) const override;
+};
+
+#endif // __THREEMFEXPORTER_H__
@@ -0,0 +1,174 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            trace.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QCoreApplication>
+
+#include "trace.h"
+
+namespace {
+// Events kept per thread, about 1.5 MB
+constexpr int bufferSize = 65536;
+
+struct TraceEvent
+{
+  const char *name;
+  qint64 start;
+  qint64 end;
+};
+
+struct ThreadBuffer
+{
+  int threadId = 0;
+  // Only ever contended while the file is written
+  QMutex mutex;
+  std::vector<TraceEvent> events;
+  qint64 recorded = 0;
+  // Guarded by buffersMutex
+  bool inUse = true;
+};
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+QMutex buffersMutex;
+// The buffers outlive their threads, so events from finished pool and
+// OpenMP threads still end up in the file. The buffer of a finished thread
+// is handed to the next thread that starts tracing, so there are never more
+// buffers than threads tracing at once, no matter how many threads the
+// daemons start and stop over time.
+std::vector<std::shared_ptr<ThreadBuffer> > buffers;
+
+// Hands the buffer back when its thread ends
+struct BufferOwner
+{
+  ~BufferOwner()
+  {
+    if(buffer) {
+      QMutexLocker locker(&buffersMutex);
+      buffer->inUse = false;
+    }
+  }
+  std::shared_ptr<ThreadBuffer> buffer;
+};
+thread_local BufferOwner threadBuffer;
+}
+
+std::atomic<bool> Trace::enabled(false);
+
+void Trace::setEnabled(const bool &enabled)
+{
+  Trace::enabled.store(enabled);
+}
+
+qint64 Trace::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::record(const char *name, const qint64 &start, const qint64 &end)
+{
+  if(!threadBuffer.buffer) {
+    QMutexLocker locker(&buffersMutex);
+    for(const auto &buffer: buffers) {
+      if(!buffer->inUse) {
+        buffer->inUse = true;
+        threadBuffer.buffer = buffer;
+        break;
+      }
+    }
+    if(!threadBuffer.buffer) {
+      threadBuffer.buffer = std::make_shared<ThreadBuffer>();
+      threadBuffer.buffer->events.resize(bufferSize);
+      threadBuffer.buffer->threadId = buffers.size() + 1;
+      buffers.push_back(threadBuffer.buffer);
+    }
+  }
+  ThreadBuffer &buffer = *threadBuffer.buffer;
+  QMutexLocker locker(&buffer.mutex);
+  buffer.events[buffer.recorded % bufferSize] = {name, start, end};
+  buffer.recorded++;
+}
+
+bool Trace::write(const QString &filename)
+{
+  int processId = QCoreApplication::applicationPid();
+  QJsonArray events;
+  QJsonObject processName;
+  processName.insert("name", QString("process_name"));
+  processName.insert("ph", QString("M"));
+  processName.insert("pid", processId);
+  QJsonObject processArgs;
+  processArgs.insert("name", QString("LithoMaker"));
+  processName.insert("args", processArgs);
+  events.append(processName);
+
+  QMutexLocker buffersLocker(&buffersMutex);
+  for(const auto &buffer: buffers) {
+    QMutexLocker locker(&buffer->mutex);
+    QJsonObject threadName;
+    threadName.insert("name", QString("thread_name"));
+    threadName.insert("ph", QString("M"));
+    threadName.insert("pid", processId);
+    threadName.insert("tid", buffer->threadId);
+    QJsonObject threadArgs;
+    threadArgs.insert("name", QString("Thread %1").arg(buffer->threadId));
+    threadName.insert("args", threadArgs);
+    events.append(threadName);
+    // Oldest event first, once the ring buffer has wrapped around
+    qint64 first = qMax((qint64)0, buffer->recorded - bufferSize);
+    for(qint64 a = first; a < buffer->recorded; ++a) {
+      const TraceEvent &traceEvent = buffer->events.at(a % bufferSize);
+      QJsonObject event;
+      event.insert("name", QString::fromLatin1(traceEvent.name));
+      event.insert("ph", QString("X"));
+      event.insert("pid", processId);
+      event.insert("tid", buffer->threadId);
+      // Microseconds, as the trace-event format wants
+      event.insert("ts", traceEvent.start / 1000.0);
+      event.insert("dur", (traceEvent.end - traceEvent.start) / 1000.0);
+      events.append(event);
+    }
+  }
+  buffersLocker.unlock();
+
+  QJsonObject json;
+  json.insert("traceEvents", events);
+  json.insert("displayTimeUnit", QString("ms"));
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+
+  return true;
+}
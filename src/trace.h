@@ -0,0 +1,82 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            trace.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <atomic>
+#include <QString>
+
+// Scoped trace instrumentation for finding out where the time of a render
+// goes. Every thread records its events in a ring buffer of its own, which
+// keeps the most recent events, and the buffers can be written as a Chrome
+// trace-event JSON file for loading in Perfetto or chrome://tracing. While
+// tracing is disabled a scope costs a single relaxed atomic load.
+class Trace
+{
+public:
+  static void setEnabled(const bool &enabled);
+  static inline bool isEnabled()
+  {
+    return enabled.load(std::memory_order_relaxed);
+  }
+  // Nanoseconds since the process started tracing
+  static qint64 now();
+  // Names must be string literals, since only the pointer is kept
+  static void record(const char *name, const qint64 &start, const qint64 &end);
+  // Writes the events of all threads, including threads that have ended.
+  // Threads started after one has ended record into its buffer and show up
+  // as the same thread in the file.
+  static bool write(const QString &filename);
+
+private:
+  static std::atomic<bool> enabled;
+};
+
+class TraceScope
+{
+public:
+  TraceScope(const char *name) : name(name), start(Trace::isEnabled()?Trace::now():-1)
+  {
+  }
+  ~TraceScope()
+  {
+    if(start >= 0) {
+      Trace::record(name, start, Trace::now());
+    }
+  }
+
+private:
+  const char *name;
+  qint64 start;
+};
+
+#define TRACE_CONCAT(a, b) a##b
+#define TRACE_VARIABLE(line) TRACE_CONCAT(traceScope, line)
+// Traces the rest of the enclosing block under the given name
+#define TRACE_SCOPE(name) TraceScope TRACE_VARIABLE(__LINE__)(name)
+
+#endif // __TRACE_H__
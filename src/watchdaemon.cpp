@@ -0,0 +1,309 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            watchdaemon.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QRunnable>
+#include <QThread>
+
+#include "watchdaemon.h"
+#include "lithophane.h"
+#include "renderjob.h"
+#include "exporter.h"
+
+constexpr int settleInterval = 1000;
+constexpr int rescanInterval = 10000;
+// Each job runs its loops on all of its cores, so a few jobs at once are
+// enough to keep them busy between the serial phases
+constexpr int defaultJobs = 2;
+
+class WatchTask : public QRunnable
+{
+public:
+  WatchTask(QObject *daemon, const RenderJob &job) : daemon(daemon), job(job)
+  {
+  }
+
+  void run() override
+  {
+    Lithophane lithophane;
+    bool success = (job.run(lithophane) == RenderJob::Finished);
+    QMetaObject::invokeMethod(daemon, "jobFinished", Qt::QueuedConnection,
+                              Q_ARG(QString, job.inputFile), Q_ARG(bool, success),
+                              Q_ARG(QString, job.errorString));
+  }
+
+private:
+  QObject *daemon;
+  RenderJob job;
+};
+
+WatchDaemon::WatchDaemon(const QStringList &inputDirs, const QString &outputDir,
+                         const RenderSettings &renderSettings, const QString &stlFormat)
+  : inputDirs(inputDirs), outputDir(outputDir), renderSettings(renderSettings), stlFormat(stlFormat)
+{
+  maxJobs = qMin(defaultJobs, QThread::idealThreadCount());
+  // Default to half of the physical memory
+  memoryLimit = ((qint64)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE)) / 2;
+
+  settleTimer.setSingleShot(true);
+  settleTimer.setInterval(settleInterval);
+  rescanTimer.setInterval(rescanInterval);
+
+  connect(&watcher, &QFileSystemWatcher::directoryChanged, this, &WatchDaemon::directoryChanged);
+  connect(&settleTimer, &QTimer::timeout, this, &WatchDaemon::scan);
+  // Catches in-place overwrites, which don't trigger a directory change
+  connect(&rescanTimer, &QTimer::timeout, this, &WatchDaemon::scan);
+}
+
+WatchDaemon::~WatchDaemon()
+{
+  pool.waitForDone();
+}
+
+void WatchDaemon::setMaxJobs(const int &maxJobs)
+{
+  if(maxJobs > 0) {
+    this->maxJobs = maxJobs;
+  }
+}
+
+void WatchDaemon::setMemoryLimit(const qint64 &memoryLimit)
+{
+  if(memoryLimit > 0) {
+    this->memoryLimit = memoryLimit;
+  }
+}
+
+void WatchDaemon::setMaxSize(const int &maxSize)
+{
+  this->maxSize = maxSize;
+}
+
+void WatchDaemon::setMaxMemory(const qint64 &maxMemory)
+{
+  this->maxMemory = maxMemory;
+}
+
+void WatchDaemon::setAdditionalFormats(const QStringList &additionalFormats)
+{
+  this->additionalFormats = additionalFormats;
+}
+
+void WatchDaemon::setRenderCache(RenderCache *renderCache)
+{
+  this->renderCache = renderCache;
+}
+
+void WatchDaemon::setPrinterProfile(const PrinterProfile &printerProfile)
+{
+  this->printerProfile = printerProfile;
+}
+
+void WatchDaemon::setStatsLog(StatsLog *statsLog)
+{
+  this->statsLog = statsLog;
+}
+
+bool WatchDaemon::start()
+{
+  if(!QDir().mkpath(outputDir)) {
+    printf("Output directory '%s' could not be created.\n", outputDir.toStdString().c_str());
+    return false;
+  }
+  // With several directories the outputs are named after the directory
+  // too, so two of them can't share a name
+  QStringList dirNames;
+  for(const auto &inputDir: inputDirs) {
+    QString dirName = QDir(QDir(inputDir).absolutePath()).dirName();
+    if(dirNames.contains(dirName)) {
+      printf("Watched directories must have different names, '%s' is given twice.\n", dirName.toStdString().c_str());
+      return false;
+    }
+    dirNames.append(dirName);
+  }
+  for(const auto &inputDir: inputDirs) {
+    if(!QFileInfo(inputDir).isDir() || !watcher.addPath(inputDir)) {
+      printf("Input directory '%s' could not be watched.\n", inputDir.toStdString().c_str());
+      return false;
+    }
+    printf("Watching '%s'\n", inputDir.toStdString().c_str());
+  }
+  pool.setMaxThreadCount(maxJobs);
+  printf("Rendering into '%s' using at most %d jobs and %lld MB of memory.\n",
+         outputDir.toStdString().c_str(), maxJobs, memoryLimit / (1024 * 1024));
+
+  rescanTimer.start();
+  scan();
+
+  return true;
+}
+
+void WatchDaemon::directoryChanged(const QString &)
+{
+  // Restart the timer so bursts of changes only trigger a single scan
+  settleTimer.start();
+}
+
+QString WatchDaemon::outputFilename(const QString &inputFile) const
+{
+  // Images from several directories are prefixed with the name of their
+  // directory, so 'a/photo.png' and 'b/photo.png' don't share an output
+  QFileInfo inputInfo(inputFile);
+  QString prefix = (inputDirs.length() > 1?inputInfo.absoluteDir().dirName() + "_":QString());
+  return QDir(outputDir).filePath(prefix + inputInfo.completeBaseName() + "." + Exporter::suffix(stlFormat));
+}
+
+bool WatchDaemon::isUpToDate(const QString &inputFile) const
+{
+  // Every output of the job must be there, so an image is rendered again
+  // if an additional format was added or one of its files was removed
+  RenderJob job;
+  job.addOutputs(outputFilename(inputFile), stlFormat, additionalFormats);
+  QDateTime inputModified = QFileInfo(inputFile).lastModified();
+  for(const auto &outputFile: job.outputFiles()) {
+    QFileInfo outputInfo(outputFile);
+    if(!outputInfo.exists() || outputInfo.lastModified() < inputModified) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void WatchDaemon::scan()
+{
+  QHash<QString, QPair<qint64, QDateTime> > seen;
+  // Images sharing an output, such as 'photo.png' and 'photo.PNG', would
+  // overwrite each other. The first by name is rendered, the others are
+  // left out with a warning.
+  QHash<QString, QString> claimed;
+  for(const auto &inputDir: inputDirs) {
+    for(const auto &inputInfo: QDir(inputDir).entryInfoList(QStringList({"*.png", "*.PNG"}), QDir::Files, QDir::Name)) {
+      QString inputFile = inputInfo.absoluteFilePath();
+      QString outputFile = outputFilename(inputFile);
+      if(claimed.contains(outputFile) && claimed.value(outputFile) != inputFile) {
+        if(!collisions.contains(inputFile)) {
+          collisions.insert(inputFile);
+          printf("Skipping '%s', its output '%s' is already rendered from '%s'.\n",
+                 inputFile.toStdString().c_str(), outputFile.toStdString().c_str(),
+                 claimed.value(outputFile).toStdString().c_str());
+        }
+        continue;
+      }
+      claimed.insert(outputFile, inputFile);
+      collisions.remove(inputFile);
+      if(running.contains(inputFile) || isUpToDate(inputFile) ||
+         (failed.contains(inputFile) && failed.value(inputFile) == inputInfo.lastModified())) {
+        continue;
+      }
+      // Jobs are matched by output as well, so two jobs never write the same
+      // files at once
+      bool queued = false;
+      for(const auto &job: queue + running.values()) {
+        if(job.inputFile == inputFile || job.outputFile == outputFile) {
+          queued = true;
+          break;
+        }
+      }
+      if(queued) {
+        continue;
+      }
+      // Only pick up files that haven't changed since the previous scan, so
+      // files that are still being copied into the directory are left alone
+      QPair<qint64, QDateTime> state(inputInfo.size(), inputInfo.lastModified());
+      if(candidates.contains(inputFile) && candidates.value(inputFile) == state) {
+        QImageReader reader(inputFile);
+        WatchJob job;
+        job.inputFile = inputFile;
+        job.outputFile = outputFile;
+        QSize size = reader.size();
+        if(maxSize > 0 && (size.width() > maxSize || size.height() > maxSize)) {
+          size.scale(maxSize, maxSize, Qt::KeepAspectRatio);
+        }
+        job.memory = Lithophane::estimateMemory(size.width(), size.height());
+        // Jobs plan to stay within their own budget
+        if(maxMemory > 0) {
+          job.memory = qMin(job.memory, maxMemory);
+        }
+        queue.append(job);
+      } else {
+        seen.insert(inputFile, state);
+      }
+    }
+  }
+  candidates = seen;
+  if(!candidates.isEmpty()) {
+    settleTimer.start();
+  }
+  schedule();
+}
+
+void WatchDaemon::schedule()
+{
+  while(!queue.isEmpty() && running.count() < maxJobs) {
+    // A job larger than the limit is still allowed to run on its own
+    WatchJob job = queue.first();
+    if(!running.isEmpty() && memoryInUse + job.memory > memoryLimit) {
+      break;
+    }
+    queue.removeFirst();
+    running.insert(job.inputFile, job);
+    memoryInUse += job.memory;
+    printf("Rendering '%s' to '%s'...\n", job.inputFile.toStdString().c_str(), job.outputFile.toStdString().c_str());
+    RenderJob renderJob;
+    renderJob.inputFile = job.inputFile;
+    renderJob.addOutputs(job.outputFile, stlFormat, additionalFormats);
+    renderJob.renderSettings = renderSettings;
+    renderJob.maxSize = maxSize;
+    renderJob.maxMemory = maxMemory;
+    renderJob.renderCache = renderCache;
+    renderJob.printerProfile = printerProfile;
+    renderJob.statsLog = statsLog;
+    renderJob.threads = qMax(1, QThread::idealThreadCount() / maxJobs);
+    pool.start(new WatchTask(this, renderJob));
+  }
+}
+
+void WatchDaemon::jobFinished(const QString &inputFile, const bool &success, const QString &errorString)
+{
+  WatchJob job = running.take(inputFile);
+  memoryInUse -= job.memory;
+  if(success) {
+    failed.remove(inputFile);
+  } else {
+    failed.insert(inputFile, QFileInfo(inputFile).lastModified());
+  }
+  if(success) {
+    printf("Finished '%s'\n", inputFile.toStdString().c_str());
+  } else {
+    printf("Failed '%s': %s\n", inputFile.toStdString().c_str(), errorString.toStdString().c_str());
+  }
+  schedule();
+}
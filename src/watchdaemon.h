@@ -0,0 +1,114 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            watchdaemon.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __WATCHDAEMON_H__
+#define __WATCHDAEMON_H__
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QThreadPool>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QPair>
+#include <QDateTime>
+
+#include "rendersettings.h"
+#include "rendercache.h"
+#include "printerprofile.h"
+#include "renderstats.h"
+
+struct WatchJob
+{
+  QString inputFile;
+  QString outputFile;
+  qint64 memory = 0;
+};
+
+// Watches one or more input directories and renders every new or changed
+// PNG image into the output directory. Files are only picked up once their
+// size and modification time have settled, and the number of jobs in flight
+// is bounded by both the number of cores and a memory limit.
+class WatchDaemon : public QObject
+{
+  Q_OBJECT
+
+public:
+  WatchDaemon(const QStringList &inputDirs, const QString &outputDir,
+              const RenderSettings &renderSettings, const QString &stlFormat);
+  ~WatchDaemon();
+  void setMaxJobs(const int &maxJobs);
+  void setMemoryLimit(const qint64 &memoryLimit);
+  void setMaxSize(const int &maxSize);
+  void setMaxMemory(const qint64 &maxMemory);
+  void setAdditionalFormats(const QStringList &additionalFormats);
+  void setRenderCache(RenderCache *renderCache);
+  void setPrinterProfile(const PrinterProfile &printerProfile);
+  void setStatsLog(StatsLog *statsLog);
+  bool start();
+
+private slots:
+  void directoryChanged(const QString &path);
+  void scan();
+  void jobFinished(const QString &inputFile, const bool &success, const QString &errorString);
+
+private:
+  QString outputFilename(const QString &inputFile) const;
+  bool isUpToDate(const QString &inputFile) const;
+  void schedule();
+
+  QStringList inputDirs;
+  QString outputDir;
+  RenderSettings renderSettings;
+  QString stlFormat = "binary";
+  QStringList additionalFormats;
+  int maxSize = 0;
+  qint64 maxMemory = 0;
+  RenderCache *renderCache = nullptr;
+  PrinterProfile printerProfile;
+  StatsLog *statsLog = nullptr;
+  int maxJobs = 1;
+  qint64 memoryLimit = 0;
+  qint64 memoryInUse = 0;
+
+  QFileSystemWatcher watcher;
+  QTimer settleTimer;
+  QTimer rescanTimer;
+  QThreadPool pool;
+
+  // Size and modification time of each candidate from the previous scan
+  QHash<QString, QPair<qint64, QDateTime> > candidates;
+  QList<WatchJob> queue;
+  QHash<QString, WatchJob> running;
+  // Modification time of inputs that failed, so they aren't retried until changed
+  QHash<QString, QDateTime> failed;
+  // Inputs left out since their output is rendered from another input
+  QSet<QString> collisions;
+};
+
+#endif // __WATCHDAEMON_H__
@@ -0,0 +1,243 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            zipwriter.cpp
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#include <string.h>
+#include <zlib.h>
+#include <omp.h>
+#include <QDateTime>
+#include <QVector>
+#include <QtEndian>
+
+#include "zipwriter.h"
+
+// Entries and offsets are limited to 4 GB since zip64 isn't supported
+constexpr qint64 maxZipSize = 0xffffffffLL;
+
+static void appendLe16(QByteArray &data, const quint16 &value)
+{
+  uchar bytes[2];
+  qToLittleEndian<quint16>(value, bytes);
+  data.append((const char *)bytes, 2);
+}
+
+static void appendLe32(QByteArray &data, const quint32 &value)
+{
+  uchar bytes[4];
+  qToLittleEndian<quint32>(value, bytes);
+  data.append((const char *)bytes, 4);
+}
+
+ZipWriter::ZipWriter(const QString &filename) : file(filename)
+{
+  QDateTime now = QDateTime::currentDateTime();
+  dosTime = (now.time().hour() << 11) | (now.time().minute() << 5) | (now.time().second() / 2);
+  dosDate = ((qMax(now.date().year(), 1980) - 1980) << 9) | (now.date().month() << 5) | now.date().day();
+}
+
+ZipWriter::~ZipWriter()
+{
+  file.close();
+}
+
+bool ZipWriter::open()
+{
+  return file.open(QIODevice::WriteOnly);
+}
+
+QByteArray ZipWriter::deflateChunk(const QByteArray &data, const bool &final)
+{
+  // Raw deflate. Non-final chunks end on a sync flush, which byte aligns the
+  // stream so independently compressed chunks can simply be concatenated.
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return QByteArray();
+  }
+  QByteArray compressed;
+  compressed.resize(deflateBound(&stream, data.size()) + 16);
+  stream.next_in = (Bytef *)data.constData();
+  stream.avail_in = data.size();
+  stream.next_out = (Bytef *)compressed.data();
+  stream.avail_out = compressed.size();
+  int result = deflate(&stream, final?Z_FINISH:Z_SYNC_FLUSH);
+  compressed.resize(compressed.size() - stream.avail_out);
+  deflateEnd(&stream);
+  if(result != (final?Z_STREAM_END:Z_OK)) {
+    return QByteArray();
+  }
+
+  return compressed;
+}
+
+bool ZipWriter::writeLocalHeader(CentralEntry &entry)
+{
+  if(file.pos() > maxZipSize) {
+    return false;
+  }
+  entry.offset = file.pos();
+  QByteArray header;
+  appendLe32(header, 0x04034b50);
+  appendLe16(header, 20);
+  appendLe16(header, entry.flags);
+  appendLe16(header, 8);
+  appendLe16(header, dosTime);
+  appendLe16(header, dosDate);
+  appendLe32(header, entry.crc);
+  appendLe32(header, entry.compressedSize);
+  appendLe32(header, entry.uncompressedSize);
+  appendLe16(header, entry.name.size());
+  appendLe16(header, 0);
+  header.append(entry.name);
+
+  return file.write(header) == header.size();
+}
+
+bool ZipWriter::addEntry(const QString &name, const QByteArray &data)
+{
+  CentralEntry entry;
+  entry.name = name.toUtf8();
+  entry.crc = crc32(0, (const Bytef *)data.constData(), data.size());
+  QByteArray compressed = deflateChunk(data, true);
+  entry.compressedSize = compressed.size();
+  entry.uncompressedSize = data.size();
+  if(compressed.isEmpty() || !writeLocalHeader(entry) ||
+     file.write(compressed) != compressed.size()) {
+    failed = true;
+    return false;
+  }
+  entries.append(entry);
+
+  return true;
+}
+
+bool ZipWriter::addChunkedEntry(const QString &name, const int &chunks,
+                                const std::function<QByteArray(int)> &generateChunk)
+{
+  // The sizes and checksum are only known once all chunks are written, so
+  // they follow the data in a data descriptor
+  CentralEntry entry;
+  entry.name = name.toUtf8();
+  entry.flags = 0x0008;
+  if(!writeLocalHeader(entry)) {
+    failed = true;
+    return false;
+  }
+
+  // Chunks are processed in batches to bound the memory held at once
+  int batchSize = omp_get_max_threads() * 4;
+  QVector<QByteArray> compressed(batchSize);
+  QVector<quint32> crcs(batchSize);
+  QVector<qint64> sizes(batchSize);
+  qint64 compressedSize = 0;
+  qint64 uncompressedSize = 0;
+  for(int first = 0; first < chunks; first += batchSize) {
+    int count = qMin(batchSize, chunks - first);
+#pragma omp parallel for schedule(dynamic)
+    for(int a = 0; a < count; ++a) {
+      QByteArray data = generateChunk(first + a);
+      crcs[a] = crc32(0, (const Bytef *)data.constData(), data.size());
+      sizes[a] = data.size();
+      compressed[a] = deflateChunk(data, false);
+    }
+    for(int a = 0; a < count; ++a) {
+      if(compressed.at(a).isEmpty() || file.write(compressed.at(a)) != compressed.at(a).size()) {
+        failed = true;
+        return false;
+      }
+      entry.crc = crc32_combine(entry.crc, crcs.at(a), sizes.at(a));
+      compressedSize += compressed.at(a).size();
+      uncompressedSize += sizes.at(a);
+      compressed[a] = QByteArray();
+    }
+  }
+  // Terminate the deflate stream with an empty final block
+  QByteArray last = deflateChunk(QByteArray(), true);
+  compressedSize += last.size();
+  if(compressedSize > maxZipSize || uncompressedSize > maxZipSize ||
+     file.write(last) != last.size()) {
+    failed = true;
+    return false;
+  }
+  entry.compressedSize = compressedSize;
+  entry.uncompressedSize = uncompressedSize;
+
+  QByteArray descriptor;
+  appendLe32(descriptor, 0x08074b50);
+  appendLe32(descriptor, entry.crc);
+  appendLe32(descriptor, entry.compressedSize);
+  appendLe32(descriptor, entry.uncompressedSize);
+  if(file.write(descriptor) != descriptor.size()) {
+    failed = true;
+    return false;
+  }
+  entries.append(entry);
+
+  return true;
+}
+
+bool ZipWriter::close()
+{
+  if(failed || file.pos() > maxZipSize) {
+    file.close();
+    return false;
+  }
+  qint64 directoryOffset = file.pos();
+  QByteArray directory;
+  for(const auto &entry: entries) {
+    appendLe32(directory, 0x02014b50);
+    appendLe16(directory, 20);
+    appendLe16(directory, 20);
+    appendLe16(directory, entry.flags);
+    appendLe16(directory, 8);
+    appendLe16(directory, dosTime);
+    appendLe16(directory, dosDate);
+    appendLe32(directory, entry.crc);
+    appendLe32(directory, entry.compressedSize);
+    appendLe32(directory, entry.uncompressedSize);
+    appendLe16(directory, entry.name.size());
+    appendLe16(directory, 0);
+    appendLe16(directory, 0);
+    appendLe16(directory, 0);
+    appendLe16(directory, 0);
+    appendLe32(directory, 0);
+    appendLe32(directory, entry.offset);
+    directory.append(entry.name);
+  }
+  quint32 directorySize = directory.size();
+  appendLe32(directory, 0x06054b50);
+  appendLe16(directory, 0);
+  appendLe16(directory, 0);
+  appendLe16(directory, entries.length());
+  appendLe16(directory, entries.length());
+  appendLe32(directory, directorySize);
+  appendLe32(directory, directoryOffset);
+  appendLe16(directory, 0);
+  // Closing doesn't report a failed flush of the buffered tail
+  bool success = (file.write(directory) == directory.size() && file.flush());
+  file.close();
+
+  return success;
+}
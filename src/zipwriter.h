@@ -0,0 +1,72 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/***************************************************************************
+ *            zipwriter.h
+ *
+ *  Mon Oct 19 10:00:00 CEST 2026
+ *  Copyright 2026 Lars Muldjord
+ *  muldjordlars@gmail.com
+ ****************************************************************************/
+/*
+ *  This file is part of LithoMaker.
+ *
+ *  LithoMaker is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  LithoMaker is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with LithoMaker; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ */
+
+#ifndef __ZIPWRITER_H__
+#define __ZIPWRITER_H__
+
+#include <functional>
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+
+// Minimal zip archive writer for the container based export formats. Entries
+// are deflated and written sequentially. Large entries are generated and
+// compressed in independent chunks on all cores and streamed to disk in
+// order, so the uncompressed data never has to be held in memory at once.
+class ZipWriter
+{
+public:
+  ZipWriter(const QString &filename);
+  ~ZipWriter();
+  bool open();
+  bool addEntry(const QString &name, const QByteArray &data);
+  bool addChunkedEntry(const QString &name, const int &chunks,
+                       const std::function<QByteArray(int)> &generateChunk);
+  bool close();
+
+private:
+  struct CentralEntry
+  {
+    QByteArray name;
+    quint16 flags = 0;
+    quint32 crc = 0;
+    quint32 compressedSize = 0;
+    quint32 uncompressedSize = 0;
+    quint32 offset = 0;
+  };
+
+  bool writeLocalHeader(CentralEntry &entry);
+  static QByteArray deflateChunk(const QByteArray &data, const bool &final);
+
+  QFile file;
+  QList<CentralEntry> entries;
+  quint16 dosTime = 0;
+  quint16 dosDate = 0;
+  bool failed = false;
+};
+
+#endif // __ZIPWRITER_H__